@@ -0,0 +1,57 @@
+#ifndef B2_TASK_EXECUTOR_H
+#define B2_TASK_EXECUTOR_H
+
+#include "box2d/b2_api.h"
+#include "box2d/b2_types.h"
+
+/**
+* @author Brian Semrau
+*
+* Hook for the patched b2World::Step in b2patch/. Box2D itself has no threading, so the module
+* hands it an executor backed by Godot's worker threads.
+*/
+
+class b2StackAllocator;
+
+/// A unit of work. Called once for each index passed to b2TaskExecutor::Run.
+typedef void (*b2TaskCallback)(void *context, int32 index);
+
+/// Runs solver work on worker threads. Only the thread stepping the world calls into it.
+class B2_API b2TaskExecutor {
+public:
+	b2TaskExecutor();
+	virtual ~b2TaskExecutor();
+
+	/// How many tasks may usefully run at once. 1 or less keeps the step serial.
+	virtual int32 GetThreadCount() const = 0;
+
+	/// Calls callback(context, i) for every i in [0, count), possibly concurrently,
+	/// and returns once all of them have finished.
+	virtual void Run(int32 count, b2TaskCallback callback, void *context) = 0;
+
+	/// Whether b2ContactManager::Collide may also compute contact manifolds on worker threads.
+	virtual bool IsNarrowPhaseParallel() const { return false; }
+
+	/// Scratch memory for task index (1 or more) of a parallel solve. Task 0 uses the world's own allocator.
+	/// Allocators are created on first use and kept until the executor is destroyed.
+	b2StackAllocator *GetStackAllocator(int32 index);
+
+	/// At least size bytes of scratch memory for a parallel narrow phase. The buffer only grows,
+	/// and is kept until the executor is destroyed. Its contents don't survive the next call.
+	void *GetNarrowPhaseBuffer(int32 size);
+
+private:
+	b2StackAllocator **m_stackAllocators;
+	int32 m_stackAllocatorCount;
+
+	void *m_narrowPhaseBuffer;
+	int32 m_narrowPhaseCapacity;
+};
+
+/// Sets the executor used by b2World::Step calls made from the calling thread. nullptr steps serially.
+B2_API void b2SetTaskExecutor(b2TaskExecutor *executor);
+
+/// The executor set for the calling thread, or nullptr.
+B2_API b2TaskExecutor *b2GetTaskExecutor();
+
+#endif // B2_TASK_EXECUTOR_H
@@ -40,9 +40,52 @@ struct B2_API b2BodyUserData {
 
 struct B2_API b2FixtureUserData {
 	b2FixtureUserData() :
-			owner(NULL) {}
+			owner(NULL),
+			exception_flags(0),
+			collision_tag(0),
+			one_way(false),
+			one_way_normal_x(0.0f),
+			one_way_normal_y(0.0f),
+			one_way_margin(0.0f),
+			surface_material(false),
+			surface_speed(0.0f),
+			friction_mix(0),
+			restitution_mix(0),
+			overlap_sensor(false) {}
 
 	Box2DFixture *owner;
+	// Box2DWorld::ExceptionFlags, kept here so contact filtering can rule out exceptions without touching the nodes
+	uint32 exception_flags;
+	// Effective collision tag (the fixture's, or its body's) for Box2DCollisionRules lookups
+	uint8 collision_tag;
+
+	// One-way collision, read in PreSolve. The normal is in body space (b2Vec2 isn't available here), the margin in meters.
+	bool one_way;
+	float one_way_normal_x;
+	float one_way_normal_y;
+	float one_way_margin;
+
+	// Surface material, applied to contacts in PreSolve when surface_material is set.
+	// The speed is in pixels/s, the mix modes are Box2DFixture::MixMode.
+	bool surface_material;
+	float surface_speed;
+	uint8 friction_mix;
+	uint8 restitution_mix;
+
+	// Tracked by Box2DWorld's sensor pass, so it never gets a b2Contact
+	bool overlap_sensor;
+};
+
+// Not part of Box2D v2.4.1's settings. b2include/box2d/b2_contact.h adds the slot to b2Contact.
+struct B2_API b2ContactUserData {
+	b2ContactUserData() :
+			buffer_index(0),
+			solve_skipped(false) {}
+
+	// Index + 1 of the contact's manifold in Box2DWorld::contact_buffer, or 0 if it has none
+	uint32 buffer_index;
+	// Set while PreSolve keeps disabling the contact. Its points were released, so they're buffered anew once it's solved again.
+	bool solve_skipped;
 };
 
 struct B2_API b2JointUserData {
@@ -0,0 +1,24 @@
+// godot_box2d: builds the submodule's src/collision/b2_distance.cpp with its profiling counters
+// kept per thread (see b2_thread_counter.h). The upstream source is compiled unchanged.
+
+// Declares the real counters before their names are redefined
+#include "box2d/b2_distance.h"
+
+#include "b2_thread_counter.h"
+
+B2_THREAD_COUNTER(int32, b2GjkCalls)
+B2_THREAD_COUNTER(int32, b2GjkIters)
+B2_THREAD_COUNTER(int32, b2GjkMaxIters)
+
+#define b2_gjkCalls (*b2GjkCalls())
+#define b2_gjkIters (*b2GjkIters())
+#define b2_gjkMaxIters (*b2GjkMaxIters())
+
+#include "../../thirdparty/box2d/src/collision/b2_distance.cpp"
+
+#undef b2_gjkCalls
+#undef b2_gjkIters
+#undef b2_gjkMaxIters
+
+// Still defined for anything built against b2_distance.h. They stay at zero.
+B2_API int32 b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
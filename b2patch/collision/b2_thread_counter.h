@@ -0,0 +1,21 @@
+#ifndef B2_THREAD_COUNTER_H
+#define B2_THREAD_COUNTER_H
+
+/**
+* @author Brian Semrau
+*
+* Box2D's GJK and TOI profiling counters are plain globals, written by every b2Distance and b2TimeOfImpact call.
+* Worlds step, and shape casts run, on several threads at once, so the wrappers in this directory build the
+* submodule's sources with each counter's name defined as (*name()), a per-thread copy. Not part of Box2D.
+*
+* The submodule's definition of a counter, e.g. "B2_API int32 b2_gjkCalls;", then reads as a redeclaration
+* of the accessor, "B2_API int32 (*b2GjkCalls());".
+*/
+
+#define B2_THREAD_COUNTER(m_type, m_name)      \
+	static m_type *m_name() {                  \
+		static thread_local m_type value = 0;  \
+		return &value;                         \
+	}
+
+#endif // B2_THREAD_COUNTER_H
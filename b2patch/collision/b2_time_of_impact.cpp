@@ -0,0 +1,38 @@
+// godot_box2d: builds the submodule's src/collision/b2_time_of_impact.cpp with its profiling
+// counters and timers kept per thread (see b2_thread_counter.h). The upstream source is compiled unchanged.
+
+// Declares the real counters before their names are redefined
+#include "box2d/b2_time_of_impact.h"
+
+#include "b2_thread_counter.h"
+
+B2_THREAD_COUNTER(float, b2ToiTime)
+B2_THREAD_COUNTER(float, b2ToiMaxTime)
+B2_THREAD_COUNTER(int32, b2ToiCalls)
+B2_THREAD_COUNTER(int32, b2ToiIters)
+B2_THREAD_COUNTER(int32, b2ToiMaxIters)
+B2_THREAD_COUNTER(int32, b2ToiRootIters)
+B2_THREAD_COUNTER(int32, b2ToiMaxRootIters)
+
+#define b2_toiTime (*b2ToiTime())
+#define b2_toiMaxTime (*b2ToiMaxTime())
+#define b2_toiCalls (*b2ToiCalls())
+#define b2_toiIters (*b2ToiIters())
+#define b2_toiMaxIters (*b2ToiMaxIters())
+#define b2_toiRootIters (*b2ToiRootIters())
+#define b2_toiMaxRootIters (*b2ToiMaxRootIters())
+
+#include "../../thirdparty/box2d/src/collision/b2_time_of_impact.cpp"
+
+#undef b2_toiTime
+#undef b2_toiMaxTime
+#undef b2_toiCalls
+#undef b2_toiIters
+#undef b2_toiMaxIters
+#undef b2_toiRootIters
+#undef b2_toiMaxRootIters
+
+// Still defined for anything built against b2_time_of_impact.h. They stay at zero.
+B2_API float b2_toiTime, b2_toiMaxTime;
+B2_API int32 b2_toiCalls, b2_toiIters, b2_toiMaxIters;
+B2_API int32 b2_toiRootIters, b2_toiMaxRootIters;
@@ -0,0 +1,491 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// godot_box2d: patched copy of Box2D v2.4.1 src/dynamics/b2_contact_manager.cpp, compiled in
+// place of the submodule's. When the task executor allows it, Collide computes contact
+// manifolds on worker threads. Changes are marked with "godot_box2d:".
+
+#include "box2d/b2_body.h"
+#include "box2d/b2_collision.h"
+#include "box2d/b2_contact.h"
+#include "box2d/b2_contact_manager.h"
+#include "box2d/b2_fixture.h"
+#include "box2d/b2_world_callbacks.h"
+
+#include "b2_task_executor.h"
+
+b2ContactFilter b2_defaultFilter;
+b2ContactListener b2_defaultListener;
+
+// godot_box2d: manifolds are computed on workers in chunks of this many contacts.
+// Worlds with fewer awake contacts than two chunks update them serially.
+#define b2_narrowPhaseChunkSize 64
+
+// godot_box2d: the result of evaluating one awake contact on a worker
+struct b2ContactUpdate
+{
+	b2Contact* contact;
+
+	// What b2Contact::Update would compute. The manifold only for non-sensors, touching only for sensors.
+	b2Manifold manifold;
+	bool touching;
+	bool sensor;
+};
+
+// godot_box2d: shared by the workers of a parallel Collide
+struct b2ParallelCollide
+{
+	b2ContactUpdate* updates;
+	int32 count;
+};
+
+// godot_box2d: the collision part of b2Contact::Update. Only reads the contact,
+// its fixtures and the body transforms, and writes the result to the update.
+static void b2EvaluateContact(b2ContactUpdate* update)
+{
+	b2Contact* contact = update->contact;
+	b2Fixture* fixtureA = contact->GetFixtureA();
+	b2Fixture* fixtureB = contact->GetFixtureB();
+	const b2Transform& xfA = fixtureA->GetBody()->GetTransform();
+	const b2Transform& xfB = fixtureB->GetBody()->GetTransform();
+
+	update->sensor = fixtureA->IsSensor() || fixtureB->IsSensor();
+	if (update->sensor)
+	{
+		const b2Shape* shapeA = fixtureA->GetShape();
+		const b2Shape* shapeB = fixtureB->GetShape();
+		update->touching = b2TestOverlap(shapeA, contact->GetChildIndexA(), shapeB, contact->GetChildIndexB(), xfA, xfB);
+		return;
+	}
+
+	// Evaluate overwrites the manifold in place, so start from the current one like Update does
+	update->manifold = *contact->GetManifold();
+	contact->Evaluate(&update->manifold, xfA, xfB);
+}
+
+// godot_box2d: evaluates one chunk of contacts
+static void b2EvaluateContactChunk(void* context, int32 index)
+{
+	b2ParallelCollide* collide = (b2ParallelCollide*)context;
+	int32 end = b2Min((index + 1) * b2_narrowPhaseChunkSize, collide->count);
+	for (int32 i = index * b2_narrowPhaseChunkSize; i < end; ++i)
+	{
+		b2EvaluateContact(collide->updates + i);
+	}
+}
+
+b2ContactManager::b2ContactManager()
+{
+	m_contactList = nullptr;
+	m_contactCount = 0;
+	m_contactFilter = &b2_defaultFilter;
+	m_contactListener = &b2_defaultListener;
+	m_allocator = nullptr;
+}
+
+void b2ContactManager::Destroy(b2Contact* c)
+{
+	b2Fixture* fixtureA = c->GetFixtureA();
+	b2Fixture* fixtureB = c->GetFixtureB();
+	b2Body* bodyA = fixtureA->GetBody();
+	b2Body* bodyB = fixtureB->GetBody();
+
+	if (m_contactListener && c->IsTouching())
+	{
+		m_contactListener->EndContact(c);
+	}
+
+	// Remove from the world.
+	if (c->m_prev)
+	{
+		c->m_prev->m_next = c->m_next;
+	}
+
+	if (c->m_next)
+	{
+		c->m_next->m_prev = c->m_prev;
+	}
+
+	if (c == m_contactList)
+	{
+		m_contactList = c->m_next;
+	}
+
+	// Remove from body 1
+	if (c->m_nodeA.prev)
+	{
+		c->m_nodeA.prev->next = c->m_nodeA.next;
+	}
+
+	if (c->m_nodeA.next)
+	{
+		c->m_nodeA.next->prev = c->m_nodeA.prev;
+	}
+
+	if (&c->m_nodeA == bodyA->m_contactList)
+	{
+		bodyA->m_contactList = c->m_nodeA.next;
+	}
+
+	// Remove from body 2
+	if (c->m_nodeB.prev)
+	{
+		c->m_nodeB.prev->next = c->m_nodeB.next;
+	}
+
+	if (c->m_nodeB.next)
+	{
+		c->m_nodeB.next->prev = c->m_nodeB.prev;
+	}
+
+	if (&c->m_nodeB == bodyB->m_contactList)
+	{
+		bodyB->m_contactList = c->m_nodeB.next;
+	}
+
+	// Call the factory.
+	b2Contact::Destroy(c, m_allocator);
+	--m_contactCount;
+}
+
+// This is the top level collision call for the time step. Here
+// all the narrow phase collision is processed for the world
+// contact list.
+void b2ContactManager::Collide()
+{
+	// godot_box2d: with a parallel narrow phase, contacts that are awake now are evaluated on the
+	// executor's threads first. The loop below is upstream's, and uses those results in place of
+	// b2Contact::Update's collision part. Everything else, including filtering, destruction,
+	// waking and the listener calls, happens in that loop in list order, as in a serial Collide.
+	b2ContactUpdate* updates = nullptr;
+	int32 updateCount = 0;
+	b2TaskExecutor* executor = b2GetTaskExecutor();
+	if (executor != nullptr && executor->IsNarrowPhaseParallel() && executor->GetThreadCount() > 1 &&
+		m_contactCount >= 2 * b2_narrowPhaseChunkSize)
+	{
+		updates = (b2ContactUpdate*)executor->GetNarrowPhaseBuffer(m_contactCount * sizeof(b2ContactUpdate));
+		for (b2Contact* c = m_contactList; c; c = c->GetNext())
+		{
+			b2Body* bodyA = c->GetFixtureA()->GetBody();
+			b2Body* bodyB = c->GetFixtureB()->GetBody();
+			bool activeA = bodyA->IsAwake() && bodyA->m_type != b2_staticBody;
+			bool activeB = bodyB->IsAwake() && bodyB->m_type != b2_staticBody;
+			if (activeA || activeB)
+			{
+				updates[updateCount++].contact = c;
+			}
+		}
+
+		b2ParallelCollide collide;
+		collide.updates = updates;
+		collide.count = updateCount;
+
+		int32 chunkCount = (updateCount + b2_narrowPhaseChunkSize - 1) / b2_narrowPhaseChunkSize;
+		if (chunkCount > 1)
+		{
+			executor->Run(chunkCount, b2EvaluateContactChunk, &collide);
+		}
+		else
+		{
+			// Mostly asleep, not worth a hand-off
+			updateCount = 0;
+		}
+	}
+
+	// godot_box2d: results are in list order, and the list only loses contacts during this loop
+	int32 updateIndex = 0;
+
+	// Update awake contacts.
+	b2Contact* c = m_contactList;
+	while (c)
+	{
+		// godot_box2d: this contact's result, if it was awake before the loop
+		b2ContactUpdate* update = nullptr;
+		if (updateIndex < updateCount && updates[updateIndex].contact == c)
+		{
+			update = updates + updateIndex++;
+		}
+
+		b2Fixture* fixtureA = c->GetFixtureA();
+		b2Fixture* fixtureB = c->GetFixtureB();
+		int32 indexA = c->GetChildIndexA();
+		int32 indexB = c->GetChildIndexB();
+		b2Body* bodyA = fixtureA->GetBody();
+		b2Body* bodyB = fixtureB->GetBody();
+
+		// Is this contact flagged for filtering?
+		if (c->m_flags & b2Contact::e_filterFlag)
+		{
+			// Should these bodies collide?
+			if (bodyB->ShouldCollide(bodyA) == false)
+			{
+				b2Contact* cNuke = c;
+				c = cNuke->GetNext();
+				Destroy(cNuke);
+				continue;
+			}
+
+			// Check user filtering.
+			if (m_contactFilter && m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
+			{
+				b2Contact* cNuke = c;
+				c = cNuke->GetNext();
+				Destroy(cNuke);
+				continue;
+			}
+
+			// Clear the filtering flag.
+			c->m_flags &= ~b2Contact::e_filterFlag;
+		}
+
+		bool activeA = bodyA->IsAwake() && bodyA->m_type != b2_staticBody;
+		bool activeB = bodyB->IsAwake() && bodyB->m_type != b2_staticBody;
+
+		// At least one body must be awake and it must be dynamic or kinematic.
+		if (activeA == false && activeB == false)
+		{
+			c = c->GetNext();
+			continue;
+		}
+
+		int32 proxyIdA = fixtureA->m_proxies[indexA].proxyId;
+		int32 proxyIdB = fixtureB->m_proxies[indexB].proxyId;
+		bool overlap = m_broadPhase.TestOverlap(proxyIdA, proxyIdB);
+
+		// Here we destroy contacts that cease to overlap in the broad-phase.
+		if (overlap == false)
+		{
+			b2Contact* cNuke = c;
+			c = cNuke->GetNext();
+			Destroy(cNuke);
+			continue;
+		}
+
+		// godot_box2d: a contact with no result, e.g. because an earlier contact in this loop woke
+		// its bodies, is updated here. So is one a listener turned into a sensor, or back.
+		if (update == nullptr || update->sensor != (fixtureA->IsSensor() || fixtureB->IsSensor()))
+		{
+			// The contact persists.
+			c->Update(m_contactListener);
+			c = c->GetNext();
+			continue;
+		}
+
+		// godot_box2d: the rest of b2Contact::Update, with the worker's result. Shapes and body
+		// transforms can't change while the world is locked, so the result is what Update would get.
+		b2Manifold oldManifold = c->m_manifold;
+
+		// Re-enable this contact.
+		c->m_flags |= b2Contact::e_enabledFlag;
+
+		bool touching = false;
+		bool wasTouching = (c->m_flags & b2Contact::e_touchingFlag) == b2Contact::e_touchingFlag;
+		bool sensor = update->sensor;
+
+		// Is this contact a sensor?
+		if (sensor)
+		{
+			touching = update->touching;
+
+			// Sensors don't generate manifolds.
+			c->m_manifold.pointCount = 0;
+		}
+		else
+		{
+			c->m_manifold = update->manifold;
+			touching = c->m_manifold.pointCount > 0;
+
+			// Match old contact ids to new contact ids and copy the
+			// stored impulses to warm start the solver.
+			for (int32 i = 0; i < c->m_manifold.pointCount; ++i)
+			{
+				b2ManifoldPoint* mp2 = c->m_manifold.points + i;
+				mp2->normalImpulse = 0.0f;
+				mp2->tangentImpulse = 0.0f;
+				b2ContactID id2 = mp2->id;
+
+				for (int32 j = 0; j < oldManifold.pointCount; ++j)
+				{
+					b2ManifoldPoint* mp1 = oldManifold.points + j;
+
+					if (mp1->id.key == id2.key)
+					{
+						mp2->normalImpulse = mp1->normalImpulse;
+						mp2->tangentImpulse = mp1->tangentImpulse;
+						break;
+					}
+				}
+			}
+
+			if (touching != wasTouching)
+			{
+				bodyA->SetAwake(true);
+				bodyB->SetAwake(true);
+			}
+		}
+
+		if (touching)
+		{
+			c->m_flags |= b2Contact::e_touchingFlag;
+		}
+		else
+		{
+			c->m_flags &= ~b2Contact::e_touchingFlag;
+		}
+
+		if (wasTouching == false && touching == true && m_contactListener)
+		{
+			m_contactListener->BeginContact(c);
+		}
+
+		if (wasTouching == true && touching == false && m_contactListener)
+		{
+			m_contactListener->EndContact(c);
+		}
+
+		if (sensor == false && touching && m_contactListener)
+		{
+			m_contactListener->PreSolve(c, &oldManifold);
+		}
+
+		c = c->GetNext();
+	}
+}
+
+void b2ContactManager::FindNewContacts()
+{
+	m_broadPhase.UpdatePairs(this);
+}
+
+void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
+{
+	b2FixtureProxy* proxyA = (b2FixtureProxy*)proxyUserDataA;
+	b2FixtureProxy* proxyB = (b2FixtureProxy*)proxyUserDataB;
+
+	b2Fixture* fixtureA = proxyA->fixture;
+	b2Fixture* fixtureB = proxyB->fixture;
+
+	int32 indexA = proxyA->childIndex;
+	int32 indexB = proxyB->childIndex;
+
+	b2Body* bodyA = fixtureA->GetBody();
+	b2Body* bodyB = fixtureB->GetBody();
+
+	// Are the fixtures on the same body?
+	if (bodyA == bodyB)
+	{
+		return;
+	}
+
+	// TODO_ERIN use a hash table to remove a potential bottleneck when both
+	// bodies have a lot of contacts.
+	// Does a contact already exist?
+	b2ContactEdge* edge = bodyB->GetContactList();
+	while (edge)
+	{
+		if (edge->other == bodyA)
+		{
+			b2Fixture* fA = edge->contact->GetFixtureA();
+			b2Fixture* fB = edge->contact->GetFixtureB();
+			int32 iA = edge->contact->GetChildIndexA();
+			int32 iB = edge->contact->GetChildIndexB();
+
+			if (fA == fixtureA && fB == fixtureB && iA == indexA && iB == indexB)
+			{
+				// A contact already exists.
+				return;
+			}
+
+			if (fA == fixtureB && fB == fixtureA && iA == indexB && iB == indexA)
+			{
+				// A contact already exists.
+				return;
+			}
+		}
+
+		edge = edge->next;
+	}
+
+	// Does a joint override collision? Is at least one body dynamic?
+	if (bodyB->ShouldCollide(bodyA) == false)
+	{
+		return;
+	}
+
+	// Check user filtering.
+	if (m_contactFilter && m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
+	{
+		return;
+	}
+
+	// Call the factory.
+	b2Contact* c = b2Contact::Create(fixtureA, indexA, fixtureB, indexB, m_allocator);
+	if (c == nullptr)
+	{
+		return;
+	}
+
+	// Contact creation may swap fixtures.
+	fixtureA = c->GetFixtureA();
+	fixtureB = c->GetFixtureB();
+	indexA = c->GetChildIndexA();
+	indexB = c->GetChildIndexB();
+	bodyA = fixtureA->GetBody();
+	bodyB = fixtureB->GetBody();
+
+	// Insert into the world.
+	c->m_prev = nullptr;
+	c->m_next = m_contactList;
+	if (m_contactList != nullptr)
+	{
+		m_contactList->m_prev = c;
+	}
+	m_contactList = c;
+
+	// Connect to island graph.
+
+	// Connect to body A
+	c->m_nodeA.contact = c;
+	c->m_nodeA.other = bodyB;
+
+	c->m_nodeA.prev = nullptr;
+	c->m_nodeA.next = bodyA->m_contactList;
+	if (bodyA->m_contactList != nullptr)
+	{
+		bodyA->m_contactList->prev = &c->m_nodeA;
+	}
+	bodyA->m_contactList = &c->m_nodeA;
+
+	// Connect to body B
+	c->m_nodeB.contact = c;
+	c->m_nodeB.other = bodyA;
+
+	c->m_nodeB.prev = nullptr;
+	c->m_nodeB.next = bodyB->m_contactList;
+	if (bodyB->m_contactList != nullptr)
+	{
+		bodyB->m_contactList->prev = &c->m_nodeB;
+	}
+	bodyB->m_contactList = &c->m_nodeB;
+
+	++m_contactCount;
+}
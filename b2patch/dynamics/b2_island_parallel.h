@@ -0,0 +1,25 @@
+#ifndef B2_ISLAND_PARALLEL_H
+#define B2_ISLAND_PARALLEL_H
+
+#include <mutex>
+
+/**
+* @author Brian Semrau
+*
+* Shared by the patched b2_world.cpp and b2_island.cpp. Not part of Box2D.
+*/
+
+/// Set on the thread solving an island while other islands of the same step are solved concurrently.
+struct b2ParallelIslandState
+{
+	/// Guards m_islandIndex of static bodies, which every island touching them shares.
+	std::mutex* staticIndexMutex;
+
+	/// Set by b2Island::Solve instead of putting the island to sleep. b2World applies it
+	/// once PostSolve has been replayed, so the listener sees the same velocities as a serial solve.
+	bool sleep;
+};
+
+extern thread_local b2ParallelIslandState* b2_parallelIsland;
+
+#endif // B2_ISLAND_PARALLEL_H
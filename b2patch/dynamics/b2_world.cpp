@@ -0,0 +1,1697 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// godot_box2d: patched copy of Box2D v2.4.1 src/dynamics/b2_world.cpp, compiled in place of
+// the submodule's. When a b2TaskExecutor is set, b2World::Solve builds every island first and
+// solves them on worker threads. Changes are marked with "godot_box2d:".
+
+#include "box2d/b2_body.h"
+#include "box2d/b2_broad_phase.h"
+#include "box2d/b2_chain_shape.h"
+#include "box2d/b2_circle_shape.h"
+#include "box2d/b2_collision.h"
+#include "box2d/b2_contact.h"
+#include "box2d/b2_draw.h"
+#include "box2d/b2_edge_shape.h"
+#include "box2d/b2_fixture.h"
+#include "box2d/b2_polygon_shape.h"
+#include "box2d/b2_pulley_joint.h"
+#include "box2d/b2_stack_allocator.h"
+#include "box2d/b2_time_of_impact.h"
+#include "box2d/b2_timer.h"
+#include "box2d/b2_world.h"
+
+#include "dynamics/b2_contact_solver.h"
+#include "dynamics/b2_island.h"
+
+#include "b2_island_parallel.h"
+#include "b2_task_executor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <string.h>
+
+// godot_box2d: task executor for the thread calling Step
+static thread_local b2TaskExecutor* b2_taskExecutor = nullptr;
+
+void b2SetTaskExecutor(b2TaskExecutor* executor)
+{
+	b2_taskExecutor = executor;
+}
+
+b2TaskExecutor* b2GetTaskExecutor()
+{
+	return b2_taskExecutor;
+}
+
+b2TaskExecutor::b2TaskExecutor()
+{
+	m_stackAllocators = nullptr;
+	m_stackAllocatorCount = 0;
+	m_narrowPhaseBuffer = nullptr;
+	m_narrowPhaseCapacity = 0;
+}
+
+b2TaskExecutor::~b2TaskExecutor()
+{
+	for (int32 i = 0; i < m_stackAllocatorCount; ++i)
+	{
+		m_stackAllocators[i]->~b2StackAllocator();
+		b2Free(m_stackAllocators[i]);
+	}
+
+	if (m_stackAllocators)
+	{
+		b2Free(m_stackAllocators);
+	}
+
+	if (m_narrowPhaseBuffer)
+	{
+		b2Free(m_narrowPhaseBuffer);
+	}
+}
+
+b2StackAllocator* b2TaskExecutor::GetStackAllocator(int32 index)
+{
+	b2Assert(index > 0);
+
+	// Task 0 has no slot
+	if (index > m_stackAllocatorCount)
+	{
+		b2StackAllocator** allocators = (b2StackAllocator**)b2Alloc(index * sizeof(b2StackAllocator*));
+		if (m_stackAllocators)
+		{
+			memcpy(allocators, m_stackAllocators, m_stackAllocatorCount * sizeof(b2StackAllocator*));
+			b2Free(m_stackAllocators);
+		}
+
+		for (int32 i = m_stackAllocatorCount; i < index; ++i)
+		{
+			void* mem = b2Alloc(sizeof(b2StackAllocator));
+			allocators[i] = new (mem) b2StackAllocator;
+		}
+
+		m_stackAllocators = allocators;
+		m_stackAllocatorCount = index;
+	}
+
+	return m_stackAllocators[index - 1];
+}
+
+void* b2TaskExecutor::GetNarrowPhaseBuffer(int32 size)
+{
+	if (size > m_narrowPhaseCapacity)
+	{
+		if (m_narrowPhaseBuffer)
+		{
+			b2Free(m_narrowPhaseBuffer);
+		}
+
+		// Grow geometrically, contact counts tend to creep up a few at a time
+		m_narrowPhaseCapacity = b2Max(size, 2 * m_narrowPhaseCapacity);
+		m_narrowPhaseBuffer = b2Alloc(m_narrowPhaseCapacity);
+	}
+
+	return m_narrowPhaseBuffer;
+}
+
+// godot_box2d: islands are handed to workers in batches of at least this many bodies,
+// contacts and joints, so piles of small islands don't cost one hand-off each.
+#define b2_minIslandBatchCost 32
+
+// godot_box2d: one island of a parallel solve, as ranges of the arrays built by b2World::Solve
+struct b2IslandRange
+{
+	int32 bodyStart;
+	int32 bodyCount;
+	int32 contactStart;
+	int32 contactCount;
+	int32 jointStart;
+	int32 jointCount;
+
+	b2Profile profile;
+	bool sleep;
+};
+
+// godot_box2d: shared by the workers of a parallel solve
+struct b2ParallelSolve
+{
+	b2Body** bodies;
+	b2Contact** contacts;
+	b2Joint** joints;
+	b2IslandRange* islands;
+
+	// Island indices, largest first. Batch i covers order[batchStarts[i]] to order[batchStarts[i + 1] - 1].
+	int32* order;
+	int32* batchStarts;
+	int32 batchCount;
+	std::atomic<int32> nextBatch;
+
+	// One per task. Task 0 uses the world's own allocator.
+	b2StackAllocator** allocators;
+	std::mutex staticIndexMutex;
+
+	b2TimeStep step;
+	b2Vec2 gravity;
+	bool allowSleep;
+};
+
+// godot_box2d: solves one island on the calling thread
+static void b2SolveIslandRange(b2ParallelSolve* solve, b2IslandRange* range, b2StackAllocator* allocator)
+{
+	// Built without a listener. b2World::Solve replays PostSolve afterwards.
+	b2Island island(range->bodyCount, range->contactCount, range->jointCount, allocator, nullptr);
+
+	memcpy(island.m_bodies, solve->bodies + range->bodyStart, range->bodyCount * sizeof(b2Body*));
+	memcpy(island.m_contacts, solve->contacts + range->contactStart, range->contactCount * sizeof(b2Contact*));
+	memcpy(island.m_joints, solve->joints + range->jointStart, range->jointCount * sizeof(b2Joint*));
+	island.m_bodyCount = range->bodyCount;
+	island.m_contactCount = range->contactCount;
+	island.m_jointCount = range->jointCount;
+
+	b2ParallelIslandState state;
+	state.staticIndexMutex = &solve->staticIndexMutex;
+	state.sleep = false;
+
+	b2_parallelIsland = &state;
+	island.Solve(&range->profile, solve->step, solve->gravity, solve->allowSleep);
+	b2_parallelIsland = nullptr;
+
+	range->sleep = state.sleep;
+}
+
+// godot_box2d: a task takes batches in order, so the largest islands start first
+static void b2SolveIslandTask(void* context, int32 index)
+{
+	b2ParallelSolve* solve = (b2ParallelSolve*)context;
+	b2StackAllocator* allocator = solve->allocators[index];
+
+	for (;;)
+	{
+		int32 batch = solve->nextBatch.fetch_add(1, std::memory_order_relaxed);
+		if (batch >= solve->batchCount)
+		{
+			break;
+		}
+
+		for (int32 i = solve->batchStarts[batch]; i < solve->batchStarts[batch + 1]; ++i)
+		{
+			b2SolveIslandRange(solve, solve->islands + solve->order[i], allocator);
+		}
+	}
+}
+
+// godot_box2d: what b2Island::Report would have passed for a contact, read back from the manifold
+static void b2ReportPostSolve(b2ContactListener* listener, b2Contact* contact)
+{
+	const b2Manifold* manifold = contact->GetManifold();
+
+	b2ContactImpulse impulse;
+	impulse.count = manifold->pointCount;
+	for (int32 j = 0; j < manifold->pointCount; ++j)
+	{
+		impulse.normalImpulses[j] = manifold->points[j].normalImpulse;
+		impulse.tangentImpulses[j] = manifold->points[j].tangentImpulse;
+	}
+
+	listener->PostSolve(contact, &impulse);
+}
+
+b2World::b2World(const b2Vec2& gravity)
+{
+	m_destructionListener = nullptr;
+	m_debugDraw = nullptr;
+
+	m_bodyList = nullptr;
+	m_jointList = nullptr;
+
+	m_bodyCount = 0;
+	m_jointCount = 0;
+
+	m_warmStarting = true;
+	m_continuousPhysics = true;
+	m_subStepping = false;
+
+	m_stepComplete = true;
+
+	m_allowSleep = true;
+	m_gravity = gravity;
+
+	m_newContacts = false;
+	m_locked = false;
+	m_clearForces = true;
+
+	m_inv_dt0 = 0.0f;
+
+	m_contactManager.m_allocator = &m_blockAllocator;
+
+	memset(&m_profile, 0, sizeof(b2Profile));
+
+	// godot_box2d: worlds may step on several threads at once. Set up Box2D's lazily initialized
+	// globals here, on the thread creating the world, instead of in whichever step first needs them:
+	// the contact registers, and b2Timer's counter frequency on Windows.
+	if (b2Contact::s_initialized == false)
+	{
+		b2Contact::InitializeRegisters();
+		b2Contact::s_initialized = true;
+	}
+	b2Timer timer;
+}
+
+b2World::~b2World()
+{
+	// Some shapes allocate using b2Alloc.
+	b2Body* b = m_bodyList;
+	while (b)
+	{
+		b2Body* bNext = b->m_next;
+
+		b2Fixture* f = b->m_fixtureList;
+		while (f)
+		{
+			b2Fixture* fNext = f->m_next;
+			f->m_proxyCount = 0;
+			f->Destroy(&m_blockAllocator);
+			f = fNext;
+		}
+
+		b = bNext;
+	}
+}
+
+void b2World::SetDestructionListener(b2DestructionListener* listener)
+{
+	m_destructionListener = listener;
+}
+
+void b2World::SetContactFilter(b2ContactFilter* filter)
+{
+	m_contactManager.m_contactFilter = filter;
+}
+
+void b2World::SetContactListener(b2ContactListener* listener)
+{
+	m_contactManager.m_contactListener = listener;
+}
+
+void b2World::SetDebugDraw(b2Draw* debugDraw)
+{
+	m_debugDraw = debugDraw;
+}
+
+b2Body* b2World::CreateBody(const b2BodyDef* def)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return nullptr;
+	}
+
+	void* mem = m_blockAllocator.Allocate(sizeof(b2Body));
+	b2Body* b = new (mem) b2Body(def, this);
+
+	// Add to world doubly linked list.
+	b->m_prev = nullptr;
+	b->m_next = m_bodyList;
+	if (m_bodyList)
+	{
+		m_bodyList->m_prev = b;
+	}
+	m_bodyList = b;
+	++m_bodyCount;
+
+	return b;
+}
+
+void b2World::DestroyBody(b2Body* b)
+{
+	b2Assert(m_bodyCount > 0);
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	// Delete the attached joints.
+	b2JointEdge* je = b->m_jointList;
+	while (je)
+	{
+		b2JointEdge* je0 = je;
+		je = je->next;
+
+		if (m_destructionListener)
+		{
+			m_destructionListener->SayGoodbye(je0->joint);
+		}
+
+		DestroyJoint(je0->joint);
+
+		b->m_jointList = je;
+	}
+	b->m_jointList = nullptr;
+
+	// Delete the attached contacts.
+	b2ContactEdge* ce = b->m_contactList;
+	while (ce)
+	{
+		b2ContactEdge* ce0 = ce;
+		ce = ce->next;
+		m_contactManager.Destroy(ce0->contact);
+	}
+	b->m_contactList = nullptr;
+
+	// Delete the attached fixtures. This destroys broad-phase proxies.
+	b2Fixture* f = b->m_fixtureList;
+	while (f)
+	{
+		b2Fixture* f0 = f;
+		f = f->m_next;
+
+		if (m_destructionListener)
+		{
+			m_destructionListener->SayGoodbye(f0);
+		}
+
+		f0->DestroyProxies(&m_contactManager.m_broadPhase);
+		f0->Destroy(&m_blockAllocator);
+		f0->~b2Fixture();
+		m_blockAllocator.Free(f0, sizeof(b2Fixture));
+
+		b->m_fixtureList = f;
+		b->m_fixtureCount -= 1;
+	}
+	b->m_fixtureList = nullptr;
+	b->m_fixtureCount = 0;
+
+	// Remove world body list.
+	if (b->m_prev)
+	{
+		b->m_prev->m_next = b->m_next;
+	}
+
+	if (b->m_next)
+	{
+		b->m_next->m_prev = b->m_prev;
+	}
+
+	if (b == m_bodyList)
+	{
+		m_bodyList = b->m_next;
+	}
+
+	--m_bodyCount;
+	b->~b2Body();
+	m_blockAllocator.Free(b, sizeof(b2Body));
+}
+
+b2Joint* b2World::CreateJoint(const b2JointDef* def)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return nullptr;
+	}
+
+	b2Joint* j = b2Joint::Create(def, &m_blockAllocator);
+
+	// Connect to the world list.
+	j->m_prev = nullptr;
+	j->m_next = m_jointList;
+	if (m_jointList)
+	{
+		m_jointList->m_prev = j;
+	}
+	m_jointList = j;
+	++m_jointCount;
+
+	// Connect to the bodies' doubly linked lists.
+	j->m_edgeA.joint = j;
+	j->m_edgeA.other = j->m_bodyB;
+	j->m_edgeA.prev = nullptr;
+	j->m_edgeA.next = j->m_bodyA->m_jointList;
+	if (j->m_bodyA->m_jointList) j->m_bodyA->m_jointList->prev = &j->m_edgeA;
+	j->m_bodyA->m_jointList = &j->m_edgeA;
+
+	j->m_edgeB.joint = j;
+	j->m_edgeB.other = j->m_bodyA;
+	j->m_edgeB.prev = nullptr;
+	j->m_edgeB.next = j->m_bodyB->m_jointList;
+	if (j->m_bodyB->m_jointList) j->m_bodyB->m_jointList->prev = &j->m_edgeB;
+	j->m_bodyB->m_jointList = &j->m_edgeB;
+
+	b2Body* bodyA = def->bodyA;
+	b2Body* bodyB = def->bodyB;
+
+	// If the joint prevents collisions, then flag any contacts for filtering.
+	if (def->collideConnected == false)
+	{
+		b2ContactEdge* edge = bodyB->GetContactList();
+		while (edge)
+		{
+			if (edge->other == bodyA)
+			{
+				// Flag the contact for filtering at the next time step (where either
+				// body is awake).
+				edge->contact->FlagForFiltering();
+			}
+
+			edge = edge->next;
+		}
+	}
+
+	// Note: creating a joint doesn't wake the bodies.
+
+	return j;
+}
+
+void b2World::DestroyJoint(b2Joint* j)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	bool collideConnected = j->m_collideConnected;
+
+	// Remove from the doubly linked list.
+	if (j->m_prev)
+	{
+		j->m_prev->m_next = j->m_next;
+	}
+
+	if (j->m_next)
+	{
+		j->m_next->m_prev = j->m_prev;
+	}
+
+	if (j == m_jointList)
+	{
+		m_jointList = j->m_next;
+	}
+
+	// Disconnect from island graph.
+	b2Body* bodyA = j->m_bodyA;
+	b2Body* bodyB = j->m_bodyB;
+
+	// Wake up connected bodies.
+	bodyA->SetAwake(true);
+	bodyB->SetAwake(true);
+
+	// Remove from body 1.
+	if (j->m_edgeA.prev)
+	{
+		j->m_edgeA.prev->next = j->m_edgeA.next;
+	}
+
+	if (j->m_edgeA.next)
+	{
+		j->m_edgeA.next->prev = j->m_edgeA.prev;
+	}
+
+	if (&j->m_edgeA == bodyA->m_jointList)
+	{
+		bodyA->m_jointList = j->m_edgeA.next;
+	}
+
+	j->m_edgeA.prev = nullptr;
+	j->m_edgeA.next = nullptr;
+
+	// Remove from body 2
+	if (j->m_edgeB.prev)
+	{
+		j->m_edgeB.prev->next = j->m_edgeB.next;
+	}
+
+	if (j->m_edgeB.next)
+	{
+		j->m_edgeB.next->prev = j->m_edgeB.prev;
+	}
+
+	if (&j->m_edgeB == bodyB->m_jointList)
+	{
+		bodyB->m_jointList = j->m_edgeB.next;
+	}
+
+	j->m_edgeB.prev = nullptr;
+	j->m_edgeB.next = nullptr;
+
+	b2Joint::Destroy(j, &m_blockAllocator);
+
+	b2Assert(m_jointCount > 0);
+	--m_jointCount;
+
+	// If the joint prevents collisions, then flag any contacts for filtering.
+	if (collideConnected == false)
+	{
+		b2ContactEdge* edge = bodyB->GetContactList();
+		while (edge)
+		{
+			if (edge->other == bodyA)
+			{
+				// Flag the contact for filtering at the next time step (where either
+				// body is awake).
+				edge->contact->FlagForFiltering();
+			}
+
+			edge = edge->next;
+		}
+	}
+}
+
+//
+void b2World::SetAllowSleeping(bool flag)
+{
+	if (flag == m_allowSleep)
+	{
+		return;
+	}
+
+	m_allowSleep = flag;
+	if (m_allowSleep == false)
+	{
+		for (b2Body* b = m_bodyList; b; b = b->m_next)
+		{
+			b->SetAwake(true);
+		}
+	}
+}
+
+
+// godot_box2d: roughly how long an island takes to solve
+static inline int32 b2IslandCost(const b2IslandRange& range)
+{
+	return range.bodyCount + range.contactCount + range.jointCount;
+}
+
+// Find islands, integrate and solve constraints, solve position constraints
+void b2World::Solve(const b2TimeStep& step)
+{
+	m_profile.solveInit = 0.0f;
+	m_profile.solveVelocity = 0.0f;
+	m_profile.solvePosition = 0.0f;
+
+	// godot_box2d: with a task executor set, every island is built before any is solved.
+	// The island below then holds all of them back to back, and a static body can appear
+	// once per island, so it needs room for one more body per contact and joint.
+	b2TaskExecutor* executor = b2GetTaskExecutor();
+	int32 threadCount = executor != nullptr ? executor->GetThreadCount() : 1;
+	bool parallel = threadCount > 1;
+
+	// Size the island for the worst case.
+	b2Island island(parallel ? m_bodyCount + m_contactManager.m_contactCount + m_jointCount : m_bodyCount,
+					m_contactManager.m_contactCount,
+					m_jointCount,
+					&m_stackAllocator,
+					m_contactManager.m_contactListener);
+
+	// Clear all the island flags.
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		b->m_flags &= ~b2Body::e_islandFlag;
+	}
+	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		c->m_flags &= ~b2Contact::e_islandFlag;
+	}
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		j->m_islandFlag = false;
+	}
+
+	// Build and simulate all awake islands.
+	int32 stackSize = m_bodyCount;
+	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
+
+	// godot_box2d: where each island ended up in the shared arrays, in build order
+	b2IslandRange* islands = nullptr;
+	int32 islandCount = 0;
+	if (parallel)
+	{
+		islands = (b2IslandRange*)m_stackAllocator.Allocate(m_bodyCount * sizeof(b2IslandRange));
+	}
+
+	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+	{
+		if (seed->m_flags & b2Body::e_islandFlag)
+		{
+			continue;
+		}
+
+		if (seed->IsAwake() == false || seed->IsEnabled() == false)
+		{
+			continue;
+		}
+
+		// The seed can be dynamic or kinematic.
+		if (seed->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		// Reset island and stack.
+		// godot_box2d: a parallel solve keeps appending instead
+		if (parallel == false)
+		{
+			island.Clear();
+		}
+		int32 bodyStart = island.m_bodyCount;
+		int32 contactStart = island.m_contactCount;
+		int32 jointStart = island.m_jointCount;
+
+		int32 stackCount = 0;
+		stack[stackCount++] = seed;
+		seed->m_flags |= b2Body::e_islandFlag;
+
+		// Perform a depth first search (DFS) on the constraint graph.
+		while (stackCount > 0)
+		{
+			// Grab the next body off the stack and add it to the island.
+			b2Body* b = stack[--stackCount];
+			b2Assert(b->IsEnabled() == true);
+			island.Add(b);
+
+			// To keep islands as small as possible, we don't
+			// propagate islands across static bodies.
+			if (b->GetType() == b2_staticBody)
+			{
+				continue;
+			}
+
+			// Make sure the body is awake (without resetting sleep timer).
+			b->m_flags |= b2Body::e_awakeFlag;
+
+			// Search all contacts connected to this body.
+			for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
+			{
+				b2Contact* contact = ce->contact;
+
+				// Has this contact already been added to an island?
+				if (contact->m_flags & b2Contact::e_islandFlag)
+				{
+					continue;
+				}
+
+				// Is this contact solid and touching?
+				if (contact->IsEnabled() == false ||
+					contact->IsTouching() == false)
+				{
+					continue;
+				}
+
+				// Skip sensors.
+				bool sensorA = contact->m_fixtureA->m_isSensor;
+				bool sensorB = contact->m_fixtureB->m_isSensor;
+				if (sensorA || sensorB)
+				{
+					continue;
+				}
+
+				island.Add(contact);
+				contact->m_flags |= b2Contact::e_islandFlag;
+
+				b2Body* other = ce->other;
+
+				// Was the other body already added to this island?
+				if (other->m_flags & b2Body::e_islandFlag)
+				{
+					continue;
+				}
+
+				b2Assert(stackCount < stackSize);
+				stack[stackCount++] = other;
+				other->m_flags |= b2Body::e_islandFlag;
+			}
+
+			// Search all joints connect to this body.
+			for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+			{
+				if (je->joint->m_islandFlag == true)
+				{
+					continue;
+				}
+
+				b2Body* other = je->other;
+
+				// Don't simulate joints connected to disabled bodies.
+				if (other->IsEnabled() == false)
+				{
+					continue;
+				}
+
+				island.Add(je->joint);
+				je->joint->m_islandFlag = true;
+
+				if (other->m_flags & b2Body::e_islandFlag)
+				{
+					continue;
+				}
+
+				b2Assert(stackCount < stackSize);
+				stack[stackCount++] = other;
+				other->m_flags |= b2Body::e_islandFlag;
+			}
+		}
+
+		if (parallel)
+		{
+			// godot_box2d: record the island and solve it later. Body indices are made
+			// local to the island, as if it had been built on its own.
+			b2IslandRange* range = islands + islandCount++;
+			range->bodyStart = bodyStart;
+			range->bodyCount = island.m_bodyCount - bodyStart;
+			range->contactStart = contactStart;
+			range->contactCount = island.m_contactCount - contactStart;
+			range->jointStart = jointStart;
+			range->jointCount = island.m_jointCount - jointStart;
+			range->sleep = false;
+
+			for (int32 i = bodyStart; i < island.m_bodyCount; ++i)
+			{
+				b2Body* b = island.m_bodies[i];
+				b->m_islandIndex = i - bodyStart;
+
+				// Allow static bodies to participate in other islands.
+				if (b->GetType() == b2_staticBody)
+				{
+					b->m_flags &= ~b2Body::e_islandFlag;
+				}
+			}
+			continue;
+		}
+
+		b2Profile profile;
+		island.Solve(&profile, step, m_gravity, m_allowSleep);
+		m_profile.solveInit += profile.solveInit;
+		m_profile.solveVelocity += profile.solveVelocity;
+		m_profile.solvePosition += profile.solvePosition;
+
+		// Post solve cleanup.
+		for (int32 i = 0; i < island.m_bodyCount; ++i)
+		{
+			// Allow static bodies to participate in other islands.
+			b2Body* b = island.m_bodies[i];
+			if (b->GetType() == b2_staticBody)
+			{
+				b->m_flags &= ~b2Body::e_islandFlag;
+			}
+		}
+	}
+
+	// godot_box2d: solve the recorded islands on the executor's threads. Each island only writes
+	// to its own bodies, contacts and joints, so the result doesn't depend on the scheduling.
+	if (islandCount > 0)
+	{
+		b2ParallelSolve solve;
+		solve.bodies = island.m_bodies;
+		solve.contacts = island.m_contacts;
+		solve.joints = island.m_joints;
+		solve.islands = islands;
+		solve.step = step;
+		solve.gravity = m_gravity;
+		solve.allowSleep = m_allowSleep;
+
+		// Largest islands first, so the longest solves start early. Ties keep the build order.
+		int32* order = (int32*)m_stackAllocator.Allocate(islandCount * sizeof(int32));
+		int32 totalCost = 0;
+		for (int32 i = 0; i < islandCount; ++i)
+		{
+			order[i] = i;
+			totalCost += b2IslandCost(islands[i]);
+		}
+		std::sort(order, order + islandCount, [islands](int32 a, int32 b)
+		{
+			int32 costA = b2IslandCost(islands[a]);
+			int32 costB = b2IslandCost(islands[b]);
+			return costA != costB ? costA > costB : a < b;
+		});
+
+		// An island at least batchCost big gets a batch of its own. Smaller ones are
+		// grouped in order until their batch adds up to it.
+		int32 batchCost = b2Max(totalCost / (threadCount * 4), b2_minIslandBatchCost);
+		int32* batchStarts = (int32*)m_stackAllocator.Allocate((islandCount + 1) * sizeof(int32));
+		int32 batchCount = 0;
+		int32 cost = 0;
+		for (int32 i = 0; i < islandCount; ++i)
+		{
+			if (cost == 0)
+			{
+				batchStarts[batchCount++] = i;
+			}
+
+			cost += b2IslandCost(islands[order[i]]);
+			if (cost >= batchCost)
+			{
+				cost = 0;
+			}
+		}
+		batchStarts[batchCount] = islandCount;
+
+		solve.order = order;
+		solve.batchStarts = batchStarts;
+		solve.batchCount = batchCount;
+		solve.nextBatch = 0;
+
+		// Each task needs its own stack allocator. The first uses the world's, which this
+		// thread leaves alone until the tasks are done. The others are kept by the executor.
+		int32 taskCount = b2Min(threadCount, batchCount);
+		b2StackAllocator** allocators = (b2StackAllocator**)m_stackAllocator.Allocate(taskCount * sizeof(b2StackAllocator*));
+		allocators[0] = &m_stackAllocator;
+		for (int32 i = 1; i < taskCount; ++i)
+		{
+			allocators[i] = executor->GetStackAllocator(i);
+		}
+		solve.allocators = allocators;
+
+		if (taskCount > 1)
+		{
+			executor->Run(taskCount, b2SolveIslandTask, &solve);
+		}
+		else
+		{
+			b2SolveIslandTask(&solve, 0);
+		}
+
+		m_stackAllocator.Free(allocators);
+		m_stackAllocator.Free(batchStarts);
+		m_stackAllocator.Free(order);
+
+		// Report and sleep in build order, like the serial solve
+		b2ContactListener* listener = m_contactManager.m_contactListener;
+		for (int32 i = 0; i < islandCount; ++i)
+		{
+			const b2IslandRange* range = islands + i;
+			m_profile.solveInit += range->profile.solveInit;
+			m_profile.solveVelocity += range->profile.solveVelocity;
+			m_profile.solvePosition += range->profile.solvePosition;
+
+			if (listener)
+			{
+				for (int32 j = 0; j < range->contactCount; ++j)
+				{
+					b2ReportPostSolve(listener, island.m_contacts[range->contactStart + j]);
+				}
+			}
+
+			if (range->sleep)
+			{
+				for (int32 j = 0; j < range->bodyCount; ++j)
+				{
+					island.m_bodies[range->bodyStart + j]->SetAwake(false);
+				}
+			}
+		}
+	}
+
+	if (islands != nullptr)
+	{
+		m_stackAllocator.Free(islands);
+	}
+
+	m_stackAllocator.Free(stack);
+
+	{
+		b2Timer timer;
+		// Synchronize fixtures, check for out of range bodies.
+		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		{
+			// If a body was not in an island then it did not move.
+			if ((b->m_flags & b2Body::e_islandFlag) == 0)
+			{
+				continue;
+			}
+
+			if (b->GetType() == b2_staticBody)
+			{
+				continue;
+			}
+
+			// Update fixtures (for broad-phase).
+			b->SynchronizeFixtures();
+		}
+
+		// Look for new contacts.
+		m_contactManager.FindNewContacts();
+		m_profile.broadphase = timer.GetMilliseconds();
+	}
+}
+
+// Find TOI contacts and solve them.
+void b2World::SolveTOI(const b2TimeStep& step)
+{
+	b2Island island(2 * b2_maxTOIContacts, b2_maxTOIContacts, 0, &m_stackAllocator, m_contactManager.m_contactListener);
+
+	if (m_stepComplete)
+	{
+		for (b2Body* b = m_bodyList; b; b = b->m_next)
+		{
+			b->m_flags &= ~b2Body::e_islandFlag;
+			b->m_sweep.alpha0 = 0.0f;
+		}
+
+		for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+		{
+			// Invalidate TOI
+			c->m_flags &= ~(b2Contact::e_toiFlag | b2Contact::e_islandFlag);
+			c->m_toiCount = 0;
+			c->m_toi = 1.0f;
+		}
+	}
+
+	// Find TOI events and solve them.
+	for (;;)
+	{
+		// Find the first TOI.
+		b2Contact* minContact = nullptr;
+		float minAlpha = 1.0f;
+
+		for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+		{
+			// Is this contact disabled?
+			if (c->IsEnabled() == false)
+			{
+				continue;
+			}
+
+			// Prevent excessive sub-stepping.
+			if (c->m_toiCount > b2_maxSubSteps)
+			{
+				continue;
+			}
+
+			float alpha = 1.0f;
+			if (c->m_flags & b2Contact::e_toiFlag)
+			{
+				// This contact has a valid cached TOI.
+				alpha = c->m_toi;
+			}
+			else
+			{
+				b2Fixture* fA = c->GetFixtureA();
+				b2Fixture* fB = c->GetFixtureB();
+
+				// Is there a sensor?
+				if (fA->IsSensor() || fB->IsSensor())
+				{
+					continue;
+				}
+
+				b2Body* bA = fA->GetBody();
+				b2Body* bB = fB->GetBody();
+
+				b2BodyType typeA = bA->m_type;
+				b2BodyType typeB = bB->m_type;
+				b2Assert(typeA == b2_dynamicBody || typeB == b2_dynamicBody);
+
+				bool activeA = bA->IsAwake() && typeA != b2_staticBody;
+				bool activeB = bB->IsAwake() && typeB != b2_staticBody;
+
+				// Is at least one body active (awake and dynamic or kinematic)?
+				if (activeA == false && activeB == false)
+				{
+					continue;
+				}
+
+				bool collideA = bA->IsBullet() || typeA != b2_dynamicBody;
+				bool collideB = bB->IsBullet() || typeB != b2_dynamicBody;
+
+				// Are these two non-bullet dynamic bodies?
+				if (collideA == false && collideB == false)
+				{
+					continue;
+				}
+
+				// Compute the TOI for this contact.
+				// Put the sweeps onto the same time interval.
+				float alpha0 = bA->m_sweep.alpha0;
+
+				if (bA->m_sweep.alpha0 < bB->m_sweep.alpha0)
+				{
+					alpha0 = bB->m_sweep.alpha0;
+					bA->m_sweep.Advance(alpha0);
+				}
+				else if (bB->m_sweep.alpha0 < bA->m_sweep.alpha0)
+				{
+					alpha0 = bA->m_sweep.alpha0;
+					bB->m_sweep.Advance(alpha0);
+				}
+
+				b2Assert(alpha0 < 1.0f);
+
+				int32 indexA = c->GetChildIndexA();
+				int32 indexB = c->GetChildIndexB();
+
+				// Compute the time of impact in interval [0, minTOI]
+				b2TOIInput input;
+				input.proxyA.Set(fA->GetShape(), indexA);
+				input.proxyB.Set(fB->GetShape(), indexB);
+				input.sweepA = bA->m_sweep;
+				input.sweepB = bB->m_sweep;
+				input.tMax = 1.0f;
+
+				b2TOIOutput output;
+				b2TimeOfImpact(&output, &input);
+
+				// Beta is the fraction of the remaining portion of the .
+				float beta = output.t;
+				if (output.state == b2TOIOutput::e_touching)
+				{
+					alpha = b2Min(alpha0 + (1.0f - alpha0) * beta, 1.0f);
+				}
+				else
+				{
+					alpha = 1.0f;
+				}
+
+				c->m_toi = alpha;
+				c->m_flags |= b2Contact::e_toiFlag;
+			}
+
+			if (alpha < minAlpha)
+			{
+				// This is the minimum TOI found so far.
+				minContact = c;
+				minAlpha = alpha;
+			}
+		}
+
+		if (minContact == nullptr || 1.0f - 10.0f * b2_epsilon < minAlpha)
+		{
+			// No more TOI events. Done!
+			m_stepComplete = true;
+			break;
+		}
+
+		// Advance the bodies to the TOI.
+		b2Fixture* fA = minContact->GetFixtureA();
+		b2Fixture* fB = minContact->GetFixtureB();
+		b2Body* bA = fA->GetBody();
+		b2Body* bB = fB->GetBody();
+
+		b2Sweep backup1 = bA->m_sweep;
+		b2Sweep backup2 = bB->m_sweep;
+
+		bA->Advance(minAlpha);
+		bB->Advance(minAlpha);
+
+		// The TOI contact likely has some new contact points.
+		minContact->Update(m_contactManager.m_contactListener);
+		minContact->m_flags &= ~b2Contact::e_toiFlag;
+		++minContact->m_toiCount;
+
+		// Is the contact solid?
+		if (minContact->IsEnabled() == false || minContact->IsTouching() == false)
+		{
+			// Restore the sweeps.
+			minContact->SetEnabled(false);
+			bA->m_sweep = backup1;
+			bB->m_sweep = backup2;
+			bA->SynchronizeTransform();
+			bB->SynchronizeTransform();
+			continue;
+		}
+
+		bA->SetAwake(true);
+		bB->SetAwake(true);
+
+		// Build the island
+		island.Clear();
+		island.Add(bA);
+		island.Add(bB);
+		island.Add(minContact);
+
+		bA->m_flags |= b2Body::e_islandFlag;
+		bB->m_flags |= b2Body::e_islandFlag;
+		minContact->m_flags |= b2Contact::e_islandFlag;
+
+		// Get contacts on bodyA and bodyB.
+		b2Body* bodies[2] = {bA, bB};
+		for (int32 i = 0; i < 2; ++i)
+		{
+			b2Body* body = bodies[i];
+			if (body->m_type == b2_dynamicBody)
+			{
+				for (b2ContactEdge* ce = body->m_contactList; ce; ce = ce->next)
+				{
+					if (island.m_bodyCount == island.m_bodyCapacity)
+					{
+						break;
+					}
+
+					if (island.m_contactCount == island.m_contactCapacity)
+					{
+						break;
+					}
+
+					b2Contact* contact = ce->contact;
+
+					// Has this contact already been added to the island?
+					if (contact->m_flags & b2Contact::e_islandFlag)
+					{
+						continue;
+					}
+
+					// Only add static, kinematic, or bullet bodies.
+					b2Body* other = ce->other;
+					if (other->m_type == b2_dynamicBody &&
+						body->IsBullet() == false && other->IsBullet() == false)
+					{
+						continue;
+					}
+
+					// Skip sensors.
+					bool sensorA = contact->m_fixtureA->m_isSensor;
+					bool sensorB = contact->m_fixtureB->m_isSensor;
+					if (sensorA || sensorB)
+					{
+						continue;
+					}
+
+					// Tentatively advance the body to the TOI.
+					b2Sweep backup = other->m_sweep;
+					if ((other->m_flags & b2Body::e_islandFlag) == 0)
+					{
+						other->Advance(minAlpha);
+					}
+
+					// Update the contact points
+					contact->Update(m_contactManager.m_contactListener);
+
+					// Was the contact disabled by the user?
+					if (contact->IsEnabled() == false)
+					{
+						other->m_sweep = backup;
+						other->SynchronizeTransform();
+						continue;
+					}
+
+					// Are there contact points?
+					if (contact->IsTouching() == false)
+					{
+						other->m_sweep = backup;
+						other->SynchronizeTransform();
+						continue;
+					}
+
+					// Add the contact to the island
+					contact->m_flags |= b2Contact::e_islandFlag;
+					island.Add(contact);
+
+					// Has the other body already been added to the island?
+					if (other->m_flags & b2Body::e_islandFlag)
+					{
+						continue;
+					}
+
+					// Add the other body to the island.
+					other->m_flags |= b2Body::e_islandFlag;
+
+					if (other->m_type != b2_staticBody)
+					{
+						other->SetAwake(true);
+					}
+
+					island.Add(other);
+				}
+			}
+		}
+
+		b2TimeStep subStep;
+		subStep.dt = (1.0f - minAlpha) * step.dt;
+		subStep.inv_dt = 1.0f / subStep.dt;
+		subStep.dtRatio = 1.0f;
+		subStep.positionIterations = 20;
+		subStep.velocityIterations = step.velocityIterations;
+		subStep.warmStarting = false;
+		island.SolveTOI(subStep, bA->m_islandIndex, bB->m_islandIndex);
+
+		// Reset island flags and synchronize broad-phase proxies.
+		for (int32 i = 0; i < island.m_bodyCount; ++i)
+		{
+			b2Body* body = island.m_bodies[i];
+			body->m_flags &= ~b2Body::e_islandFlag;
+
+			if (body->m_type != b2_dynamicBody)
+			{
+				continue;
+			}
+
+			body->SynchronizeFixtures();
+
+			// Invalidate all contact TOIs on this displaced body.
+			for (b2ContactEdge* ce = body->m_contactList; ce; ce = ce->next)
+			{
+				ce->contact->m_flags &= ~(b2Contact::e_toiFlag | b2Contact::e_islandFlag);
+			}
+		}
+
+		// Commit fixture proxy movements to the broad-phase so that new contacts are created.
+		// Also, some contacts can be destroyed.
+		m_contactManager.FindNewContacts();
+
+		if (m_subStepping)
+		{
+			m_stepComplete = false;
+			break;
+		}
+	}
+}
+
+void b2World::Step(float dt, int32 velocityIterations, int32 positionIterations)
+{
+	b2Timer stepTimer;
+
+	// If new fixtures were added, we need to find the new contacts.
+	if (m_newContacts)
+	{
+		m_contactManager.FindNewContacts();
+		m_newContacts = false;
+	}
+
+	m_locked = true;
+
+	b2TimeStep step;
+	step.dt = dt;
+	step.velocityIterations	= velocityIterations;
+	step.positionIterations = positionIterations;
+	if (dt > 0.0f)
+	{
+		step.inv_dt = 1.0f / dt;
+	}
+	else
+	{
+		step.inv_dt = 0.0f;
+	}
+
+	step.dtRatio = m_inv_dt0 * dt;
+
+	step.warmStarting = m_warmStarting;
+
+	// Update contacts. This is where some contacts are destroyed.
+	{
+		b2Timer timer;
+		m_contactManager.Collide();
+		m_profile.collide = timer.GetMilliseconds();
+	}
+
+	// Integrate velocities, solve velocity constraints, and integrate positions.
+	if (m_stepComplete && step.dt > 0.0f)
+	{
+		b2Timer timer;
+		Solve(step);
+		m_profile.solve = timer.GetMilliseconds();
+	}
+
+	// Handle TOI events.
+	if (m_continuousPhysics && step.dt > 0.0f)
+	{
+		b2Timer timer;
+		SolveTOI(step);
+		m_profile.solveTOI = timer.GetMilliseconds();
+	}
+
+	if (step.dt > 0.0f)
+	{
+		m_inv_dt0 = step.inv_dt;
+	}
+
+	if (m_clearForces)
+	{
+		ClearForces();
+	}
+
+	m_locked = false;
+
+	m_profile.step = stepTimer.GetMilliseconds();
+}
+
+void b2World::ClearForces()
+{
+	for (b2Body* body = m_bodyList; body; body = body->GetNext())
+	{
+		body->m_force.SetZero();
+		body->m_torque = 0.0f;
+	}
+}
+
+struct b2WorldQueryWrapper
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		b2FixtureProxy* proxy = (b2FixtureProxy*)broadPhase->GetUserData(proxyId);
+		return callback->ReportFixture(proxy->fixture);
+	}
+
+	const b2BroadPhase* broadPhase;
+	b2QueryCallback* callback;
+};
+
+void b2World::QueryAABB(b2QueryCallback* callback, const b2AABB& aabb) const
+{
+	b2WorldQueryWrapper wrapper;
+	wrapper.broadPhase = &m_contactManager.m_broadPhase;
+	wrapper.callback = callback;
+	m_contactManager.m_broadPhase.Query(&wrapper, aabb);
+}
+
+struct b2WorldRayCastWrapper
+{
+	float RayCastCallback(const b2RayCastInput& input, int32 proxyId)
+	{
+		void* userData = broadPhase->GetUserData(proxyId);
+		b2FixtureProxy* proxy = (b2FixtureProxy*)userData;
+		b2Fixture* fixture = proxy->fixture;
+		int32 index = proxy->childIndex;
+		b2RayCastOutput output;
+		bool hit = fixture->RayCast(&output, input, index);
+
+		if (hit)
+		{
+			float fraction = output.fraction;
+			b2Vec2 point = (1.0f - fraction) * input.p1 + fraction * input.p2;
+			return callback->ReportFixture(fixture, point, output.normal, fraction);
+		}
+
+		return input.maxFraction;
+	}
+
+	const b2BroadPhase* broadPhase;
+	b2RayCastCallback* callback;
+};
+
+void b2World::RayCast(b2RayCastCallback* callback, const b2Vec2& point1, const b2Vec2& point2) const
+{
+	b2WorldRayCastWrapper wrapper;
+	wrapper.broadPhase = &m_contactManager.m_broadPhase;
+	wrapper.callback = callback;
+	b2RayCastInput input;
+	input.maxFraction = 1.0f;
+	input.p1 = point1;
+	input.p2 = point2;
+	m_contactManager.m_broadPhase.RayCast(&wrapper, input);
+}
+
+void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color& color)
+{
+	switch (fixture->GetType())
+	{
+	case b2Shape::e_circle:
+		{
+			b2CircleShape* circle = (b2CircleShape*)fixture->GetShape();
+
+			b2Vec2 center = b2Mul(xf, circle->m_p);
+			float radius = circle->m_radius;
+			b2Vec2 axis = b2Mul(xf.q, b2Vec2(1.0f, 0.0f));
+
+			m_debugDraw->DrawSolidCircle(center, radius, axis, color);
+		}
+		break;
+
+	case b2Shape::e_edge:
+		{
+			b2EdgeShape* edge = (b2EdgeShape*)fixture->GetShape();
+			b2Vec2 v1 = b2Mul(xf, edge->m_vertex1);
+			b2Vec2 v2 = b2Mul(xf, edge->m_vertex2);
+			m_debugDraw->DrawSegment(v1, v2, color);
+
+			if (edge->m_oneSided == false)
+			{
+				m_debugDraw->DrawPoint(v1, 4.0f, color);
+				m_debugDraw->DrawPoint(v2, 4.0f, color);
+			}
+		}
+		break;
+
+	case b2Shape::e_chain:
+		{
+			b2ChainShape* chain = (b2ChainShape*)fixture->GetShape();
+			int32 count = chain->m_count;
+			const b2Vec2* vertices = chain->m_vertices;
+
+			b2Vec2 v1 = b2Mul(xf, vertices[0]);
+			for (int32 i = 1; i < count; ++i)
+			{
+				b2Vec2 v2 = b2Mul(xf, vertices[i]);
+				m_debugDraw->DrawSegment(v1, v2, color);
+				v1 = v2;
+			}
+		}
+		break;
+
+	case b2Shape::e_polygon:
+		{
+			b2PolygonShape* poly = (b2PolygonShape*)fixture->GetShape();
+			int32 vertexCount = poly->m_count;
+			b2Assert(vertexCount <= b2_maxPolygonVertices);
+			b2Vec2 vertices[b2_maxPolygonVertices];
+
+			for (int32 i = 0; i < vertexCount; ++i)
+			{
+				vertices[i] = b2Mul(xf, poly->m_vertices[i]);
+			}
+
+			m_debugDraw->DrawSolidPolygon(vertices, vertexCount, color);
+		}
+		break;
+
+	default:
+	break;
+	}
+}
+
+void b2World::DebugDraw()
+{
+	if (m_debugDraw == nullptr)
+	{
+		return;
+	}
+
+	uint32 flags = m_debugDraw->GetFlags();
+
+	if (flags & b2Draw::e_shapeBit)
+	{
+		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		{
+			const b2Transform& xf = b->GetTransform();
+			for (b2Fixture* f = b->GetFixtureList(); f; f = f->GetNext())
+			{
+				if (b->GetType() == b2_dynamicBody && b->m_mass == 0.0f)
+				{
+					// Bad body
+					DrawShape(f, xf, b2Color(1.0f, 0.0f, 0.0f));
+				}
+				else if (b->IsEnabled() == false)
+				{
+					DrawShape(f, xf, b2Color(0.5f, 0.5f, 0.3f));
+				}
+				else if (b->GetType() == b2_staticBody)
+				{
+					DrawShape(f, xf, b2Color(0.5f, 0.9f, 0.5f));
+				}
+				else if (b->GetType() == b2_kinematicBody)
+				{
+					DrawShape(f, xf, b2Color(0.5f, 0.5f, 0.9f));
+				}
+				else if (b->IsAwake() == false)
+				{
+					DrawShape(f, xf, b2Color(0.6f, 0.6f, 0.6f));
+				}
+				else
+				{
+					DrawShape(f, xf, b2Color(0.9f, 0.7f, 0.7f));
+				}
+			}
+		}
+	}
+
+	if (flags & b2Draw::e_jointBit)
+	{
+		for (b2Joint* j = m_jointList; j; j = j->GetNext())
+		{
+			j->Draw(m_debugDraw);
+		}
+	}
+
+	if (flags & b2Draw::e_pairBit)
+	{
+		b2Color color(0.3f, 0.9f, 0.9f);
+		for (b2Contact* c = m_contactManager.m_contactList; c; c = c->GetNext())
+		{
+			b2Fixture* fixtureA = c->GetFixtureA();
+			b2Fixture* fixtureB = c->GetFixtureB();
+			int32 indexA = c->GetChildIndexA();
+			int32 indexB = c->GetChildIndexB();
+			b2Vec2 cA = fixtureA->GetAABB(indexA).GetCenter();
+			b2Vec2 cB = fixtureB->GetAABB(indexB).GetCenter();
+
+			m_debugDraw->DrawSegment(cA, cB, color);
+		}
+	}
+
+	if (flags & b2Draw::e_aabbBit)
+	{
+		b2Color color(0.9f, 0.3f, 0.9f);
+		b2BroadPhase* bp = &m_contactManager.m_broadPhase;
+
+		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		{
+			if (b->IsEnabled() == false)
+			{
+				continue;
+			}
+
+			for (b2Fixture* f = b->GetFixtureList(); f; f = f->GetNext())
+			{
+				for (int32 i = 0; i < f->m_proxyCount; ++i)
+				{
+					b2FixtureProxy* proxy = f->m_proxies + i;
+					b2AABB aabb = bp->GetFatAABB(proxy->proxyId);
+					b2Vec2 vs[4];
+					vs[0].Set(aabb.lowerBound.x, aabb.lowerBound.y);
+					vs[1].Set(aabb.upperBound.x, aabb.lowerBound.y);
+					vs[2].Set(aabb.upperBound.x, aabb.upperBound.y);
+					vs[3].Set(aabb.lowerBound.x, aabb.upperBound.y);
+
+					m_debugDraw->DrawPolygon(vs, 4, color);
+				}
+			}
+		}
+	}
+
+	if (flags & b2Draw::e_centerOfMassBit)
+	{
+		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		{
+			b2Transform xf = b->GetTransform();
+			xf.p = b->GetWorldCenter();
+			m_debugDraw->DrawTransform(xf);
+		}
+	}
+}
+
+int32 b2World::GetProxyCount() const
+{
+	return m_contactManager.m_broadPhase.GetProxyCount();
+}
+
+int32 b2World::GetTreeHeight() const
+{
+	return m_contactManager.m_broadPhase.GetTreeHeight();
+}
+
+int32 b2World::GetTreeBalance() const
+{
+	return m_contactManager.m_broadPhase.GetTreeBalance();
+}
+
+float b2World::GetTreeQuality() const
+{
+	return m_contactManager.m_broadPhase.GetTreeQuality();
+}
+
+void b2World::ShiftOrigin(const b2Vec2& newOrigin)
+{
+	b2Assert(m_locked == false);
+	if (m_locked)
+	{
+		return;
+	}
+
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		b->m_xf.p -= newOrigin;
+		b->m_sweep.c0 -= newOrigin;
+		b->m_sweep.c -= newOrigin;
+	}
+
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		j->ShiftOrigin(newOrigin);
+	}
+
+	m_contactManager.m_broadPhase.ShiftOrigin(newOrigin);
+}
+
+void b2World::Dump()
+{
+	if (m_locked)
+	{
+		return;
+	}
+
+	b2OpenDump("box2d_dump.inl");
+
+	b2Dump("b2Vec2 g(%.9g, %.9g);\n", m_gravity.x, m_gravity.y);
+	b2Dump("m_world->SetGravity(g);\n");
+
+	b2Dump("b2Body** bodies = (b2Body**)b2Alloc(%d * sizeof(b2Body*));\n", m_bodyCount);
+	b2Dump("b2Joint** joints = (b2Joint**)b2Alloc(%d * sizeof(b2Joint*));\n", m_jointCount);
+
+	int32 i = 0;
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		b->m_islandIndex = i;
+		b->Dump();
+		++i;
+	}
+
+	i = 0;
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		j->m_index = i;
+		++i;
+	}
+
+	// First pass on joints, skip gear joints.
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		if (j->m_type == e_gearJoint)
+		{
+			continue;
+		}
+
+		b2Dump("{\n");
+		j->Dump();
+		b2Dump("}\n");
+	}
+
+	// Second pass on joints, only gear joints.
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		if (j->m_type != e_gearJoint)
+		{
+			continue;
+		}
+
+		b2Dump("{\n");
+		j->Dump();
+		b2Dump("}\n");
+	}
+
+	b2Dump("b2Free(joints);\n");
+	b2Dump("b2Free(bodies);\n");
+	b2Dump("joints = nullptr;\n");
+	b2Dump("bodies = nullptr;\n");
+
+	b2CloseDump();
+}
@@ -2,11 +2,15 @@
 
 #include "editor/box2d_polygon_editor_plugin.h"
 #include "editor/box2d_shape_editor_plugin.h"
+#include "scene/2d/box2d_character_body.h"
 #include "scene/2d/box2d_fixtures.h"
 #include "scene/2d/box2d_joints.h"
 #include "scene/2d/box2d_physics_body.h"
 #include "scene/2d/box2d_world.h"
+#include "scene/resources/box2d_collision_rules.h"
 #include "scene/resources/box2d_shapes.h"
+#include "util/box2d_string_names.h"
+#include "util/box2d_task_executor.h"
 
 /**
 * @author Brian Semrau
@@ -15,9 +19,13 @@
 void register_godot_box2d_types() {
 	GLOBAL_DEF("physics/2d/box2d_conversion_factor", 50.0f);
 	ProjectSettings::get_singleton()->set_custom_property_info("physics/2d/box2d_conversion_factor", PropertyInfo(Variant::FLOAT, "physics/2d/box2d_conversion_factor"));
+	Box2DConversionContext::refresh();
+	Box2DStringNames::create();
 
 	ClassDB::register_class<Box2DWorld>();
+	ClassDB::register_class<Box2DShapeQueryParameters>();
 	ClassDB::register_class<Box2DPhysicsBody>();
+	ClassDB::register_class<Box2DCharacterBody>();
 	ClassDB::register_class<Box2DFixture>();
 	ClassDB::register_virtual_class<Box2DShape>();
 	ClassDB::register_class<Box2DCircleShape>();
@@ -25,6 +33,7 @@ void register_godot_box2d_types() {
 	ClassDB::register_class<Box2DSegmentShape>();
 	ClassDB::register_class<Box2DPolygonShape>();
 	ClassDB::register_class<Box2DCapsuleShape>();
+	ClassDB::register_class<Box2DCollisionRules>();
 
 	ClassDB::register_virtual_class<Box2DJoint>();
 	ClassDB::register_class<Box2DRevoluteJoint>();
@@ -40,4 +49,7 @@ void register_godot_box2d_types() {
 }
 
 void unregister_godot_box2d_types() {
+	Box2DWorld::finish_group_pool();
+	Box2DTaskExecutor::finish_pool();
+	Box2DStringNames::free();
 }
@@ -0,0 +1,324 @@
+#include "box2d_character_body.h"
+
+#include <core/config/engine.h>
+
+#include "box2d_fixtures.h"
+
+/**
+* @author Brian Semrau
+*/
+
+// Slack on floor_max_angle, so a floor at exactly the max angle still counts
+#define FLOOR_ANGLE_THRESHOLD 0.01
+
+void Box2DCharacterBody::build_cast_children() {
+	// Fixture shapes are already in body space. The children only need the body's rotation.
+	const b2Transform rotation(b2Vec2_zero, body->GetTransform().q);
+
+	cast_children.clear();
+	for (b2Fixture *fixture = body->GetFixtureList(); fixture; fixture = fixture->GetNext()) {
+		if (fixture->IsSensor()) {
+			continue;
+		}
+
+		const b2Shape *shape = fixture->GetShape();
+		for (int32 i = 0; i < shape->GetChildCount(); ++i) {
+			Box2DWorld::QueryChild child;
+			child.shape = shape;
+			child.child = i;
+			child.fixture = fixture;
+			shape->ComputeAABB(&child.aabb, rotation, i);
+			cast_children.push_back(child);
+		}
+	}
+}
+
+b2Vec2 Box2DCharacterBody::get_floor_point_velocity() const {
+	// Read the floor's velocity now rather than at the last move, so a platform that changed speed doesn't lag a frame
+	Box2DPhysicsBody *floor = Object::cast_to<Box2DPhysicsBody>(ObjectDB::get_instance(floor_body));
+	if (!floor || !floor->body) {
+		return b2Vec2_zero;
+	}
+	return floor->body->GetLinearVelocityFromWorldPoint(floor->body->GetWorldPoint(floor_local_point));
+}
+
+bool Box2DCharacterBody::is_floor_normal(const Vector2 &p_normal) const {
+	const Vector2 up = up_direction.normalized();
+	return up != Vector2() && Math::acos(CLAMP(p_normal.dot(up), -1.0f, 1.0f)) <= floor_max_angle + FLOOR_ANGLE_THRESHOLD;
+}
+
+bool Box2DCharacterBody::add_slide_collision(const Box2DWorld::ShapeCastHit &p_hit) {
+	b2Body *other = p_hit.fixture->GetBody();
+
+	SlideCollision collision;
+	collision.position = b2_to_gd(p_hit.point);
+	collision.normal = Vector2(p_hit.normal.x, p_hit.normal.y);
+	collision.collider_velocity = b2_to_gd(other->GetLinearVelocityFromWorldPoint(p_hit.point));
+	collision.collider = other->GetUserData().owner->get_instance_id();
+	collision.collider_fixture = p_hit.fixture->GetUserData().owner->get_instance_id();
+	slide_collisions.push_back(collision);
+
+	const Vector2 up = up_direction.normalized();
+	if (up == Vector2()) {
+		// Without an up direction, everything is a wall
+		on_wall = true;
+		return false;
+	}
+
+	if (is_floor_normal(collision.normal)) {
+		on_floor = true;
+		floor_normal = collision.normal;
+		floor_velocity = collision.collider_velocity;
+		floor_body = collision.collider;
+		floor_local_point = other->GetLocalPoint(p_hit.point);
+		return true;
+	}
+
+	if (Math::acos(CLAMP(collision.normal.dot(-up), -1.0f, 1.0f)) <= floor_max_angle + FLOOR_ANGLE_THRESHOLD) {
+		on_ceiling = true;
+	} else {
+		on_wall = true;
+	}
+	return false;
+}
+
+void Box2DCharacterBody::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("move_and_slide", "linear_velocity"), &Box2DCharacterBody::move_and_slide);
+
+	ClassDB::bind_method(D_METHOD("set_up_direction", "up_direction"), &Box2DCharacterBody::set_up_direction);
+	ClassDB::bind_method(D_METHOD("get_up_direction"), &Box2DCharacterBody::get_up_direction);
+	ClassDB::bind_method(D_METHOD("set_floor_max_angle", "radians"), &Box2DCharacterBody::set_floor_max_angle);
+	ClassDB::bind_method(D_METHOD("get_floor_max_angle"), &Box2DCharacterBody::get_floor_max_angle);
+	ClassDB::bind_method(D_METHOD("set_max_slides", "max_slides"), &Box2DCharacterBody::set_max_slides);
+	ClassDB::bind_method(D_METHOD("get_max_slides"), &Box2DCharacterBody::get_max_slides);
+	ClassDB::bind_method(D_METHOD("set_stop_on_slope", "enabled"), &Box2DCharacterBody::set_stop_on_slope);
+	ClassDB::bind_method(D_METHOD("is_stop_on_slope_enabled"), &Box2DCharacterBody::is_stop_on_slope_enabled);
+	ClassDB::bind_method(D_METHOD("set_floor_snap_length", "length"), &Box2DCharacterBody::set_floor_snap_length);
+	ClassDB::bind_method(D_METHOD("get_floor_snap_length"), &Box2DCharacterBody::get_floor_snap_length);
+	ClassDB::bind_method(D_METHOD("set_infinite_inertia", "enabled"), &Box2DCharacterBody::set_infinite_inertia);
+	ClassDB::bind_method(D_METHOD("is_infinite_inertia_enabled"), &Box2DCharacterBody::is_infinite_inertia_enabled);
+
+	ClassDB::bind_method(D_METHOD("is_on_floor"), &Box2DCharacterBody::is_on_floor);
+	ClassDB::bind_method(D_METHOD("is_on_wall"), &Box2DCharacterBody::is_on_wall);
+	ClassDB::bind_method(D_METHOD("is_on_ceiling"), &Box2DCharacterBody::is_on_ceiling);
+	ClassDB::bind_method(D_METHOD("get_floor_normal"), &Box2DCharacterBody::get_floor_normal);
+	ClassDB::bind_method(D_METHOD("get_floor_velocity"), &Box2DCharacterBody::get_floor_velocity);
+	ClassDB::bind_method(D_METHOD("get_floor_body"), &Box2DCharacterBody::get_floor_body);
+
+	ClassDB::bind_method(D_METHOD("get_slide_count"), &Box2DCharacterBody::get_slide_count);
+	ClassDB::bind_method(D_METHOD("get_slide_position", "idx"), &Box2DCharacterBody::get_slide_position);
+	ClassDB::bind_method(D_METHOD("get_slide_normal", "idx"), &Box2DCharacterBody::get_slide_normal);
+	ClassDB::bind_method(D_METHOD("get_slide_collider_velocity", "idx"), &Box2DCharacterBody::get_slide_collider_velocity);
+	ClassDB::bind_method(D_METHOD("get_slide_collider", "idx"), &Box2DCharacterBody::get_slide_collider);
+	ClassDB::bind_method(D_METHOD("get_slide_collider_fixture", "idx"), &Box2DCharacterBody::get_slide_collider_fixture);
+
+	ADD_PROPERTY(PropertyInfo(Variant::VECTOR2, "up_direction"), "set_up_direction", "get_up_direction");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_slides", PROPERTY_HINT_RANGE, "1,16,1"), "set_max_slides", "get_max_slides");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "stop_on_slope"), "set_stop_on_slope", "is_stop_on_slope_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "infinite_inertia"), "set_infinite_inertia", "is_infinite_inertia_enabled");
+	ADD_GROUP("Floor", "floor_");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "floor_max_angle", PROPERTY_HINT_RANGE, "0,180,0.1,radians"), "set_floor_max_angle", "get_floor_max_angle");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "floor_snap_length", PROPERTY_HINT_RANGE, "0,64,0.1,or_greater"), "set_floor_snap_length", "get_floor_snap_length");
+}
+
+String Box2DCharacterBody::get_configuration_warning() const {
+	String warning = Box2DPhysicsBody::get_configuration_warning();
+
+	if (get_type() != MODE_KINEMATIC) {
+		if (warning != String()) {
+			warning += "\n\n";
+		}
+		warning += TTR("Box2DCharacterBody moves itself with move_and_slide(), so it should be kinematic.");
+	}
+
+	return warning;
+}
+
+Vector2 Box2DCharacterBody::move_and_slide(const Vector2 &p_linear_velocity) {
+	ERR_FAIL_COND_V_MSG(!body || !world_node, p_linear_velocity, "Box2DCharacterBody can only move inside a Box2DWorld.");
+	// The dynamic tree is only safe to read outside of Step
+	world_node->wait_for_step();
+
+	build_cast_children();
+
+	const real_t delta = Engine::get_singleton()->is_in_physics_frame() ? get_physics_process_delta_time() : get_process_delta_time();
+	const Vector2 up = up_direction.normalized();
+	const Vector2 velocity_normal = p_linear_velocity.normalized();
+	const bool was_on_floor = on_floor;
+
+	// Moving platforms carry the body with them
+	b2Vec2 floor_motion = was_on_floor ? delta * get_floor_point_velocity() : b2Vec2_zero;
+
+	// Get out of anything the body already overlaps. A platform that moved into the body during the
+	// last step has already carried it that far, so that much of the platform's motion is dropped.
+	b2Transform xf = body->GetTransform();
+	const b2Vec2 start = xf.p;
+	b2Vec2 separation_dir = world_node->separate_query_children(cast_children, xf, cast_candidates, infinite_inertia);
+	const float separation_length = separation_dir.Normalize();
+	if (separation_length > 0.0f) {
+		const float along = b2Dot(floor_motion, separation_dir);
+		if (along > 0.0f) {
+			floor_motion -= MIN(along, separation_length) * separation_dir;
+		}
+	}
+
+	on_floor = false;
+	on_wall = false;
+	on_ceiling = false;
+	floor_normal = Vector2();
+	floor_velocity = Vector2();
+	floor_body = ObjectID();
+	slide_collisions.clear();
+
+	Vector2 body_velocity = p_linear_velocity;
+	b2Vec2 motion = floor_motion + gd_to_b2(p_linear_velocity * delta);
+	Box2DWorld::ShapeCastHit hit;
+
+	for (int i = 0; i < max_slides && motion.LengthSquared() > 0.0f; ++i) {
+		if (!world_node->cast_query_children(cast_children, xf, motion, NULL, cast_candidates, hit, infinite_inertia)) {
+			xf.p += motion;
+			break;
+		}
+
+		const b2Vec2 travel = hit.fraction * motion;
+		xf.p += travel;
+
+		if (add_slide_collision(hit) && stop_on_slope && (velocity_normal + up).length() < 0.01f && b2_to_gd(travel).length() < 1.0f) {
+			// Only pushed straight down against a slope. Undo the slide down it and stand still.
+			const b2Vec2 up_b2(up.x, up.y);
+			xf.p -= travel - b2Dot(travel, up_b2) * up_b2;
+			body_velocity = Vector2();
+			break;
+		}
+
+		// Drop the part of the motion that goes into the surface
+		const b2Vec2 remainder = motion - travel;
+		motion = remainder - b2Dot(remainder, hit.normal) * hit.normal;
+		body_velocity = body_velocity.slide(Vector2(hit.normal.x, hit.normal.y));
+	}
+
+	// Stay on the floor over steps and down slopes, unless moving away from it
+	if (was_on_floor && !on_floor && floor_snap_length > 0.0f && up != Vector2() && p_linear_velocity.dot(up) <= 0.0f) {
+		const b2Vec2 snap = gd_to_b2(-up * floor_snap_length);
+		if (world_node->cast_query_children(cast_children, xf, snap, NULL, cast_candidates, hit, infinite_inertia) && is_floor_normal(Vector2(hit.normal.x, hit.normal.y))) {
+			xf.p += hit.fraction * snap;
+			add_slide_collision(hit);
+		}
+	}
+
+	if (xf.p != start) {
+		// NOTIFICATION_LOCAL_TRANSFORM_CHANGED sends the new position to the b2Body
+		Transform2D xform = get_box2dworld_transform();
+		xform.set_origin(b2_to_gd(xf.p));
+		set_box2dworld_transform(xform);
+	}
+
+	return body_velocity;
+}
+
+void Box2DCharacterBody::set_up_direction(const Vector2 &p_direction) {
+	up_direction = p_direction;
+}
+
+Vector2 Box2DCharacterBody::get_up_direction() const {
+	return up_direction;
+}
+
+void Box2DCharacterBody::set_floor_max_angle(real_t p_radians) {
+	floor_max_angle = p_radians;
+}
+
+real_t Box2DCharacterBody::get_floor_max_angle() const {
+	return floor_max_angle;
+}
+
+void Box2DCharacterBody::set_max_slides(int p_max_slides) {
+	ERR_FAIL_COND_MSG(p_max_slides < 1, "max_slides must be at least 1.");
+	max_slides = p_max_slides;
+}
+
+int Box2DCharacterBody::get_max_slides() const {
+	return max_slides;
+}
+
+void Box2DCharacterBody::set_stop_on_slope(bool p_stop) {
+	stop_on_slope = p_stop;
+}
+
+bool Box2DCharacterBody::is_stop_on_slope_enabled() const {
+	return stop_on_slope;
+}
+
+void Box2DCharacterBody::set_floor_snap_length(real_t p_length) {
+	ERR_FAIL_COND(p_length < 0.0f);
+	floor_snap_length = p_length;
+}
+
+real_t Box2DCharacterBody::get_floor_snap_length() const {
+	return floor_snap_length;
+}
+
+void Box2DCharacterBody::set_infinite_inertia(bool p_enabled) {
+	infinite_inertia = p_enabled;
+}
+
+bool Box2DCharacterBody::is_infinite_inertia_enabled() const {
+	return infinite_inertia;
+}
+
+bool Box2DCharacterBody::is_on_floor() const {
+	return on_floor;
+}
+
+bool Box2DCharacterBody::is_on_wall() const {
+	return on_wall;
+}
+
+bool Box2DCharacterBody::is_on_ceiling() const {
+	return on_ceiling;
+}
+
+Vector2 Box2DCharacterBody::get_floor_normal() const {
+	return floor_normal;
+}
+
+Vector2 Box2DCharacterBody::get_floor_velocity() const {
+	return floor_velocity;
+}
+
+Object *Box2DCharacterBody::get_floor_body() const {
+	return ObjectDB::get_instance(floor_body);
+}
+
+int Box2DCharacterBody::get_slide_count() const {
+	return slide_collisions.size();
+}
+
+Vector2 Box2DCharacterBody::get_slide_position(int p_idx) const {
+	ERR_FAIL_INDEX_V(p_idx, (int)slide_collisions.size(), Vector2());
+	return slide_collisions[p_idx].position;
+}
+
+Vector2 Box2DCharacterBody::get_slide_normal(int p_idx) const {
+	ERR_FAIL_INDEX_V(p_idx, (int)slide_collisions.size(), Vector2());
+	return slide_collisions[p_idx].normal;
+}
+
+Vector2 Box2DCharacterBody::get_slide_collider_velocity(int p_idx) const {
+	ERR_FAIL_INDEX_V(p_idx, (int)slide_collisions.size(), Vector2());
+	return slide_collisions[p_idx].collider_velocity;
+}
+
+Object *Box2DCharacterBody::get_slide_collider(int p_idx) const {
+	ERR_FAIL_INDEX_V(p_idx, (int)slide_collisions.size(), NULL);
+	return ObjectDB::get_instance(slide_collisions[p_idx].collider);
+}
+
+Object *Box2DCharacterBody::get_slide_collider_fixture(int p_idx) const {
+	ERR_FAIL_INDEX_V(p_idx, (int)slide_collisions.size(), NULL);
+	return ObjectDB::get_instance(slide_collisions[p_idx].collider_fixture);
+}
+
+Box2DCharacterBody::Box2DCharacterBody() {
+	set_type(MODE_KINEMATIC);
+}
@@ -0,0 +1,101 @@
+#ifndef BOX2D_CHARACTER_BODY_H
+#define BOX2D_CHARACTER_BODY_H
+
+#include <core/templates/local_vector.h>
+
+#include "box2d_physics_body.h"
+#include "box2d_world.h"
+
+/**
+* @author Brian Semrau
+*/
+
+// A kinematic body moved by move_and_slide(), like KinematicBody2D.
+// Every collision query runs against the world's dynamic tree, and the query buffers are kept between moves,
+// so moving a character doesn't allocate.
+class Box2DCharacterBody : public Box2DPhysicsBody {
+	GDCLASS(Box2DCharacterBody, Box2DPhysicsBody);
+
+	struct SlideCollision {
+		Vector2 position;
+		Vector2 normal;
+		Vector2 collider_velocity;
+		ObjectID collider;
+		ObjectID collider_fixture;
+	};
+
+	Vector2 up_direction = Vector2(0, -1);
+	real_t floor_max_angle = Math::deg2rad((real_t)45.0);
+	int max_slides = 4;
+	bool stop_on_slope = false;
+	// While on the floor, the body is pulled down this far to stay on slopes and steps. 0 disables snapping.
+	real_t floor_snap_length = 0.0f;
+	// Rigid bodies don't block the move. Box2D pushes them out of the way on the next step instead.
+	bool infinite_inertia = true;
+
+	bool on_floor = false;
+	bool on_wall = false;
+	bool on_ceiling = false;
+	Vector2 floor_normal;
+	Vector2 floor_velocity;
+	ObjectID floor_body;
+	// Where the floor was last touched, local to the floor body. Its velocity there is inherited by the next move.
+	b2Vec2 floor_local_point = b2Vec2_zero;
+	LocalVector<SlideCollision> slide_collisions;
+
+	// Reused by every move
+	LocalVector<Box2DWorld::QueryChild> cast_children;
+	Box2DWorld::QueryCallback cast_candidates;
+
+	void build_cast_children();
+	b2Vec2 get_floor_point_velocity() const;
+	// Records the hit and updates the floor, wall and ceiling state. Returns true if the hit was a floor.
+	bool add_slide_collision(const Box2DWorld::ShapeCastHit &p_hit);
+	bool is_floor_normal(const Vector2 &p_normal) const;
+
+protected:
+	static void _bind_methods();
+
+public:
+	virtual String get_configuration_warning() const override;
+
+	// Moves along p_linear_velocity for this frame's delta, sliding along whatever it hits. Returns the remaining velocity.
+	Vector2 move_and_slide(const Vector2 &p_linear_velocity);
+
+	void set_up_direction(const Vector2 &p_direction);
+	Vector2 get_up_direction() const;
+
+	void set_floor_max_angle(real_t p_radians);
+	real_t get_floor_max_angle() const;
+
+	void set_max_slides(int p_max_slides);
+	int get_max_slides() const;
+
+	void set_stop_on_slope(bool p_stop);
+	bool is_stop_on_slope_enabled() const;
+
+	void set_floor_snap_length(real_t p_length);
+	real_t get_floor_snap_length() const;
+
+	void set_infinite_inertia(bool p_enabled);
+	bool is_infinite_inertia_enabled() const;
+
+	// State after the last move
+	bool is_on_floor() const;
+	bool is_on_wall() const;
+	bool is_on_ceiling() const;
+	Vector2 get_floor_normal() const;
+	Vector2 get_floor_velocity() const;
+	Object *get_floor_body() const;
+
+	int get_slide_count() const;
+	Vector2 get_slide_position(int p_idx) const;
+	Vector2 get_slide_normal(int p_idx) const;
+	Vector2 get_slide_collider_velocity(int p_idx) const;
+	Object *get_slide_collider(int p_idx) const;
+	Object *get_slide_collider_fixture(int p_idx) const;
+
+	Box2DCharacterBody();
+};
+
+#endif // BOX2D_CHARACTER_BODY_H
@@ -8,6 +8,13 @@
 
 void Box2DFixture::on_b2Fixture_destroyed(b2Fixture *fixture) {
 	fixtures.erase(fixture);
+	if (fixtures.size() == 0) {
+		if (sensor_world) {
+			sensor_world->unregister_sensor(this);
+		}
+		// Only called from b2World::DestroyBody, so the body is still in its world
+		body_node->world_node->register_exceptions(this, false);
+	}
 }
 
 void Box2DFixture::on_parent_created(Node *) {
@@ -69,6 +76,11 @@ void Box2DFixture::create_b2Fixture(b2Fixture *&p_fixture_out, const b2FixtureDe
 	}
 
 	p_fixture_out->GetUserData().owner = this;
+	p_fixture_out->GetUserData().collision_tag = override_body_filterdata ? collision_tag : body_node->collision_tag;
+	apply_one_way(p_fixture_out);
+	apply_surface_material(p_fixture_out);
+	p_fixture_out->GetUserData().overlap_sensor = is_overlap_sensor();
+	p_fixture_out->GetUserData().exception_flags = Box2DWorld::get_exception_flags(this);
 	body_node->update_mass();
 }
 
@@ -77,6 +89,7 @@ bool Box2DFixture::create_b2() {
 		ERR_FAIL_COND_V(!body_node, false);
 		ERR_FAIL_COND_V(!body_node->body, false);
 		ERR_FAIL_COND_V(!shape.is_valid(), false);
+		body_node->wait_for_world_step();
 
 		if (shape->is_composite_shape()) {
 			Vector<const b2Shape *> shape_vector = shape.ptr()->get_shapes();
@@ -99,6 +112,13 @@ bool Box2DFixture::create_b2() {
 			}
 		}
 
+		if (is_overlap_sensor() && fixtures.size() > 0) {
+			body_node->world_node->register_sensor(this);
+		}
+		if (fixtures.size() > 0) {
+			body_node->world_node->register_exceptions(this, true);
+		}
+
 		//print_line("fixture created");
 		return true;
 	}
@@ -109,6 +129,11 @@ bool Box2DFixture::destroy_b2() {
 	if (fixtures.size() > 0) {
 		ERR_FAIL_COND_V(!body_node, false);
 		if (body_node->body) {
+			body_node->wait_for_world_step();
+			if (sensor_world) {
+				sensor_world->unregister_sensor(this);
+			}
+			body_node->world_node->register_exceptions(this, false);
 			for (int i = 0; i < fixtures.size(); i++) {
 				body_node->body->DestroyFixture(fixtures[i]);
 			}
@@ -127,12 +152,36 @@ void Box2DFixture::_shape_changed() {
 void Box2DFixture::_notification(int p_what) {
 	switch (p_what) {
 		case NOTIFICATION_PREDELETE: {
+			// Filter lists are read by the running step
+			wait_for_world_step();
+
 			// Remove self from filterers
 			for (int i = 0; i < filtering_me.size(); i++) {
 				filtering_me[i]->filtered.erase(this);
 			}
+			for (int i = 0; i < filtered.size(); i++) {
+				filtered[i]->filtering_me.erase(this);
+			}
+
+			if (body_node && body_node->world_node) {
+				body_node->world_node->remove_sensor_overlaps(this);
+			}
 
+			// Uses the lists above to remove this fixture's exception pairs
 			destroy_b2();
+
+			for (int i = 0; i < filtering_me.size(); i++) {
+				filtering_me[i]->wait_for_world_step();
+				if (filtering_me[i]->body_node && filtering_me[i]->body_node->world_node) {
+					filtering_me[i]->body_node->world_node->update_exception_flags(filtering_me[i]);
+				}
+			}
+			for (int i = 0; i < filtered.size(); i++) {
+				filtered[i]->wait_for_world_step();
+				if (filtered[i]->body_node && filtered[i]->body_node->world_node) {
+					filtered[i]->body_node->world_node->update_exception_flags(filtered[i]);
+				}
+			}
 		} break;
 
 		case NOTIFICATION_ENTER_TREE: {
@@ -213,6 +262,9 @@ void Box2DFixture::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_shape"), &Box2DFixture::get_shape);
 	ClassDB::bind_method(D_METHOD("set_sensor", "sensor"), &Box2DFixture::set_sensor);
 	ClassDB::bind_method(D_METHOD("is_sensor"), &Box2DFixture::is_sensor);
+	ClassDB::bind_method(D_METHOD("set_sensor_overlaps", "enabled"), &Box2DFixture::set_sensor_overlaps);
+	ClassDB::bind_method(D_METHOD("is_sensor_overlaps_enabled"), &Box2DFixture::is_sensor_overlaps_enabled);
+	ClassDB::bind_method(D_METHOD("get_overlapping_fixtures"), &Box2DFixture::get_overlapping_fixtures);
 	ClassDB::bind_method(D_METHOD("set_override_body_collision", "override_body_collision"), &Box2DFixture::set_override_body_collision);
 	ClassDB::bind_method(D_METHOD("get_override_body_collision"), &Box2DFixture::get_override_body_collision);
 	ClassDB::bind_method(D_METHOD("set_collision_layer", "collision_layer"), &Box2DFixture::set_collision_layer);
@@ -221,6 +273,14 @@ void Box2DFixture::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_collision_mask"), &Box2DFixture::get_collision_mask);
 	ClassDB::bind_method(D_METHOD("set_group_index", "group_index"), &Box2DFixture::set_group_index);
 	ClassDB::bind_method(D_METHOD("get_group_index"), &Box2DFixture::get_group_index);
+	ClassDB::bind_method(D_METHOD("set_collision_tag", "collision_tag"), &Box2DFixture::set_collision_tag);
+	ClassDB::bind_method(D_METHOD("get_collision_tag"), &Box2DFixture::get_collision_tag);
+	ClassDB::bind_method(D_METHOD("set_one_way_collision", "enabled"), &Box2DFixture::set_one_way_collision);
+	ClassDB::bind_method(D_METHOD("is_one_way_collision_enabled"), &Box2DFixture::is_one_way_collision_enabled);
+	ClassDB::bind_method(D_METHOD("set_one_way_direction", "direction"), &Box2DFixture::set_one_way_direction);
+	ClassDB::bind_method(D_METHOD("get_one_way_direction"), &Box2DFixture::get_one_way_direction);
+	ClassDB::bind_method(D_METHOD("set_one_way_margin", "margin"), &Box2DFixture::set_one_way_margin);
+	ClassDB::bind_method(D_METHOD("get_one_way_margin"), &Box2DFixture::get_one_way_margin);
 	ClassDB::bind_method(D_METHOD("set_use_parent_exceptions", "use_parent_exceptions"), &Box2DFixture::set_use_parent_exceptions);
 	ClassDB::bind_method(D_METHOD("get_use_parent_exceptions"), &Box2DFixture::get_use_parent_exceptions);
 	ClassDB::bind_method(D_METHOD("set_density", "density"), &Box2DFixture::set_density);
@@ -229,6 +289,12 @@ void Box2DFixture::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_friction"), &Box2DFixture::get_friction);
 	ClassDB::bind_method(D_METHOD("set_restitution", "restitution"), &Box2DFixture::set_restitution);
 	ClassDB::bind_method(D_METHOD("get_restitution"), &Box2DFixture::get_restitution);
+	ClassDB::bind_method(D_METHOD("set_surface_speed", "surface_speed"), &Box2DFixture::set_surface_speed);
+	ClassDB::bind_method(D_METHOD("get_surface_speed"), &Box2DFixture::get_surface_speed);
+	ClassDB::bind_method(D_METHOD("set_friction_mix", "mode"), &Box2DFixture::set_friction_mix);
+	ClassDB::bind_method(D_METHOD("get_friction_mix"), &Box2DFixture::get_friction_mix);
+	ClassDB::bind_method(D_METHOD("set_restitution_mix", "mode"), &Box2DFixture::set_restitution_mix);
+	ClassDB::bind_method(D_METHOD("get_restitution_mix"), &Box2DFixture::get_restitution_mix);
 
 	ClassDB::bind_method(D_METHOD("set_filter_data", "collision_layer", "collision_mask", "group_index"), &Box2DFixture::set_filter_data);
 
@@ -240,17 +306,33 @@ void Box2DFixture::_bind_methods() {
 
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "shape", PROPERTY_HINT_RESOURCE_TYPE, "Box2DShape"), "set_shape", "get_shape");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "sensor"), "set_sensor", "is_sensor");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "sensor_overlaps"), "set_sensor_overlaps", "is_sensor_overlaps_enabled");
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "density"), "set_density", "get_density");
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "friction"), "set_friction", "get_friction");
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "restitution"), "set_restitution", "get_restitution");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "surface_speed"), "set_surface_speed", "get_surface_speed");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "friction_mix", PROPERTY_HINT_ENUM, "Default,Average,Min,Multiply,Max"), "set_friction_mix", "get_friction_mix");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "restitution_mix", PROPERTY_HINT_ENUM, "Default,Average,Min,Multiply,Max"), "set_restitution_mix", "get_restitution_mix");
 	ADD_GROUP("Collision", "");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "override_body_collision"), "set_override_body_collision", "get_override_body_collision");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "collision_layer", PROPERTY_HINT_LAYERS_2D_PHYSICS), "set_collision_layer", "get_collision_layer");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "collision_mask", PROPERTY_HINT_LAYERS_2D_PHYSICS), "set_collision_mask", "get_collision_mask");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "group_index"), "set_group_index", "get_group_index");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "collision_tag", PROPERTY_HINT_RANGE, "0,31,1"), "set_collision_tag", "get_collision_tag");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "use_parent_exceptions"), "set_use_parent_exceptions", "get_use_parent_exceptions");
+	ADD_GROUP("One Way", "one_way_");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "one_way_collision"), "set_one_way_collision", "is_one_way_collision_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::VECTOR2, "one_way_direction"), "set_one_way_direction", "get_one_way_direction");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "one_way_margin", PROPERTY_HINT_RANGE, "0,64,0.1,or_greater"), "set_one_way_margin", "get_one_way_margin");
 
 	ADD_SIGNAL(MethodInfo("_shape_type_changed"));
+	ADD_SIGNAL(MethodInfo("overlaps_changed", PropertyInfo(Variant::ARRAY, "entered"), PropertyInfo(Variant::ARRAY, "exited")));
+
+	BIND_ENUM_CONSTANT(MIX_DEFAULT);
+	BIND_ENUM_CONSTANT(MIX_AVERAGE);
+	BIND_ENUM_CONSTANT(MIX_MIN);
+	BIND_ENUM_CONSTANT(MIX_MULTIPLY);
+	BIND_ENUM_CONSTANT(MIX_MAX);
 }
 
 void Box2DFixture::update_shape() {
@@ -268,8 +350,63 @@ void Box2DFixture::update_shape() {
 }
 
 void Box2DFixture::update_filterdata() {
+	wait_for_world_step();
+	const bool use_own = override_body_filterdata || !body_node;
+	const b2Filter &filter = use_own ? filterDef : body_node->filterDef;
+	const uint8_t tag = use_own ? collision_tag : body_node->collision_tag;
+	for (int i = 0; i < fixtures.size(); i++) {
+		fixtures[i]->GetUserData().collision_tag = tag;
+		fixtures[i]->SetFilterData(filter); // Refilters, which also picks up the tag
+	}
+}
+
+void Box2DFixture::apply_one_way(b2Fixture *p_fixture) const {
+	// The shapes are baked into body space, so the direction is too
+	const Vector2 normal = get_transform().basis_xform(one_way_direction).normalized();
+	b2FixtureUserData &data = p_fixture->GetUserData();
+	data.one_way = one_way_collision && normal != Vector2();
+	data.one_way_normal_x = normal.x;
+	data.one_way_normal_y = normal.y;
+	data.one_way_margin = one_way_margin * GD_TO_B2;
+}
+
+void Box2DFixture::update_one_way() {
+	wait_for_world_step();
+	for (int i = 0; i < fixtures.size(); i++) {
+		apply_one_way(fixtures[i]);
+	}
+}
+
+void Box2DFixture::apply_surface_material(b2Fixture *p_fixture) const {
+	b2FixtureUserData &data = p_fixture->GetUserData();
+	data.surface_material = surface_speed != 0.0f || friction_mix != MIX_DEFAULT || restitution_mix != MIX_DEFAULT;
+	data.surface_speed = surface_speed;
+	data.friction_mix = friction_mix;
+	data.restitution_mix = restitution_mix;
+}
+
+void Box2DFixture::update_surface_material() {
+	wait_for_world_step();
 	for (int i = 0; i < fixtures.size(); i++) {
-		fixtures[i]->SetFilterData(filterDef);
+		b2Fixture *fixture = fixtures[i];
+		apply_surface_material(fixture);
+
+		// Existing contacts keep whatever was last set on them. Put them back to Box2D's defaults,
+		// and PreSolve reapplies the material if there still is one.
+		for (b2ContactEdge *ce = fixture->GetBody()->GetContactList(); ce; ce = ce->next) {
+			b2Contact *contact = ce->contact;
+			if (contact->GetFixtureA() == fixture || contact->GetFixtureB() == fixture) {
+				contact->ResetFriction();
+				contact->ResetRestitution();
+				contact->SetTangentSpeed(0.0f);
+			}
+		}
+	}
+}
+
+void Box2DFixture::wait_for_world_step() {
+	if (body_node) {
+		body_node->wait_for_world_step();
 	}
 }
 
@@ -323,16 +460,63 @@ Ref<Box2DShape> Box2DFixture::get_shape() {
 }
 
 void Box2DFixture::set_sensor(bool p_sensor) {
+	wait_for_world_step();
 	for (int i = 0; i < fixtures.size(); i++) {
 		fixtures[i]->SetSensor(p_sensor);
 	}
 	fixtureDef.isSensor = p_sensor;
+	if (body_node && fixtures.size() > 0) {
+		body_node->track_awake(); // b2Fixture::SetSensor wakes the body
+	}
+	if (sensor_overlaps) {
+		update_overlap_sensor();
+	}
 }
 
 bool Box2DFixture::is_sensor() const {
 	return fixtureDef.isSensor;
 }
 
+void Box2DFixture::update_overlap_sensor() {
+	wait_for_world_step();
+	const bool overlap_sensor = is_overlap_sensor();
+	for (int i = 0; i < fixtures.size(); i++) {
+		fixtures[i]->GetUserData().overlap_sensor = overlap_sensor;
+		fixtures[i]->Refilter(); // Drops or restores the fixture's contacts
+	}
+
+	if (overlap_sensor && fixtures.size() > 0) {
+		body_node->world_node->register_sensor(this);
+	} else if (sensor_world) {
+		sensor_world->unregister_sensor(this);
+	}
+}
+
+void Box2DFixture::set_sensor_overlaps(bool p_enabled) {
+	if (sensor_overlaps != p_enabled) {
+		sensor_overlaps = p_enabled;
+		update_overlap_sensor();
+	}
+}
+
+bool Box2DFixture::is_sensor_overlaps_enabled() const {
+	return sensor_overlaps;
+}
+
+Array Box2DFixture::get_overlapping_fixtures() const {
+	Array ret;
+	ERR_FAIL_COND_V_MSG(!sensor_world, ret, "Overlaps are only tracked for sensors with sensor_overlaps enabled.");
+
+	const LocalVector<uint64_t> &overlaps = sensor_world->sensors[sensor_index].reported_overlaps;
+	for (uint32_t i = 0; i < overlaps.size(); ++i) {
+		Object *fixture = ObjectDB::get_instance(ObjectID(overlaps[i]));
+		if (fixture) {
+			ret.append(fixture);
+		}
+	}
+	return ret;
+}
+
 void Box2DFixture::set_override_body_collision(bool p_override) {
 	if (override_body_filterdata != p_override) {
 		override_body_filterdata = p_override;
@@ -377,6 +561,18 @@ int16_t Box2DFixture::get_group_index() const {
 	return filterDef.groupIndex;
 }
 
+void Box2DFixture::set_collision_tag(int p_tag) {
+	ERR_FAIL_INDEX(p_tag, Box2DCollisionRules::MAX_TAGS);
+	if (collision_tag != p_tag) {
+		collision_tag = p_tag;
+		update_filterdata();
+	}
+}
+
+int Box2DFixture::get_collision_tag() const {
+	return collision_tag;
+}
+
 void Box2DFixture::set_filter_data(uint16_t p_layer, uint16_t p_mask, int16 p_group_index) {
 	if (filterDef.categoryBits != p_layer || filterDef.maskBits != p_mask || filterDef.groupIndex != p_group_index) {
 		filterDef.categoryBits = p_layer;
@@ -386,7 +582,37 @@ void Box2DFixture::set_filter_data(uint16_t p_layer, uint16_t p_mask, int16 p_gr
 	}
 }
 
+void Box2DFixture::set_one_way_collision(bool p_one_way) {
+	if (one_way_collision != p_one_way) {
+		one_way_collision = p_one_way;
+		update_one_way();
+	}
+}
+
+bool Box2DFixture::is_one_way_collision_enabled() const {
+	return one_way_collision;
+}
+
+void Box2DFixture::set_one_way_direction(const Vector2 &p_direction) {
+	one_way_direction = p_direction;
+	update_one_way();
+}
+
+Vector2 Box2DFixture::get_one_way_direction() const {
+	return one_way_direction;
+}
+
+void Box2DFixture::set_one_way_margin(real_t p_margin) {
+	one_way_margin = MAX(p_margin, 0.0f);
+	update_one_way();
+}
+
+real_t Box2DFixture::get_one_way_margin() const {
+	return one_way_margin;
+}
+
 void Box2DFixture::set_use_parent_exceptions(bool p_use) {
+	wait_for_world_step();
 	accept_body_collision_exceptions = p_use;
 }
 
@@ -406,22 +632,56 @@ void Box2DFixture::add_collision_exception_with(Node *p_node) {
 	ERR_FAIL_NULL(p_node);
 	Box2DFixture *fixture = Object::cast_to<Box2DFixture>(p_node);
 	ERR_FAIL_COND_MSG(!fixture, "Fixture collision exceptions only work with other fixtures. Submit an issue if you need this.");
+	wait_for_world_step();
+	fixture->wait_for_world_step();
 	filtered.insert(fixture);
 	fixture->filtering_me.insert(this);
+	update_exception(fixture, true);
 }
 
 void Box2DFixture::remove_collision_exception_with(Node *p_node) {
 	ERR_FAIL_NULL(p_node);
 	Box2DFixture *fixture = Object::cast_to<Box2DFixture>(p_node);
 	ERR_FAIL_COND_MSG(!fixture, "Fixture collision exceptions only work with other fixtures. Submit an issue if you need this.");
+	wait_for_world_step();
+	fixture->wait_for_world_step();
 	filtered.erase(fixture);
 	fixture->filtering_me.erase(this);
+	update_exception(fixture, false);
+}
+
+void Box2DFixture::update_exception(Box2DFixture *p_other, bool p_added) {
+	Box2DWorld *world_node = body_node ? body_node->world_node : NULL;
+	Box2DWorld *other_world_node = p_other->body_node ? p_other->body_node->world_node : NULL;
+
+	const uint64_t id = get_instance_id();
+	const uint64_t other_id = p_other->get_instance_id();
+	Box2DWorld *worlds[2] = { world_node, other_world_node != world_node ? other_world_node : NULL };
+	for (int i = 0; i < 2; ++i) {
+		if (!worlds[i]) {
+			continue;
+		}
+		if (p_added) {
+			worlds[i]->exception_pairs.add(id, other_id);
+		} else {
+			worlds[i]->exception_pairs.remove(id, other_id);
+		}
+	}
+
+	if (world_node) {
+		world_node->update_exception_flags(this);
+	}
+	if (other_world_node) {
+		other_world_node->update_exception_flags(p_other);
+	}
 }
 
 void Box2DFixture::set_density(real_t p_density) {
 	const float factor = GD_TO_B2;
 	float density = p_density * (1.0e-3f / (factor * factor)); // g/pixel^2 to kg/m^2
 
+	wait_for_world_step();
+
 	for (int i = 0; i < fixtures.size(); i++) {
 		fixtures[i]->SetDensity(density);
 		body_node->body->ResetMassData();
@@ -435,6 +695,7 @@ real_t Box2DFixture::get_density() const {
 }
 
 void Box2DFixture::set_friction(real_t p_friction) {
+	wait_for_world_step();
 	for (int i = 0; i < fixtures.size(); i++) {
 		fixtures[i]->SetFriction(p_friction);
 	}
@@ -446,6 +707,7 @@ real_t Box2DFixture::get_friction() const {
 }
 
 void Box2DFixture::set_restitution(real_t p_restitution) {
+	wait_for_world_step();
 	for (int i = 0; i < fixtures.size(); i++) {
 		fixtures[i]->SetRestitution(p_restitution);
 	}
@@ -456,6 +718,41 @@ real_t Box2DFixture::get_restitution() const {
 	return fixtureDef.restitution;
 }
 
+void Box2DFixture::set_surface_speed(real_t p_speed) {
+	if (surface_speed != p_speed) {
+		surface_speed = p_speed;
+		update_surface_material();
+	}
+}
+
+real_t Box2DFixture::get_surface_speed() const {
+	return surface_speed;
+}
+
+void Box2DFixture::set_friction_mix(MixMode p_mode) {
+	ERR_FAIL_INDEX(p_mode, MIX_MAX + 1);
+	if (friction_mix != p_mode) {
+		friction_mix = p_mode;
+		update_surface_material();
+	}
+}
+
+Box2DFixture::MixMode Box2DFixture::get_friction_mix() const {
+	return friction_mix;
+}
+
+void Box2DFixture::set_restitution_mix(MixMode p_mode) {
+	ERR_FAIL_INDEX(p_mode, MIX_MAX + 1);
+	if (restitution_mix != p_mode) {
+		restitution_mix = p_mode;
+		update_surface_material();
+	}
+}
+
+Box2DFixture::MixMode Box2DFixture::get_restitution_mix() const {
+	return restitution_mix;
+}
+
 Box2DFixture::Box2DFixture() {
 	const float factor = GD_TO_B2;
 	fixtureDef.density = 0.4f * (1.0e-3f / (factor * factor)); // 0.4 g/px^2 default
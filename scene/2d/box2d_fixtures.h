@@ -26,11 +26,37 @@ class Box2DFixture : public Node2D {
 
 	friend class Box2DWorld;
 
+public:
+	// How this fixture's friction/restitution combines with another's. With two different modes, the later one in this list wins.
+	enum MixMode {
+		MIX_DEFAULT, // Box2D's mixing: geometric mean for friction, max for restitution
+		MIX_AVERAGE,
+		MIX_MIN,
+		MIX_MULTIPLY,
+		MIX_MAX,
+	};
+
+private:
 	Ref<Box2DShape> shape;
 	b2FixtureDef fixtureDef;
 	b2Filter filterDef;
 	bool override_body_filterdata = false;
+	uint8_t collision_tag = 0;
 	bool accept_body_collision_exceptions = true;
+
+	bool one_way_collision = false;
+	Vector2 one_way_direction = Vector2(0, -1);
+	real_t one_way_margin = 1.0f;
+
+	// Sensors only. Overlaps are tracked by the world's sensor pass instead of with contacts.
+	bool sensor_overlaps = false;
+	// Index into the world's sensor list, or -1 if this fixture isn't registered as an overlap sensor
+	int sensor_index = -1;
+	Box2DWorld *sensor_world = NULL;
+
+	real_t surface_speed = 0.0f;
+	MixMode friction_mix = MIX_DEFAULT;
+	MixMode restitution_mix = MIX_DEFAULT;
 	// TODO maybe implement a HashSet or use std
 	// Not sure why Godot uses a VSet for this
 	VSet<Box2DFixture *> filtered;
@@ -51,6 +77,18 @@ class Box2DFixture : public Node2D {
 
 	void update_shape();
 	void update_filterdata();
+	void apply_one_way(b2Fixture *p_fixture) const;
+	void update_one_way();
+	void apply_surface_material(b2Fixture *p_fixture) const;
+	void update_surface_material();
+
+	_FORCE_INLINE_ bool is_overlap_sensor() const { return sensor_overlaps && fixtureDef.isSensor; }
+	void update_overlap_sensor();
+
+	// Call before touching Box2D state that a running async step may be using
+	void wait_for_world_step();
+	// Mirrors a changed exception into this fixture's world (and the other fixture's, if different)
+	void update_exception(Box2DFixture *p_other, bool p_added);
 
 	void _shape_changed();
 
@@ -75,6 +113,12 @@ public:
 	void set_sensor(bool p_sensor);
 	bool is_sensor() const;
 
+	void set_sensor_overlaps(bool p_enabled);
+	bool is_sensor_overlaps_enabled() const;
+
+	// Fixtures overlapping this sensor as of the last step. Only tracked with sensor_overlaps.
+	Array get_overlapping_fixtures() const;
+
 	void set_override_body_collision(bool p_override);
 	bool get_override_body_collision() const;
 
@@ -89,6 +133,18 @@ public:
 
 	void set_filter_data(uint16_t p_layer, uint16_t p_mask, int16 p_group_index);
 
+	void set_collision_tag(int p_tag);
+	int get_collision_tag() const;
+
+	void set_one_way_collision(bool p_one_way);
+	bool is_one_way_collision_enabled() const;
+
+	void set_one_way_direction(const Vector2 &p_direction);
+	Vector2 get_one_way_direction() const;
+
+	void set_one_way_margin(real_t p_margin);
+	real_t get_one_way_margin() const;
+
 	void set_use_parent_exceptions(bool p_use);
 	bool get_use_parent_exceptions() const;
 
@@ -109,8 +165,21 @@ public:
 
 	// restitution threshold?
 
+	// Tangent speed of the surface in pixels/s, like a conveyor belt.
+	// Positive speeds carry touching bodies clockwise around the fixture (to the right along the top of a floor).
+	void set_surface_speed(real_t p_speed);
+	real_t get_surface_speed() const;
+
+	void set_friction_mix(MixMode p_mode);
+	MixMode get_friction_mix() const;
+
+	void set_restitution_mix(MixMode p_mode);
+	MixMode get_restitution_mix() const;
+
 	Box2DFixture();
 	~Box2DFixture();
 };
 
+VARIANT_ENUM_CAST(Box2DFixture::MixMode);
+
 #endif // BOX2D_FIXTURES_H
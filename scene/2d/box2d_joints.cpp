@@ -32,6 +32,7 @@ void Box2DJoint::on_b2Joint_destroyed() {
 bool Box2DJoint::create_b2Joint() {
 	if (world_node && !joint) {
 		ERR_FAIL_COND_V(!world_node->world, false);
+		wait_for_world_step();
 		ERR_FAIL_COND_V_MSG(!jointDef->bodyA, false, "Tried to create joint with invalid bodyA.");
 		ERR_FAIL_COND_V_MSG(!jointDef->bodyB, false, "Tried to create joint with invalid bodyB.");
 
@@ -45,6 +46,8 @@ bool Box2DJoint::create_b2Joint() {
 		// Those params would pass to this function with new param `p_wake_bodies`
 		joint->GetBodyA()->SetAwake(true);
 		joint->GetBodyB()->SetAwake(true);
+		world_node->track_awake_body(joint->GetBodyA()->GetUserData().owner);
+		world_node->track_awake_body(joint->GetBodyB()->GetUserData().owner);
 
 		//print_line("joint created");
 		return true;
@@ -56,10 +59,18 @@ bool Box2DJoint::destroy_b2Joint() {
 	if (joint) {
 		ERR_FAIL_COND_V(!world_node, false);
 		ERR_FAIL_COND_V(!world_node->world, false);
+		wait_for_world_step();
+
+		// b2World::DestroyJoint wakes both bodies
+		Box2DPhysicsBody *body_a = joint->GetBodyA()->GetUserData().owner;
+		Box2DPhysicsBody *body_b = joint->GetBodyB()->GetUserData().owner;
 
 		world_node->world->DestroyJoint(joint);
 		joint = NULL;
 
+		world_node->track_awake_body(body_a);
+		world_node->track_awake_body(body_b);
+
 		//print_line("joint destroyed");
 		return true;
 	}
@@ -175,6 +186,8 @@ void Box2DJoint::_node_b_tree_entered() {
 }
 
 void Box2DJoint::recreate_joint() {
+	// init_b2JointDef reads body positions
+	wait_for_world_step();
 	destroy_b2Joint();
 
 	if (is_valid()) {
@@ -192,10 +205,38 @@ b2Vec2 Box2DJoint::get_b2_pos() const {
 	return gd_to_b2(get_global_position() - world_node->get_global_position());
 }
 
+b2Joint *Box2DJoint::get_b2Joint() const {
+	wait_for_world_step();
+	return joint;
+}
+
+void Box2DJoint::track_awake_bodies() {
+	if (joint) {
+		world_node->track_awake_body(joint->GetBodyA()->GetUserData().owner);
+		world_node->track_awake_body(joint->GetBodyB()->GetUserData().owner);
+	}
+}
+
+void Box2DJoint::wait_for_world_step() const {
+	if (world_node) {
+		world_node->wait_for_step();
+	}
+}
+
+real_t Box2DJoint::get_inv_step_delta() const {
+	if (world_node && world_node->last_step_delta > 0.0f) {
+		return 1.0f / world_node->last_step_delta;
+	}
+	return 1.0f / get_physics_process_delta_time();
+}
+
 void Box2DJoint::_notification(int p_what) {
 	switch (p_what) {
 		case NOTIFICATION_PREDELETE: {
 			destroy_b2Joint();
+			if (world_node) {
+				world_node->joints.erase(this);
+			}
 		} break;
 
 		case NOTIFICATION_ENTER_TREE: {
@@ -216,6 +257,9 @@ void Box2DJoint::_notification(int p_what) {
 				destroy_b2Joint();
 
 				world_node = new_world;
+				if (world_node) {
+					world_node->joints.insert(this);
+				}
 			}
 
 			if (Engine::get_singleton()->is_editor_hint() || get_tree()->is_debugging_collisions_hint()) {
@@ -262,21 +306,6 @@ void Box2DJoint::_notification(int p_what) {
 			}
 		} break;
 
-		case NOTIFICATION_INTERNAL_PHYSICS_PROCESS: {
-			if (breaking_enabled && joint) {
-				Vector2 force = get_reaction_force();
-				real_t torque = abs(get_reaction_torque());
-
-				const bool exceeded_force = max_force > 0 && force.length() > max_force;
-				const bool exceeded_torque = max_torque > 0 && torque > max_torque;
-
-				if (exceeded_force || exceeded_torque) {
-					emit_signal("joint_broken", force, torque);
-					set_broken(true);
-				}
-			}
-		} break;
-
 		case NOTIFICATION_INTERNAL_PROCESS: {
 			// Leaving on for now, but ideally we only want to update() when the actual display of something will change
 			if (Engine::get_singleton()->is_editor_hint() || get_tree()->is_debugging_collisions_hint()) {
@@ -457,8 +486,8 @@ bool Box2DJoint::is_broken() const {
 }
 
 void Box2DJoint::set_breaking_enabled(bool p_enabled) {
+	// Breaking is checked by the world after each step
 	breaking_enabled = p_enabled;
-	set_physics_process_internal(breaking_enabled);
 }
 
 bool Box2DJoint::is_breaking_enabled() const {
@@ -493,14 +522,16 @@ Vector2 Box2DJoint::get_reaction_force() const {
 	if (broken)
 		return Vector2(); // Don't print a fail message for intended behavior
 	ERR_FAIL_COND_V_MSG(!joint, Vector2(), "b2Joint is null.");
-	return b2_to_gd(joint->GetReactionForce(1.0f / get_physics_process_delta_time()));
+	wait_for_world_step();
+	return b2_to_gd(joint->GetReactionForce(get_inv_step_delta()));
 }
 
 real_t Box2DJoint::get_reaction_torque() const {
 	if (broken)
 		return real_t(); // Don't print a fail message for intended behavior
 	ERR_FAIL_COND_V_MSG(!joint, real_t(), "b2Joint is null.");
-	return joint->GetReactionTorque(1.0f / get_physics_process_delta_time()) * B2_TO_GD;
+	wait_for_world_step();
+	return joint->GetReactionTorque(get_inv_step_delta()) * B2_TO_GD;
 }
 
 bool Box2DJoint::is_enabled() const {
@@ -699,8 +730,10 @@ void Box2DRevoluteJoint::reset_joint_anchors() {
 }
 
 void Box2DRevoluteJoint::set_limit_enabled(bool p_enabled) {
-	if (get_b2Joint())
+	if (get_b2Joint()) {
 		static_cast<b2RevoluteJoint *>(get_b2Joint())->EnableLimit(p_enabled);
+		track_awake_bodies();
+	}
 	jointDef.enableLimit = p_enabled;
 }
 
@@ -709,8 +742,10 @@ bool Box2DRevoluteJoint::is_limit_enabled() const {
 }
 
 void Box2DRevoluteJoint::set_upper_limit(real_t p_angle) {
-	if (get_b2Joint())
+	if (get_b2Joint()) {
 		static_cast<b2RevoluteJoint *>(get_b2Joint())->SetLimits(get_lower_limit(), p_angle);
+		track_awake_bodies();
+	}
 	jointDef.upperAngle = p_angle;
 }
 
@@ -719,8 +754,10 @@ real_t Box2DRevoluteJoint::get_upper_limit() const {
 }
 
 void Box2DRevoluteJoint::set_lower_limit(real_t p_angle) {
-	if (get_b2Joint())
+	if (get_b2Joint()) {
 		static_cast<b2RevoluteJoint *>(get_b2Joint())->SetLimits(p_angle, get_upper_limit());
+		track_awake_bodies();
+	}
 	jointDef.lowerAngle = p_angle;
 }
 
@@ -729,15 +766,19 @@ real_t Box2DRevoluteJoint::get_lower_limit() const {
 }
 
 void Box2DRevoluteJoint::set_limits(real_t p_lower, real_t p_upper) {
-	if (get_b2Joint())
+	if (get_b2Joint()) {
 		static_cast<b2RevoluteJoint *>(get_b2Joint())->SetLimits(p_lower, p_upper);
+		track_awake_bodies();
+	}
 	jointDef.lowerAngle = p_lower;
 	jointDef.upperAngle = p_upper;
 }
 
 void Box2DRevoluteJoint::set_motor_enabled(bool p_enabled) {
-	if (get_b2Joint())
+	if (get_b2Joint()) {
 		static_cast<b2RevoluteJoint *>(get_b2Joint())->EnableMotor(p_enabled);
+		track_awake_bodies();
+	}
 	jointDef.enableMotor = p_enabled;
 }
 
@@ -746,8 +787,10 @@ bool Box2DRevoluteJoint::is_motor_enabled() const {
 }
 
 void Box2DRevoluteJoint::set_motor_speed(real_t p_speed) {
-	if (get_b2Joint())
+	if (get_b2Joint()) {
 		static_cast<b2RevoluteJoint *>(get_b2Joint())->SetMotorSpeed(p_speed);
+		track_awake_bodies();
+	}
 	jointDef.motorSpeed = p_speed;
 }
 
@@ -757,8 +800,10 @@ real_t Box2DRevoluteJoint::get_motor_speed() const {
 
 void Box2DRevoluteJoint::set_max_motor_torque(real_t p_torque) {
 	const float torque = p_torque * GD_TO_B2;
-	if (get_b2Joint())
+	if (get_b2Joint()) {
 		static_cast<b2RevoluteJoint *>(get_b2Joint())->SetMaxMotorTorque(torque);
+		track_awake_bodies();
+	}
 	jointDef.maxMotorTorque = torque;
 }
 
@@ -768,7 +813,7 @@ real_t Box2DRevoluteJoint::get_max_motor_torque() const {
 
 real_t Box2DRevoluteJoint::get_motor_torque() const {
 	ERR_FAIL_COND_V_MSG(!get_b2Joint(), real_t(), "b2Joint is null.");
-	return static_cast<b2RevoluteJoint *>(get_b2Joint())->GetMotorTorque(1.0f / get_physics_process_delta_time()) * B2_TO_GD;
+	return static_cast<b2RevoluteJoint *>(get_b2Joint())->GetMotorTorque(get_inv_step_delta()) * B2_TO_GD;
 }
 
 Box2DRevoluteJoint::Box2DRevoluteJoint() :
@@ -992,8 +1037,10 @@ Vector2 Box2DPrismaticJoint::get_local_axis() const {
 }
 
 void Box2DPrismaticJoint::set_limit_enabled(bool p_enabled) {
-	if (get_b2Joint())
+	if (get_b2Joint()) {
 		static_cast<b2PrismaticJoint *>(get_b2Joint())->EnableLimit(p_enabled);
+		track_awake_bodies();
+	}
 	jointDef.enableLimit = p_enabled;
 }
 
@@ -1003,8 +1050,10 @@ bool Box2DPrismaticJoint::is_limit_enabled() const {
 
 void Box2DPrismaticJoint::set_upper_limit(real_t p_distance) {
 	float distance = p_distance * GD_TO_B2;
-	if (get_b2Joint())
+	if (get_b2Joint()) {
 		static_cast<b2PrismaticJoint *>(get_b2Joint())->SetLimits(jointDef.lowerTranslation, distance);
+		track_awake_bodies();
+	}
 	jointDef.upperTranslation = distance;
 }
 
@@ -1014,8 +1063,10 @@ real_t Box2DPrismaticJoint::get_upper_limit() const {
 
 void Box2DPrismaticJoint::set_lower_limit(real_t p_distance) {
 	float distance = p_distance * GD_TO_B2;
-	if (get_b2Joint())
+	if (get_b2Joint()) {
 		static_cast<b2PrismaticJoint *>(get_b2Joint())->SetLimits(distance, jointDef.upperTranslation);
+		track_awake_bodies();
+	}
 	jointDef.lowerTranslation = distance;
 }
 
@@ -1027,15 +1078,19 @@ void Box2DPrismaticJoint::set_limits(real_t p_lower, real_t p_upper) {
 	const float factor = GD_TO_B2;
 	float lower = p_lower * factor;
 	float upper = p_upper * factor;
-	if (get_b2Joint())
+	if (get_b2Joint()) {
 		static_cast<b2PrismaticJoint *>(get_b2Joint())->SetLimits(lower, upper);
+		track_awake_bodies();
+	}
 	jointDef.lowerTranslation = lower;
 	jointDef.upperTranslation = upper;
 }
 
 void Box2DPrismaticJoint::set_motor_enabled(bool p_enabled) {
-	if (get_b2Joint())
+	if (get_b2Joint()) {
 		static_cast<b2PrismaticJoint *>(get_b2Joint())->EnableMotor(p_enabled);
+		track_awake_bodies();
+	}
 	jointDef.enableMotor = p_enabled;
 }
 
@@ -1045,8 +1100,10 @@ bool Box2DPrismaticJoint::is_motor_enabled() const {
 
 void Box2DPrismaticJoint::set_motor_speed(real_t p_speed) {
 	float speed = p_speed * GD_TO_B2;
-	if (get_b2Joint())
+	if (get_b2Joint()) {
 		static_cast<b2PrismaticJoint *>(get_b2Joint())->SetMotorSpeed(speed);
+		track_awake_bodies();
+	}
 	jointDef.motorSpeed = speed;
 }
 
@@ -1056,8 +1113,10 @@ real_t Box2DPrismaticJoint::get_motor_speed() const {
 
 void Box2DPrismaticJoint::set_max_motor_force(real_t p_force) {
 	float force = p_force * GD_TO_B2;
-	if (get_b2Joint())
+	if (get_b2Joint()) {
 		static_cast<b2PrismaticJoint *>(get_b2Joint())->SetMaxMotorForce(force);
+		track_awake_bodies();
+	}
 	jointDef.maxMotorForce = force;
 }
 
@@ -1067,7 +1126,7 @@ real_t Box2DPrismaticJoint::get_max_motor_force() const {
 
 real_t Box2DPrismaticJoint::get_motor_force() const {
 	ERR_FAIL_COND_V_MSG(!get_b2Joint(), real_t(), "b2Joint is null.");
-	return static_cast<b2PrismaticJoint *>(get_b2Joint())->GetMotorForce(1.0f / get_physics_process_delta_time()) * B2_TO_GD;
+	return static_cast<b2PrismaticJoint *>(get_b2Joint())->GetMotorForce(get_inv_step_delta()) * B2_TO_GD;
 }
 
 Box2DPrismaticJoint::Box2DPrismaticJoint() :
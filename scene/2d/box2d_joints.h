@@ -70,11 +70,19 @@ protected:
 	// Destroys and recreates the b2Joint, if valid. Useful for updating constant parameters, such as bodies.
 	void recreate_joint();
 
-	b2Joint *get_b2Joint() { return joint; }
-	b2Joint *get_b2Joint() const { return joint; }
+	// Waits for a running async step before handing out the b2Joint
+	b2Joint *get_b2Joint() const;
+
+	// Limit and motor setters wake both bodies inside Box2D, so they must be tracked
+	void track_awake_bodies();
+
+	void wait_for_world_step() const;
 
 	b2Vec2 get_b2_pos() const;
 
+	// Inverse of the world's last step delta, for converting Box2D impulses into forces
+	real_t get_inv_step_delta() const;
+
 	void _notification(int p_what);
 	static void _bind_methods();
 
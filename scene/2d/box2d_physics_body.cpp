@@ -2,11 +2,10 @@
 
 #include <core/config/engine.h>
 
+#include "../../util/box2d_string_names.h"
 #include "box2d_fixtures.h"
 #include "box2d_joints.h"
 
-#include <vector>
-
 /**
 * @author Brian Semrau
 */
@@ -21,6 +20,7 @@ void Box2DPhysicsBody::on_parent_created(Node *) {
 bool Box2DPhysicsBody::create_b2Body() {
 	if (world_node && !body) {
 		ERR_FAIL_COND_V(!world_node->world, false);
+		wait_for_world_step();
 
 		// Create body
 		bodyDef.position = gd_to_b2(get_box2dworld_transform().get_origin());
@@ -28,6 +28,11 @@ bool Box2DPhysicsBody::create_b2Body() {
 
 		body = world_node->world->CreateBody(&bodyDef);
 		body->GetUserData().owner = this;
+		world_node->register_exceptions(this, true);
+		last_synced_b2_xform = body->GetTransform();
+		published_linear_velocity = bodyDef.linearVelocity;
+		published_angular_velocity = bodyDef.angularVelocity;
+		track_awake();
 
 		//print_line("body created");
 
@@ -49,12 +54,18 @@ bool Box2DPhysicsBody::destroy_b2Body() {
 	if (body) {
 		ERR_FAIL_COND_V(!world_node, false);
 		ERR_FAIL_COND_V(!world_node->world, false);
+		wait_for_world_step();
+
+		world_node->register_exceptions(this, false);
 
 		// Destroy body
 		world_node->world->DestroyBody(body);
 		//print_line("body destroyed");
 		body = NULL;
 
+		// Untracked only now, since DestroyBody ends this body's contacts, and EndContact tracks it again
+		world_node->untrack_destroyed_body(this);
+
 		// b2Fixture destruction is handled by Box2D
 
 		// b2Joint destruction is handled by Box2D
@@ -66,6 +77,7 @@ bool Box2DPhysicsBody::destroy_b2Body() {
 
 void Box2DPhysicsBody::update_mass(bool p_calc_reset) {
 	if (body) {
+		wait_for_world_step();
 		if (use_custom_massdata) {
 			body->SetMassData(&massDataDef);
 		} else if (p_calc_reset) {
@@ -76,66 +88,76 @@ void Box2DPhysicsBody::update_mass(bool p_calc_reset) {
 
 void Box2DPhysicsBody::update_filterdata() {
 	if (body) {
+		wait_for_world_step();
 		b2Fixture *fixture = body->GetFixtureList();
 		while (fixture) {
 			if (!fixture->GetUserData().owner->get_override_body_collision()) {
-				fixture->SetFilterData(filterDef);
+				fixture->GetUserData().collision_tag = collision_tag;
+				fixture->SetFilterData(filterDef); // Refilters, which also picks up the tag
 			}
 			fixture = fixture->GetNext();
 		}
 	}
 }
 
-Transform2D Box2DPhysicsBody::get_box2dworld_transform() {
-	std::vector<Transform2D> transforms{};
-	transforms.push_back(get_transform());
-	Node* parent = get_parent();
-	while(parent) {
-		if(parent == world_node) {
-			break;
-		}
-		CanvasItem* cv = Object::cast_to<CanvasItem>(parent);
-		if(cv) {
-			transforms.push_back(cv->get_transform());
+void Box2DPhysicsBody::update_parent_xform_cache() {
+	Transform2D xform;
+	bool keyed = world_node != NULL;
+	Node *parent = get_parent();
+	while (parent && parent != world_node) {
+		CanvasItem *cv = Object::cast_to<CanvasItem>(parent);
+		if (cv) {
+			xform = cv->get_transform() * xform;
+		} else {
+			keyed = false;
 		}
 		parent = parent->get_parent();
 	}
 
-	Transform2D returned{};
-	while(transforms.size() > 0) {
-		returned = returned * transforms.back();
-		transforms.pop_back();
+	parent_to_world_xform = xform;
+	world_to_parent_xform = xform.affine_inverse();
+	parent_xform_keyed = keyed;
+	if (keyed) {
+		cached_parent_global_xform = static_cast<CanvasItem *>(get_parent())->get_global_transform();
+		cached_world_global_xform = world_node->get_global_transform();
 	}
+	parent_xform_dirty = false;
+}
 
-	return returned;
+void Box2DPhysicsBody::validate_parent_xform_cache() {
+	// Godot defers NOTIFICATION_TRANSFORM_CHANGED until the end of the frame, but global transforms are
+	// invalidated right away, so comparing them catches an ancestor that moved earlier in this frame
+	if (parent_xform_dirty || !parent_xform_keyed ||
+			static_cast<CanvasItem *>(get_parent())->get_global_transform() != cached_parent_global_xform ||
+			world_node->get_global_transform() != cached_world_global_xform) {
+		update_parent_xform_cache();
+	}
 }
 
-void Box2DPhysicsBody::set_box2dworld_transform(const Transform2D &p_transform) {
-	std::vector<Transform2D> transforms{};
-	transforms.push_back(p_transform);
-	Node* parent = get_parent();
-	while(parent) {
-		if(parent == world_node) {
-			break;
-		}
-		CanvasItem* cv = Object::cast_to<CanvasItem>(parent);
-		if(cv) {
-			transforms.push_back(cv->get_transform().affine_inverse());
-		}
-		parent = parent->get_parent();
+Transform2D Box2DPhysicsBody::get_box2dworld_transform() {
+	if (get_parent() == world_node) {
+		return get_transform();
 	}
 
-	Transform2D target_xform{};
-	while(transforms.size() > 0) {
-		target_xform = target_xform * transforms.back();
-		transforms.pop_back();
+	validate_parent_xform_cache();
+	return parent_to_world_xform * get_transform();
+}
+
+void Box2DPhysicsBody::set_box2dworld_transform(const Transform2D &p_transform) {
+	if (get_parent() == world_node) {
+		set_transform(p_transform);
+		return;
 	}
-	set_transform(target_xform);
+
+	validate_parent_xform_cache();
+	set_transform(world_to_parent_xform * p_transform);
 }
 
 void Box2DPhysicsBody::state_changed() {
+	last_synced_b2_xform = body->GetTransform();
+
 	set_block_transform_notify(true);
-	set_box2dworld_transform(b2_to_gd(body->GetTransform()));
+	set_box2dworld_transform(b2_to_gd(last_synced_b2_xform));
 	set_block_transform_notify(false);
 	//if (get_script_instance())
 	//	get_script_instance()->call("_integrate_forces");
@@ -146,10 +168,41 @@ void Box2DPhysicsBody::state_changed() {
 	//}
 }
 
+void Box2DPhysicsBody::interpolate_state(real_t p_fraction) {
+	set_block_transform_notify(true);
+	set_box2dworld_transform(interp_prev_xform.interpolate_with(interp_curr_xform, p_fraction));
+	set_block_transform_notify(false);
+}
+
+void Box2DPhysicsBody::track_awake() {
+	if (world_node && body) {
+		world_node->track_awake_body(this);
+	}
+}
+
+void Box2DPhysicsBody::submit_command(Box2DBodyCommand::Type p_type, const b2Vec2 &p_vector, const b2Vec2 &p_point, float p_scalar, bool p_wake) {
+	Box2DBodyCommand command;
+	command.type = p_type;
+	command.body = this;
+	command.vector = p_vector;
+	command.point = p_point;
+	command.scalar = p_scalar;
+	command.wake = p_wake;
+
+	if (is_world_stepping()) {
+		world_node->queue_command(command);
+	} else {
+		world_node->apply_command(command);
+	}
+}
+
 void Box2DPhysicsBody::_notification(int p_what) {
 	// TODO finalize implementation to imitate behavior from RigidBody2D and Kinematic (static too?)
 	switch (p_what) {
 		case NOTIFICATION_PREDELETE: {
+			// Filter lists are read by the running step
+			wait_for_world_step();
+
 			// Inform joints that this node is no more
 			auto joint = joints.front();
 			while (joint) {
@@ -161,14 +214,28 @@ void Box2DPhysicsBody::_notification(int p_what) {
 			for (int i = 0; i < filtering_me.size(); i++) {
 				filtering_me[i]->filtered.erase(this);
 			}
+			for (int i = 0; i < filtered.size(); i++) {
+				filtered[i]->filtering_me.erase(this);
+			}
 
+			// Uses the lists above to remove this body's exception pairs
 			destroy_b2Body();
+
+			for (int i = 0; i < filtering_me.size(); i++) {
+				if (filtering_me[i]->world_node) {
+					filtering_me[i]->wait_for_world_step();
+					filtering_me[i]->world_node->update_exception_flags(filtering_me[i]);
+				}
+			}
+			for (int i = 0; i < filtered.size(); i++) {
+				if (filtered[i]->world_node) {
+					filtered[i]->wait_for_world_step();
+					filtered[i]->world_node->update_exception_flags(filtered[i]);
+				}
+			}
 		} break;
 
 		case NOTIFICATION_ENTER_TREE: {
-			//last_valid_xform = get_global_transform();
-			last_valid_xform = get_box2dworld_transform();
-
 			// Find the Box2DWorld
 			Node *_ancestor = get_parent();
 			Box2DWorld *new_world = NULL;
@@ -177,6 +244,9 @@ void Box2DPhysicsBody::_notification(int p_what) {
 				_ancestor = _ancestor->get_parent();
 			}
 
+			// The ancestor chain may have changed
+			parent_xform_dirty = true;
+
 			// If new parent, recreate body
 			if (new_world != world_node) {
 				// Destroy b2Body
@@ -187,6 +257,7 @@ void Box2DPhysicsBody::_notification(int p_what) {
 					}
 				}
 				world_node = new_world;
+				parent_xform_dirty = true;
 				// Create b2Body
 				if (world_node) {
 					world_node->bodies.insert(this);
@@ -197,6 +268,8 @@ void Box2DPhysicsBody::_notification(int p_what) {
 				}
 			}
 
+			last_valid_xform = get_box2dworld_transform();
+
 			if (Engine::get_singleton()->is_editor_hint() || get_tree()->is_debugging_collisions_hint()) {
 				set_process_internal(true);
 			}
@@ -219,13 +292,17 @@ void Box2DPhysicsBody::_notification(int p_what) {
 			//Transform2D new_xform = get_box2dworld_transform();
 			Transform2D new_xform = get_box2dworld_transform();
 
+			// Teleport. Don't interpolate from the old pose.
+			interp_prev_xform = new_xform;
+			interp_curr_xform = new_xform;
+
 			bodyDef.position = gd_to_b2(new_xform.get_origin());
 			bodyDef.angle = new_xform.get_rotation();
 
 			if (body) {
-				body->SetTransform(gd_to_b2(new_xform.get_origin()), new_xform.get_rotation());
+				submit_command(Box2DBodyCommand::SET_TRANSFORM, bodyDef.position, b2Vec2_zero, bodyDef.angle);
 				// Revert changes. Node transform shall be updated on physics process.
-				if (body->GetType() != b2_staticBody) {
+				if (bodyDef.type != b2_staticBody) {
 					//set_notify_local_transform(false);
 					//set_global_transform(last_valid_xform);
 					//set_notify_local_transform(true);
@@ -242,27 +319,6 @@ void Box2DPhysicsBody::_notification(int p_what) {
 			}
 		} break;
 
-		case NOTIFICATION_INTERNAL_PHYSICS_PROCESS: {
-			
-			// TODO figure out if this can instead be a callback from Box2D.
-			//		I don't think it can.
-			if (body) {
-				const bool awake = body->IsAwake();
-				if (awake != prev_sleeping_state) {
-					emit_signal("sleeping_state_changed");
-					prev_sleeping_state = awake;
-				}
-				const bool enabled = body->IsEnabled();
-				if (enabled != prev_enabled_state) {
-					emit_signal("enabled_state_changed");
-				}
-
-				if (awake) {
-					state_changed();
-				}
-			}
-		} break;
-
 		case NOTIFICATION_INTERNAL_PROCESS: {
 			// Do nothing
 		} break;
@@ -337,6 +393,10 @@ void Box2DPhysicsBody::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_group_index"), &Box2DPhysicsBody::get_group_index);
 
 	ClassDB::bind_method(D_METHOD("set_filter_data", "collision_layer", "collision_mask", "group_index"), &Box2DPhysicsBody::set_filter_data);
+	ClassDB::bind_method(D_METHOD("set_collision_tag", "collision_tag"), &Box2DPhysicsBody::set_collision_tag);
+	ClassDB::bind_method(D_METHOD("get_collision_tag"), &Box2DPhysicsBody::get_collision_tag);
+	ClassDB::bind_method(D_METHOD("set_one_way_drop_through", "drop_through"), &Box2DPhysicsBody::set_one_way_drop_through);
+	ClassDB::bind_method(D_METHOD("is_one_way_drop_through"), &Box2DPhysicsBody::is_one_way_drop_through);
 
 	ClassDB::bind_method(D_METHOD("get_collision_exceptions"), &Box2DPhysicsBody::get_collision_exceptions);
 	ClassDB::bind_method(D_METHOD("add_collision_exception_with", "body"), &Box2DPhysicsBody::add_collision_exception_with);
@@ -346,6 +406,18 @@ void Box2DPhysicsBody::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("is_contact_monitor_enabled"), &Box2DPhysicsBody::is_contact_monitor_enabled);
 	ClassDB::bind_method(D_METHOD("set_max_contacts_reported", "amount"), &Box2DPhysicsBody::set_max_contacts_reported);
 	ClassDB::bind_method(D_METHOD("get_max_contacts_reported"), &Box2DPhysicsBody::get_max_contacts_reported);
+	ClassDB::bind_method(D_METHOD("set_fixture_signals", "enabled"), &Box2DPhysicsBody::set_fixture_signals);
+	ClassDB::bind_method(D_METHOD("is_fixture_signals_enabled"), &Box2DPhysicsBody::is_fixture_signals_enabled);
+	ClassDB::bind_method(D_METHOD("set_contact_min_impulse", "impulse"), &Box2DPhysicsBody::set_contact_min_impulse);
+	ClassDB::bind_method(D_METHOD("get_contact_min_impulse"), &Box2DPhysicsBody::get_contact_min_impulse);
+	ClassDB::bind_method(D_METHOD("set_contact_min_impact_speed", "speed"), &Box2DPhysicsBody::set_contact_min_impact_speed);
+	ClassDB::bind_method(D_METHOD("get_contact_min_impact_speed"), &Box2DPhysicsBody::get_contact_min_impact_speed);
+	ClassDB::bind_method(D_METHOD("set_contact_pair_summary", "enabled"), &Box2DPhysicsBody::set_contact_pair_summary);
+	ClassDB::bind_method(D_METHOD("is_contact_pair_summary_enabled"), &Box2DPhysicsBody::is_contact_pair_summary_enabled);
+	ClassDB::bind_method(D_METHOD("set_impact_tracking", "enabled"), &Box2DPhysicsBody::set_impact_tracking);
+	ClassDB::bind_method(D_METHOD("is_impact_tracking_enabled"), &Box2DPhysicsBody::is_impact_tracking_enabled);
+	ClassDB::bind_method(D_METHOD("set_impact_signal_threshold", "impulse"), &Box2DPhysicsBody::set_impact_signal_threshold);
+	ClassDB::bind_method(D_METHOD("get_impact_signal_threshold"), &Box2DPhysicsBody::get_impact_signal_threshold);
 
 	ClassDB::bind_method(D_METHOD("get_colliding_bodies"), &Box2DPhysicsBody::get_colliding_bodies);
 
@@ -358,6 +430,19 @@ void Box2DPhysicsBody::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_contact_normal_impulse", "idx"), &Box2DPhysicsBody::get_contact_normal_impulse);
 	ClassDB::bind_method(D_METHOD("get_contact_tangent_impulse", "idx"), &Box2DPhysicsBody::get_contact_tangent_impulse);
 
+	ClassDB::bind_method(D_METHOD("get_contact_pair_count"), &Box2DPhysicsBody::get_contact_pair_count);
+	ClassDB::bind_method(D_METHOD("get_contact_pair_body", "idx"), &Box2DPhysicsBody::get_contact_pair_body);
+	ClassDB::bind_method(D_METHOD("get_contact_pair_total_impulse", "idx"), &Box2DPhysicsBody::get_contact_pair_total_impulse);
+	ClassDB::bind_method(D_METHOD("get_contact_pair_max_impulse", "idx"), &Box2DPhysicsBody::get_contact_pair_max_impulse);
+	ClassDB::bind_method(D_METHOD("get_contact_pair_point", "idx"), &Box2DPhysicsBody::get_contact_pair_point);
+	ClassDB::bind_method(D_METHOD("get_contact_pair_normal", "idx"), &Box2DPhysicsBody::get_contact_pair_normal);
+
+	ClassDB::bind_method(D_METHOD("get_impact_total_impulse"), &Box2DPhysicsBody::get_impact_total_impulse);
+	ClassDB::bind_method(D_METHOD("get_impact_peak_impulse"), &Box2DPhysicsBody::get_impact_peak_impulse);
+	ClassDB::bind_method(D_METHOD("get_impact_peak_speed"), &Box2DPhysicsBody::get_impact_peak_speed);
+	ClassDB::bind_method(D_METHOD("get_impact_peak_body"), &Box2DPhysicsBody::get_impact_peak_body);
+	ClassDB::bind_method(D_METHOD("get_impact_energy_lost"), &Box2DPhysicsBody::get_impact_energy_lost);
+
 	ClassDB::bind_method(D_METHOD("apply_force", "force", "point"), &Box2DPhysicsBody::apply_force, DEFVAL(true));
 	ClassDB::bind_method(D_METHOD("apply_central_force", "force"), &Box2DPhysicsBody::apply_central_force, DEFVAL(true));
 	ClassDB::bind_method(D_METHOD("apply_torque", "torque"), &Box2DPhysicsBody::apply_torque, DEFVAL(true));
@@ -372,6 +457,12 @@ void Box2DPhysicsBody::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "fixed_rotation"), "set_fixed_rotation", "is_fixed_rotation");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "contacts_reported", PROPERTY_HINT_RANGE, "0,64,1,or_greater"), "set_max_contacts_reported", "get_max_contacts_reported");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "contact_monitor"), "set_contact_monitor", "is_contact_monitor_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "fixture_signals"), "set_fixture_signals", "is_fixture_signals_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "contact_min_impulse", PROPERTY_HINT_RANGE, "0,100,0.01,or_greater"), "set_contact_min_impulse", "get_contact_min_impulse");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "contact_min_impact_speed", PROPERTY_HINT_RANGE, "0,1000,0.1,or_greater"), "set_contact_min_impact_speed", "get_contact_min_impact_speed");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "contact_pair_summary"), "set_contact_pair_summary", "is_contact_pair_summary_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "impact_tracking"), "set_impact_tracking", "is_impact_tracking_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "impact_signal_threshold", PROPERTY_HINT_RANGE, "0,100,0.01,or_greater"), "set_impact_signal_threshold", "get_impact_signal_threshold");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "awake"), "set_awake", "is_awake"); // TODO rename to sleeping, or keep and add sleeping property
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "can_sleep"), "set_can_sleep", "get_can_sleep");
 	ADD_GROUP("Linear", "linear_");
@@ -390,12 +481,16 @@ void Box2DPhysicsBody::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "collision_layer", PROPERTY_HINT_LAYERS_2D_PHYSICS), "set_collision_layer", "get_collision_layer");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "collision_mask", PROPERTY_HINT_LAYERS_2D_PHYSICS), "set_collision_mask", "get_collision_mask");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "group_index"), "set_group_index", "get_group_index");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "collision_tag", PROPERTY_HINT_RANGE, "0,31,1"), "set_collision_tag", "get_collision_tag");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "one_way_drop_through"), "set_one_way_drop_through", "is_one_way_drop_through");
 
 	ADD_SIGNAL(MethodInfo("body_fixture_entered", PropertyInfo(Variant::OBJECT, "fixture", PROPERTY_HINT_RESOURCE_TYPE, "Node"), PropertyInfo(Variant::OBJECT, "local_fixture", PROPERTY_HINT_RESOURCE_TYPE, "Node")));
 	ADD_SIGNAL(MethodInfo("body_fixture_exited", PropertyInfo(Variant::OBJECT, "fixture", PROPERTY_HINT_RESOURCE_TYPE, "Node"), PropertyInfo(Variant::OBJECT, "local_fixture", PROPERTY_HINT_RESOURCE_TYPE, "Node")));
 	ADD_SIGNAL(MethodInfo("body_entered", PropertyInfo(Variant::OBJECT, "body", PROPERTY_HINT_RESOURCE_TYPE, "Node")));
 	ADD_SIGNAL(MethodInfo("body_exited", PropertyInfo(Variant::OBJECT, "body", PROPERTY_HINT_RESOURCE_TYPE, "Node")));
+	ADD_SIGNAL(MethodInfo("impact", PropertyInfo(Variant::OBJECT, "body", PROPERTY_HINT_RESOURCE_TYPE, "Node"), PropertyInfo(Variant::FLOAT, "impulse")));
 	ADD_SIGNAL(MethodInfo("sleeping_state_changed"));
+	ADD_SIGNAL(MethodInfo("enabled_state_changed"));
 
 	BIND_ENUM_CONSTANT(MODE_RIGID);
 	BIND_ENUM_CONSTANT(MODE_STATIC);
@@ -437,29 +532,31 @@ String Box2DPhysicsBody::get_configuration_warning() const {
 }
 
 void Box2DPhysicsBody::set_linear_velocity(const Vector2 &p_vel) {
+	bodyDef.linearVelocity = gd_to_b2(p_vel);
 	if (body) {
-		body->SetLinearVelocity(gd_to_b2(p_vel));
+		published_linear_velocity = bodyDef.linearVelocity;
+		submit_command(Box2DBodyCommand::SET_LINEAR_VELOCITY, bodyDef.linearVelocity);
 	}
-	bodyDef.linearVelocity = gd_to_b2(p_vel);
 }
 
 Vector2 Box2DPhysicsBody::get_linear_velocity() const {
 	if (body) {
-		return b2_to_gd(body->GetLinearVelocity());
+		return b2_to_gd(is_world_stepping() ? published_linear_velocity : body->GetLinearVelocity());
 	}
 	return b2_to_gd(bodyDef.linearVelocity);
 }
 
 void Box2DPhysicsBody::set_angular_velocity(const real_t p_omega) {
+	bodyDef.angularVelocity = p_omega;
 	if (body) {
-		body->SetAngularVelocity(p_omega);
+		published_angular_velocity = p_omega;
+		submit_command(Box2DBodyCommand::SET_ANGULAR_VELOCITY, b2Vec2_zero, b2Vec2_zero, p_omega);
 	}
-	bodyDef.angularVelocity = p_omega;
 }
 
 real_t Box2DPhysicsBody::get_angular_velocity() const {
 	if (body)
-		return body->GetAngularVelocity();
+		return is_world_stepping() ? published_angular_velocity : body->GetAngularVelocity();
 	return bodyDef.angularVelocity;
 }
 
@@ -543,8 +640,10 @@ void Box2DPhysicsBody::set_linear_damping(real_t p_damping) {
 		linear_damping = -1;
 		p_damping = GLOBAL_GET("physics/2d/default_linear_damp");
 	}
-	if (body)
+	if (body) {
+		wait_for_world_step();
 		body->SetLinearDamping(p_damping);
+	}
 	bodyDef.linearDamping = p_damping;
 }
 
@@ -558,8 +657,10 @@ void Box2DPhysicsBody::set_angular_damping(real_t p_damping) {
 		angular_damping = -1;
 		p_damping = GLOBAL_GET("physics/2d/default_angular_damp");
 	}
-	if (body)
+	if (body) {
+		wait_for_world_step();
 		body->SetAngularDamping(p_damping);
+	}
 	bodyDef.angularDamping = p_damping;
 }
 
@@ -568,8 +669,10 @@ real_t Box2DPhysicsBody::get_angular_damping() const {
 }
 
 void Box2DPhysicsBody::set_gravity_scale(real_t p_scale) {
-	if (body)
+	if (body) {
+		wait_for_world_step();
 		body->SetGravityScale(p_scale);
+	}
 	bodyDef.gravityScale = p_scale;
 }
 
@@ -578,8 +681,11 @@ real_t Box2DPhysicsBody::get_gravity_scale() const {
 }
 
 void Box2DPhysicsBody::set_type(Mode p_type) {
-	if (body)
+	if (body) {
+		wait_for_world_step();
 		body->SetType(static_cast<b2BodyType>(p_type));
+		track_awake();
+	}
 	bodyDef.type = static_cast<b2BodyType>(p_type);
 }
 
@@ -588,8 +694,10 @@ Box2DPhysicsBody::Mode Box2DPhysicsBody::get_type() const {
 }
 
 void Box2DPhysicsBody::set_bullet(bool p_ccd) {
-	if (body)
+	if (body) {
+		wait_for_world_step();
 		body->SetBullet(p_ccd);
+	}
 	bodyDef.bullet = p_ccd;
 }
 
@@ -598,21 +706,26 @@ bool Box2DPhysicsBody::is_bullet() const {
 }
 
 void Box2DPhysicsBody::set_awake(bool p_awake) {
-	if (body)
+	if (body) {
+		wait_for_world_step();
 		body->SetAwake(p_awake);
+		track_awake();
+	}
 	bodyDef.awake = p_awake;
 	prev_sleeping_state = p_awake;
 }
 
 bool Box2DPhysicsBody::is_awake() const {
 	if (body)
-		return body->IsAwake();
+		return is_world_stepping() ? prev_sleeping_state : body->IsAwake();
 	return bodyDef.awake;
 }
 
 void Box2DPhysicsBody::set_can_sleep(bool p_can_sleep) {
-	if (body)
+	if (body) {
+		wait_for_world_step();
 		body->SetSleepingAllowed(p_can_sleep);
+	}
 	bodyDef.allowSleep = p_can_sleep;
 }
 
@@ -621,9 +734,15 @@ bool Box2DPhysicsBody::get_can_sleep() const {
 }
 
 void Box2DPhysicsBody::set_enabled(bool p_enabled) {
-	if (body)
+	if (bodyDef.enabled == p_enabled) {
+		return;
+	}
+	if (body) {
+		wait_for_world_step();
 		body->SetEnabled(p_enabled);
+	}
 	bodyDef.enabled = p_enabled;
+	emit_signal(B2SN->enabled_state_changed);
 }
 
 bool Box2DPhysicsBody::is_enabled() const {
@@ -631,8 +750,10 @@ bool Box2DPhysicsBody::is_enabled() const {
 }
 
 void Box2DPhysicsBody::set_fixed_rotation(bool p_fixed) {
-	if (body)
+	if (body) {
+		wait_for_world_step();
 		body->SetFixedRotation(p_fixed);
+	}
 	bodyDef.fixedRotation = p_fixed;
 }
 
@@ -682,6 +803,27 @@ void Box2DPhysicsBody::set_filter_data(uint16_t p_layer, uint16_t p_mask, int16
 	}
 }
 
+void Box2DPhysicsBody::set_collision_tag(int p_tag) {
+	ERR_FAIL_INDEX(p_tag, Box2DCollisionRules::MAX_TAGS);
+	if (collision_tag != p_tag) {
+		collision_tag = p_tag;
+		update_filterdata();
+	}
+}
+
+int Box2DPhysicsBody::get_collision_tag() const {
+	return collision_tag;
+}
+
+void Box2DPhysicsBody::set_one_way_drop_through(bool p_drop_through) {
+	wait_for_world_step();
+	one_way_drop_through = p_drop_through;
+}
+
+bool Box2DPhysicsBody::is_one_way_drop_through() const {
+	return one_way_drop_through;
+}
+
 Array Box2DPhysicsBody::get_collision_exceptions() {
 	Array ret;
 	for (int i = 0; i < filtered.size(); i++) {
@@ -694,24 +836,57 @@ void Box2DPhysicsBody::add_collision_exception_with(Node *p_node) {
 	ERR_FAIL_NULL(p_node);
 	Box2DPhysicsBody *body = Object::cast_to<Box2DPhysicsBody>(p_node);
 	ERR_FAIL_COND_MSG(!body, "Body collision exceptions only work with other bodies. Submit an issue if you need this.");
+	wait_for_world_step();
+	body->wait_for_world_step();
 	filtered.insert(body);
 	body->filtering_me.insert(this);
+	update_exception(body, true);
 }
 
 void Box2DPhysicsBody::remove_collision_exception_with(Node *p_node) {
 	ERR_FAIL_NULL(p_node);
 	Box2DPhysicsBody *body = Object::cast_to<Box2DPhysicsBody>(p_node);
 	ERR_FAIL_COND_MSG(!body, "Body collision exceptions only work with other bodies. Submit an issue if you need this.");
+	wait_for_world_step();
+	body->wait_for_world_step();
 	filtered.erase(body);
 	body->filtering_me.erase(this);
+	update_exception(body, false);
+}
+
+void Box2DPhysicsBody::update_exception(Box2DPhysicsBody *p_other, bool p_added) {
+	const uint64_t id = get_instance_id();
+	const uint64_t other_id = p_other->get_instance_id();
+	Box2DWorld *worlds[2] = { world_node, p_other->world_node != world_node ? p_other->world_node : NULL };
+	for (int i = 0; i < 2; ++i) {
+		if (!worlds[i]) {
+			continue;
+		}
+		if (p_added) {
+			worlds[i]->exception_pairs.add(id, other_id);
+		} else {
+			worlds[i]->exception_pairs.remove(id, other_id);
+		}
+	}
+
+	if (world_node) {
+		world_node->update_exception_flags(this);
+	}
+	if (p_other->world_node) {
+		p_other->world_node->update_exception_flags(p_other);
+	}
 }
 
 void Box2DPhysicsBody::set_contact_monitor(bool p_enabled) {
 	if (p_enabled == is_contact_monitor_enabled()) {
 		return;
 	}
+	wait_for_world_step();
 
 	if (!p_enabled) {
+		if (world_node) {
+			world_node->detach_contact_monitor(this);
+		}
 		memdelete(contact_monitor);
 		contact_monitor = NULL;
 	} else {
@@ -729,6 +904,7 @@ bool Box2DPhysicsBody::is_contact_monitor_enabled() const {
 }
 
 void Box2DPhysicsBody::set_max_contacts_reported(int p_amount) {
+	wait_for_world_step();
 	max_contacts_reported = p_amount;
 }
 
@@ -736,12 +912,121 @@ int Box2DPhysicsBody::get_max_contacts_reported() const {
 	return max_contacts_reported;
 }
 
+void Box2DPhysicsBody::set_fixture_signals(bool p_enabled) {
+	if (fixture_signals == p_enabled) {
+		return;
+	}
+	wait_for_world_step();
+	fixture_signals = p_enabled;
+
+	if (!fixture_signals && contact_monitor) {
+		// Drop the fixture counts, since they won't be kept up to date anymore.
+		// Fixtures already touching when signals are turned back on report once they separate and touch again.
+		List<ObjectID> keys;
+		contact_monitor->entered_objects.get_key_list(&keys);
+		for (List<ObjectID>::Element *E = keys.front(); E; E = E->next()) {
+			if (Object::cast_to<Box2DFixture>(ObjectDB::get_instance(E->get()))) {
+				contact_monitor->entered_objects.erase(E->get());
+			}
+		}
+		if (world_node) {
+			world_node->mark_contact_monitor_dirty(this);
+		}
+	}
+}
+
+bool Box2DPhysicsBody::is_fixture_signals_enabled() const {
+	return fixture_signals;
+}
+
+void Box2DPhysicsBody::set_contact_min_impulse(real_t p_impulse) {
+	wait_for_world_step();
+	contact_min_impulse = MAX(p_impulse, 0.0f);
+}
+
+real_t Box2DPhysicsBody::get_contact_min_impulse() const {
+	return contact_min_impulse;
+}
+
+void Box2DPhysicsBody::set_contact_min_impact_speed(real_t p_speed) {
+	wait_for_world_step();
+	contact_min_impact_speed = MAX(p_speed, 0.0f);
+}
+
+real_t Box2DPhysicsBody::get_contact_min_impact_speed() const {
+	return contact_min_impact_speed;
+}
+
+void Box2DPhysicsBody::set_contact_pair_summary(bool p_enabled) {
+	if (contact_pair_summary == p_enabled) {
+		return;
+	}
+	wait_for_world_step();
+	contact_pair_summary = p_enabled;
+
+	// Drop whatever the old mode reported
+	if (contact_monitor) {
+		if (world_node) {
+			world_node->detach_contact_monitor(this);
+			world_node->mark_contact_monitor_dirty(this);
+		}
+		contact_monitor->pairs.clear();
+		contact_monitor->pair_index.clear();
+
+		// Contacts that are already touching were never buffered for this body
+		if (body && !contact_pair_summary) {
+			world_node->flag_rescan_contacts_monitored = true;
+		}
+	}
+}
+
+bool Box2DPhysicsBody::is_contact_pair_summary_enabled() const {
+	return contact_pair_summary;
+}
+
+void Box2DPhysicsBody::set_impact_tracking(bool p_enabled) {
+	wait_for_world_step();
+	impact_tracking = p_enabled;
+}
+
+bool Box2DPhysicsBody::is_impact_tracking_enabled() const {
+	return impact_tracking;
+}
+
+void Box2DPhysicsBody::set_impact_signal_threshold(real_t p_impulse) {
+	impact_signal_threshold = MAX(p_impulse, 0.0f);
+}
+
+real_t Box2DPhysicsBody::get_impact_signal_threshold() const {
+	return impact_signal_threshold;
+}
+
+float Box2DPhysicsBody::get_impact_total_impulse() const {
+	return reported_impact.total_impulse;
+}
+
+float Box2DPhysicsBody::get_impact_peak_impulse() const {
+	return reported_impact.peak_impulse;
+}
+
+float Box2DPhysicsBody::get_impact_peak_speed() const {
+	return reported_impact.peak_impact_speed;
+}
+
+Object *Box2DPhysicsBody::get_impact_peak_body() const {
+	return ObjectDB::get_instance(reported_impact.peak_body);
+}
+
+float Box2DPhysicsBody::get_impact_energy_lost() const {
+	return reported_impact.energy_lost;
+}
+
 Array Box2DPhysicsBody::get_colliding_bodies() const {
 	ERR_FAIL_COND_V(!contact_monitor, Array());
 	Array ret;
 
 	List<ObjectID> keys;
-	contact_monitor->entered_objects.get_key_list(&keys);
+	get_reported_entered_objects().get_key_list(&keys);
 	for (int i = 0; i < keys.size(); i++) {
 		Object *node = ObjectDB::get_instance(keys[i]);
 		if (node && Object::cast_to<Box2DPhysicsBody>(node)) {
@@ -754,79 +1039,123 @@ Array Box2DPhysicsBody::get_colliding_bodies() const {
 
 int Box2DPhysicsBody::get_contact_count() const {
 	ERR_FAIL_COND_V_MSG(!contact_monitor, int(), "Contact monitoring is disabled.");
-	// TODO locking
-	return contact_monitor->contacts.size();
+	return get_reported_contact_count();
+}
+
+Box2DContactPoint Box2DPhysicsBody::get_reported_contact(int p_idx) const {
+	if (is_world_stepping()) {
+		ERR_FAIL_INDEX_V(p_idx, (int)contact_monitor->published_contacts.size(), Box2DContactPoint());
+		return contact_monitor->published_contacts[p_idx];
+	}
+	ERR_FAIL_INDEX_V(p_idx, (int)contact_monitor->contacts.size(), Box2DContactPoint());
+	return world_node->resolve_contact(contact_monitor->contacts[p_idx], this);
 }
 
 Box2DFixture *Box2DPhysicsBody::get_contact_fixture_a(int p_idx) const {
 	ERR_FAIL_COND_V_MSG(!contact_monitor, NULL, "Contact monitoring is disabled.");
-	return contact_monitor->contacts[p_idx].fixture_a;
+	return get_reported_contact(p_idx).fixture_a;
 }
 
 Box2DFixture *Box2DPhysicsBody::get_contact_fixture_b(int p_idx) const {
 	ERR_FAIL_COND_V_MSG(!contact_monitor, NULL, "Contact monitoring is disabled.");
-	return contact_monitor->contacts[p_idx].fixture_b;
+	return get_reported_contact(p_idx).fixture_b;
 }
 
 Vector2 Box2DPhysicsBody::get_contact_world_pos(int p_idx) const {
 	ERR_FAIL_COND_V_MSG(!contact_monitor, Vector2(), "Contact monitoring is disabled.");
-	return contact_monitor->contacts[p_idx].world_pos;
+	return get_reported_contact(p_idx).world_pos;
 }
 
 Vector2 Box2DPhysicsBody::get_contact_impact_velocity(int p_idx) const {
 	ERR_FAIL_COND_V_MSG(!contact_monitor, Vector2(), "Contact monitoring is disabled.");
-	return contact_monitor->contacts[p_idx].impact_velocity;
+	return get_reported_contact(p_idx).impact_velocity;
 }
 
 Vector2 Box2DPhysicsBody::get_contact_normal(int p_idx) const {
 	ERR_FAIL_COND_V_MSG(!contact_monitor, Vector2(), "Contact monitoring is disabled.");
-	return contact_monitor->contacts[p_idx].normal;
+	return get_reported_contact(p_idx).normal;
 }
 
 float Box2DPhysicsBody::get_contact_normal_impulse(int p_idx) const {
 	ERR_FAIL_COND_V_MSG(!contact_monitor, float(), "Contact monitoring is disabled.");
-	return contact_monitor->contacts[p_idx].normal_impulse;
+	return get_reported_contact(p_idx).normal_impulse;
 }
 
 Vector2 Box2DPhysicsBody::get_contact_tangent_impulse(int p_idx) const {
 	ERR_FAIL_COND_V_MSG(!contact_monitor, Vector2(), "Contact monitoring is disabled.");
-	return contact_monitor->contacts[p_idx].tangent_impulse;
+	return get_reported_contact(p_idx).tangent_impulse;
+}
+
+int Box2DPhysicsBody::get_contact_pair_count() const {
+	ERR_FAIL_COND_V_MSG(!contact_monitor, int(), "Contact monitoring is disabled.");
+	return get_reported_pairs().size();
+}
+
+Object *Box2DPhysicsBody::get_contact_pair_body(int p_idx) const {
+	ERR_FAIL_COND_V_MSG(!contact_monitor, NULL, "Contact monitoring is disabled.");
+	ERR_FAIL_INDEX_V(p_idx, (int)get_reported_pairs().size(), NULL);
+	return ObjectDB::get_instance(get_reported_pairs()[p_idx].body);
+}
+
+float Box2DPhysicsBody::get_contact_pair_total_impulse(int p_idx) const {
+	ERR_FAIL_COND_V_MSG(!contact_monitor, float(), "Contact monitoring is disabled.");
+	ERR_FAIL_INDEX_V(p_idx, (int)get_reported_pairs().size(), float());
+	return get_reported_pairs()[p_idx].total_impulse;
+}
+
+float Box2DPhysicsBody::get_contact_pair_max_impulse(int p_idx) const {
+	ERR_FAIL_COND_V_MSG(!contact_monitor, float(), "Contact monitoring is disabled.");
+	ERR_FAIL_INDEX_V(p_idx, (int)get_reported_pairs().size(), float());
+	return get_reported_pairs()[p_idx].max_impulse;
+}
+
+Vector2 Box2DPhysicsBody::get_contact_pair_point(int p_idx) const {
+	ERR_FAIL_COND_V_MSG(!contact_monitor, Vector2(), "Contact monitoring is disabled.");
+	ERR_FAIL_INDEX_V(p_idx, (int)get_reported_pairs().size(), Vector2());
+	const Box2DContactPairSummary &summary = get_reported_pairs()[p_idx];
+	return summary.point_count > 0 ? summary.point_sum / summary.point_count : Vector2();
+}
+
+Vector2 Box2DPhysicsBody::get_contact_pair_normal(int p_idx) const {
+	ERR_FAIL_COND_V_MSG(!contact_monitor, Vector2(), "Contact monitoring is disabled.");
+	ERR_FAIL_INDEX_V(p_idx, (int)get_reported_pairs().size(), Vector2());
+	return get_reported_pairs()[p_idx].normal_sum.normalized();
 }
 
 void Box2DPhysicsBody::apply_force(const Vector2 &force, const Vector2 &point, bool wake) {
 	ERR_FAIL_COND_MSG(!body, "b2Body is null.");
-	body->ApplyForce(gd_to_b2(force), gd_to_b2(point), wake);
+	submit_command(Box2DBodyCommand::APPLY_FORCE, gd_to_b2(force), gd_to_b2(point), 0.0f, wake);
 }
 
 void Box2DPhysicsBody::apply_central_force(const Vector2 &force, bool wake) {
 	ERR_FAIL_COND_MSG(!body, "b2Body is null.");
-	body->ApplyForceToCenter(gd_to_b2(force), wake);
+	submit_command(Box2DBodyCommand::APPLY_FORCE_TO_CENTER, gd_to_b2(force), b2Vec2_zero, 0.0f, wake);
 }
 
 void Box2DPhysicsBody::apply_torque(real_t torque, bool wake) {
 	ERR_FAIL_COND_MSG(!body, "b2Body is null.");
-	body->ApplyTorque(torque * GD_TO_B2, wake);
+	submit_command(Box2DBodyCommand::APPLY_TORQUE, b2Vec2_zero, b2Vec2_zero, torque * GD_TO_B2, wake);
 }
 
 void Box2DPhysicsBody::apply_linear_impulse(const Vector2 &impulse, const Vector2 &point, bool wake) {
 	ERR_FAIL_COND_MSG(!body, "b2Body is null.");
-	body->ApplyLinearImpulse(gd_to_b2(impulse), gd_to_b2(point), wake);
+	submit_command(Box2DBodyCommand::APPLY_LINEAR_IMPULSE, gd_to_b2(impulse), gd_to_b2(point), 0.0f, wake);
 }
 
 void Box2DPhysicsBody::apply_central_linear_impulse(const Vector2 &impulse, bool wake) {
 	ERR_FAIL_COND_MSG(!body, "b2Body is null.");
-	body->ApplyLinearImpulseToCenter(gd_to_b2(impulse), wake);
+	submit_command(Box2DBodyCommand::APPLY_LINEAR_IMPULSE_TO_CENTER, gd_to_b2(impulse), b2Vec2_zero, 0.0f, wake);
 }
 
 void Box2DPhysicsBody::apply_torque_impulse(real_t impulse, bool wake) {
 	ERR_FAIL_COND_MSG(!body, "b2Body is null.");
-	body->ApplyAngularImpulse(impulse * GD_TO_B2, wake);
+	submit_command(Box2DBodyCommand::APPLY_ANGULAR_IMPULSE, b2Vec2_zero, b2Vec2_zero, impulse * GD_TO_B2, wake);
 }
 
 Box2DPhysicsBody::Box2DPhysicsBody() {
 	filterDef.maskBits = 0x0001;
 
-	set_physics_process_internal(true);
+	// Transforms are written back by Box2DWorld, so bodies don't need physics process notifications
 	set_notify_local_transform(true);
 }
 
@@ -28,6 +28,7 @@ class Box2DPhysicsBody : public Node2D {
 	friend class Box2DWorld;
 	friend class Box2DFixture;
 	friend class Box2DJoint;
+	friend class Box2DCharacterBody;
 
 public:
 	enum Mode {
@@ -43,24 +44,64 @@ private:
 	real_t linear_damping = 0.0f;
 	real_t angular_damping = 0.0f;
 	b2Filter filterDef;
+	uint8_t collision_tag = 0;
+	// Passes through every one-way fixture while set
+	bool one_way_drop_through = false;
 
 	VSet<Box2DPhysicsBody *> filtered;
 	VSet<Box2DPhysicsBody *> filtering_me;
 	// TODO i don't care enough right now to let bodies exclude specific fixtures
 
 	struct ContactMonitor {
-		// bool locked; // TODO when physics moved to separate thread
-		VSet<Box2DContactPoint> contacts;
+		// Handles into the world's contact pool. Unordered, since removal swaps the last contact into the gap.
+		LocalVector<Box2DContactHandle> contacts;
+
+		// Used instead of contacts in pair summary mode. One summary per touching body, indexed by its ID.
+		LocalVector<Box2DContactPairSummary> pairs;
+		HashMap<ObjectID, uint32_t> pair_index;
 
 		// TODO when adding area functionality, this list can be used to apply area effects
 		// All the bodies/fixtures currently in contact with this body.
 		// The int value stores the number of fixtures currently in contact.
 		// When the counter transitions from 0->1 or 1->0, body_entered/exited is emitted.
 		HashMap<ObjectID, int> entered_objects;
+
+		// Copies of the above taken when an async step starts. Read instead of the live data while the step runs.
+		// The contacts are resolved and oriented for this body.
+		LocalVector<Box2DContactPoint> published_contacts;
+		LocalVector<Box2DContactPairSummary> published_pairs;
+		HashMap<ObjectID, int> published_entered_objects;
+		bool dirty = false;
 	};
 
 	ContactMonitor *contact_monitor = NULL;
 	int max_contacts_reported = 0;
+	// Contacts are only reported once a solve's total normal impulse, and its peak approach speed (as in the impact report), reach these.
+	// Points below them are never buffered.
+	real_t contact_min_impulse = 0.0f;
+	real_t contact_min_impact_speed = 0.0f;
+	// Report one summary per touching body instead of every contact point
+	bool contact_pair_summary = false;
+
+	// Everything that hit this body during a step. Impulses and energy are in Box2D units, speed in pixels/s.
+	struct ImpactReport {
+		// Box2DWorld::step_epoch of the step these were accumulated in
+		uint32_t epoch = 0;
+		float total_impulse = 0.0f;
+		float peak_impulse = 0.0f;
+		float peak_impact_speed = 0.0f;
+		ObjectID peak_body;
+		float energy_lost = 0.0f;
+	};
+
+	bool impact_tracking = false;
+	// The impact signal is emitted when a step's peak impulse reaches this. 0 never emits.
+	real_t impact_signal_threshold = 0.0f;
+	// Accumulated by the world during a step, and copied to reported_impact when the step is delivered
+	ImpactReport impact;
+	ImpactReport reported_impact;
+	// When off, only body_entered/exited are emitted and fixture contacts aren't counted
+	bool fixture_signals = true;
 
 	b2Body *body = NULL;
 
@@ -68,11 +109,38 @@ private:
 	Set<Box2DJoint *> joints;
 
 	Transform2D last_valid_xform;
-	
+
+	// Index into Box2DWorld::awake_bodies, or -1 if this body isn't tracked as awake
+	int awake_index = -1;
+	// The b2Body transform last written to (or read from) this node
+	b2Transform last_synced_b2_xform;
+	// Box2DWorld-space transforms after the previous and latest step. Only used when the world interpolates.
+	Transform2D interp_prev_xform;
+	Transform2D interp_curr_xform;
+
 	// TODO maybe keep a list of local state we want this class to track wrt a b2body parameter or field
 	// are there any others?  enabled for example can bet set on the fly in code
 	bool prev_sleeping_state = true;
-	bool prev_enabled_state = true;
+
+	// Velocities at the start of the running async step, returned by the getters until it finishes
+	b2Vec2 published_linear_velocity = b2Vec2_zero;
+	float published_angular_velocity = 0.0f;
+
+	// Cached transform from this body's parent space to Box2DWorld space, and its inverse.
+	// Only used when the body isn't a direct child of the world. It's keyed on the global transforms of the parent
+	// and the world, which Godot invalidates as soon as an ancestor moves. The body's own writebacks change neither.
+	Transform2D parent_to_world_xform;
+	Transform2D world_to_parent_xform;
+	Transform2D cached_parent_global_xform;
+	Transform2D cached_world_global_xform;
+	// False if a non-CanvasItem sits between the parent and the world, since the parent's global transform then
+	// doesn't follow every ancestor. The cache is rebuilt on every use.
+	bool parent_xform_keyed = false;
+	bool parent_xform_dirty = true;
+
+	void update_parent_xform_cache();
+	// Rebuilds the cache if it's dirty or an ancestor moved since it was built
+	void validate_parent_xform_cache();
 
 	// Moving to and from world transform
 	void set_box2dworld_transform(const Transform2D &p_transform);
@@ -87,6 +155,37 @@ private:
 	void update_filterdata();
 
 	void state_changed();
+	void interpolate_state(real_t p_fraction);
+	// Call after anything that may wake the b2Body, so the world syncs it after the next step
+	void track_awake();
+
+	_FORCE_INLINE_ bool is_world_stepping() const { return world_node && world_node->step_in_flight; }
+	// Call before touching Box2D state that a running async step may be using
+	_FORCE_INLINE_ void wait_for_world_step() {
+		if (world_node) {
+			world_node->wait_for_step();
+		}
+	}
+	// Mirrors a changed exception into this body's world (and the other body's, if different)
+	void update_exception(Box2DPhysicsBody *p_other, bool p_added);
+	// Queues the command if an async step is running, otherwise applies it right away
+	void submit_command(Box2DBodyCommand::Type p_type, const b2Vec2 &p_vector, const b2Vec2 &p_point = b2Vec2_zero, float p_scalar = 0.0f, bool p_wake = true);
+
+	_FORCE_INLINE_ bool filters_contacts() const {
+		return contact_pair_summary || contact_min_impulse > 0.0f || contact_min_impact_speed > 0.0f;
+	}
+
+	_FORCE_INLINE_ int get_reported_contact_count() const {
+		return is_world_stepping() ? contact_monitor->published_contacts.size() : contact_monitor->contacts.size();
+	}
+	// Oriented so fixture_a belongs to this body
+	Box2DContactPoint get_reported_contact(int p_idx) const;
+	_FORCE_INLINE_ const LocalVector<Box2DContactPairSummary> &get_reported_pairs() const {
+		return is_world_stepping() ? contact_monitor->published_pairs : contact_monitor->pairs;
+	}
+	_FORCE_INLINE_ const HashMap<ObjectID, int> &get_reported_entered_objects() const {
+		return is_world_stepping() ? contact_monitor->published_entered_objects : contact_monitor->entered_objects;
+	}
 
 protected:
 	void _notification(int p_what);
@@ -153,6 +252,12 @@ public:
 
 	void set_filter_data(uint16_t p_layer, uint16_t p_mask, int16 p_group_index);
 
+	void set_collision_tag(int p_tag);
+	int get_collision_tag() const;
+
+	void set_one_way_drop_through(bool p_drop_through);
+	bool is_one_way_drop_through() const;
+
 	Array get_collision_exceptions();
 	void add_collision_exception_with(Node *p_node);
 	void remove_collision_exception_with(Node *p_node);
@@ -163,6 +268,31 @@ public:
 	void set_max_contacts_reported(int p_amount);
 	int get_max_contacts_reported() const;
 
+	void set_fixture_signals(bool p_enabled);
+	bool is_fixture_signals_enabled() const;
+
+	void set_contact_min_impulse(real_t p_impulse);
+	real_t get_contact_min_impulse() const;
+
+	void set_contact_min_impact_speed(real_t p_speed);
+	real_t get_contact_min_impact_speed() const;
+
+	void set_contact_pair_summary(bool p_enabled);
+	bool is_contact_pair_summary_enabled() const;
+
+	void set_impact_tracking(bool p_enabled);
+	bool is_impact_tracking_enabled() const;
+
+	void set_impact_signal_threshold(real_t p_impulse);
+	real_t get_impact_signal_threshold() const;
+
+	// Impacts during the last step
+	float get_impact_total_impulse() const;
+	float get_impact_peak_impulse() const;
+	float get_impact_peak_speed() const;
+	Object *get_impact_peak_body() const;
+	float get_impact_energy_lost() const;
+
 	Array get_colliding_bodies() const; // Function exists for Godot feature congruency
 
 	// TODO for documentation: all contact info is in world space
@@ -179,6 +309,14 @@ public:
 	//Vector2 get_contact_total_impulse(int p_idx) const;
 	//bool get_contact_is_new(int p_idx) const;
 
+	// Pair summary mode
+	int get_contact_pair_count() const;
+	Object *get_contact_pair_body(int p_idx) const;
+	float get_contact_pair_total_impulse(int p_idx) const;
+	float get_contact_pair_max_impulse(int p_idx) const;
+	Vector2 get_contact_pair_point(int p_idx) const;
+	Vector2 get_contact_pair_normal(int p_idx) const;
+
 	void apply_force(const Vector2 &p_force, const Vector2 &p_point, bool p_wake = true);
 	void apply_central_force(const Vector2 &p_force, bool p_wake = true);
 	void apply_torque(real_t p_torque, bool p_wake = true);
@@ -2,9 +2,13 @@
 
 #include <core/config/engine.h>
 #include <core/os/os.h>
+#include <core/templates/sort_array.h>
 
 #include <box2d/b2_collision.h>
+#include <box2d/b2_distance.h>
+#include <box2d/b2_time_of_impact.h>
 
+#include "../../util/box2d_string_names.h"
 #include "box2d_fixtures.h"
 #include "box2d_joints.h"
 
@@ -15,6 +19,12 @@
 * @author Brian Semrau
 */
 
+LocalVector<Box2DWorld *> Box2DWorld::parallel_worlds;
+LocalVector<Box2DWorld *> Box2DWorld::group_batch;
+uint64_t Box2DWorld::group_step_frame = UINT64_MAX;
+ThreadWorkPool Box2DWorld::group_pool;
+bool Box2DWorld::group_pool_initialized = false;
+
 void Box2DWorld::SayGoodbye(b2Joint *joint) {
 	joint->GetUserData().owner->on_b2Joint_destroyed();
 }
@@ -24,6 +34,15 @@ void Box2DWorld::SayGoodbye(b2Fixture *fixture) {
 }
 
 bool Box2DWorld::ShouldCollide(b2Fixture *fixtureA, b2Fixture *fixtureB) {
+	// Overlap sensors are tested in update_sensor_overlaps() instead
+	if (unlikely(fixtureA->GetUserData().overlap_sensor || fixtureB->GetUserData().overlap_sensor)) {
+		return false;
+	}
+
+	return filter_fixtures(fixtureA, fixtureB);
+}
+
+inline bool Box2DWorld::filter_fixtures(b2Fixture *fixtureA, b2Fixture *fixtureB) {
 	// Default Box2D contact filtering
 
 	const b2Filter &filterA = fixtureA->GetFilterData();
@@ -41,130 +60,423 @@ bool Box2DWorld::ShouldCollide(b2Fixture *fixtureA, b2Fixture *fixtureB) {
 		return false;
 	}
 
+	// Sensor-only rules are applied in PreSolve
+	if (rule_table.size() > 0 && get_contact_rule(fixtureA, fixtureB) == Box2DCollisionRules::RULE_DENY) {
+		return false;
+	}
+
+	// Most pairs stop here, without touching the nodes
+	const uint32 exception_flags = fixtureA->GetUserData().exception_flags & fixtureB->GetUserData().exception_flags;
+	if (likely(exception_flags == 0)) {
+		return true;
+	}
+
 	// Check for fixture exclusions
 	Box2DFixture *const &ownerA = fixtureA->GetUserData().owner;
 	Box2DFixture *const &ownerB = fixtureB->GetUserData().owner;
-	if (ownerA->filtered.has(ownerB) || ownerB->filtered.has(ownerA)) {
+	if ((exception_flags & EXCEPTION_FIXTURE) && exception_pairs.has_any(ownerA->get_instance_id(), ownerB->get_instance_id())) {
 		return false;
-	} else {
-		// Check for body exclusions
-		Box2DPhysicsBody *const &bodyA = ownerA->body_node;
-		Box2DPhysicsBody *const &bodyB = ownerB->body_node;
-		if ((ownerA->accept_body_collision_exceptions && bodyA->filtered.has(bodyB)) || (ownerB->accept_body_collision_exceptions && bodyB->filtered.has(bodyA))) {
+	}
+
+	// Check for body exclusions
+	if (exception_flags & EXCEPTION_BODY) {
+		const uint64_t idA = ownerA->body_node->get_instance_id();
+		const uint64_t idB = ownerB->body_node->get_instance_id();
+		if ((ownerA->accept_body_collision_exceptions && exception_pairs.has_directed(idA, idB)) || (ownerB->accept_body_collision_exceptions && exception_pairs.has_directed(idB, idA))) {
 			return false;
-		} else {
-			// TODO should we bother to let bodies exclude fixtures?
-			return true;
 		}
 	}
+
+	// TODO should we bother to let bodies exclude fixtures?
+	return true;
 }
 
-inline void Box2DWorld::try_buffer_contact(b2Contact *contact, int i) {
-	if (contact->GetFixtureA()->IsSensor() || contact->GetFixtureB()->IsSensor()) {
+template <class T, class C = _DefaultComparator<T>>
+static void sort_unique(LocalVector<T> &r_values) {
+	if (r_values.size() < 2) {
 		return;
 	}
 
-	Box2DFixture *fnode_a = contact->GetFixtureA()->GetUserData().owner;
-	Box2DFixture *fnode_b = contact->GetFixtureB()->GetUserData().owner;
-	Box2DPhysicsBody *body_a = fnode_a->body_node;
-	Box2DPhysicsBody *body_b = fnode_b->body_node;
+	SortArray<T, C> sorter;
+	sorter.sort(r_values.ptr(), r_values.size());
 
-	const bool monitoringA = fnode_a->body_node->is_contact_monitor_enabled();
-	const bool monitoringB = fnode_b->body_node->is_contact_monitor_enabled();
+	uint32_t count = 1;
+	for (uint32_t i = 1; i < r_values.size(); ++i) {
+		if (r_values[i] != r_values[count - 1]) {
+			r_values[count++] = r_values[i];
+		}
+	}
+	r_values.resize(count);
+}
 
-	// Only buffer contacts that are being monitored, if contact monitor report count isn't exceeded
+static bool sorted_contains(const LocalVector<uint64_t> &p_values, uint64_t p_value) {
+	uint32_t low = 0;
+	uint32_t high = p_values.size();
+	while (low < high) {
+		const uint32_t mid = (low + high) / 2;
+		if (p_values[mid] < p_value) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return low < p_values.size() && p_values[low] == p_value;
+}
 
-	// If the manifold is already buffered, make sure to buffer all points in the manifold (ignoring whether the monitors have capacity)
-	// We do this so that we don't have to worry about managing half-buffered manifolds.
+void Box2DWorld::register_sensor(Box2DFixture *p_fixture) {
+	if (p_fixture->sensor_index >= 0) {
+		return;
+	}
+	wait_for_step();
+
+	p_fixture->sensor_index = sensors.size();
+	p_fixture->sensor_world = this;
+
+	SensorEntry entry;
+	entry.fixture = p_fixture;
+
+	// A recreated fixture keeps its overlaps
+	const ObjectID id = p_fixture->get_instance_id();
+	for (uint32_t i = 0; i < retired_sensors.size(); ++i) {
+		if (retired_sensors[i].fixture == id) {
+			entry.overlaps = retired_sensors[i].overlaps;
+			entry.reported_overlaps = retired_sensors[i].reported_overlaps;
+			retired_sensors.remove(i);
+			break;
+		}
+	}
+
+	sensors.push_back(entry);
+}
 
-	const bool hasCapacityA = monitoringA && (body_a->contact_monitor->contacts.size() < body_a->max_contacts_reported);
-	const bool hasCapacityB = monitoringB && (body_b->contact_monitor->contacts.size() < body_b->max_contacts_reported);
+void Box2DWorld::unregister_sensor(Box2DFixture *p_fixture) {
+	ERR_FAIL_INDEX(p_fixture->sensor_index, (int)sensors.size());
+	wait_for_step();
+
+	SensorEntry &entry = sensors[p_fixture->sensor_index];
+	if (entry.overlaps.size() > 0 || entry.reported_overlaps.size() > 0) {
+		RetiredSensor retired;
+		retired.fixture = p_fixture->get_instance_id();
+		retired.overlaps = entry.overlaps;
+		retired.reported_overlaps = entry.reported_overlaps;
+		retired_sensors.push_back(retired);
+	}
 
-	// Note: The b2Contact pointer address seems to be the only way to create a unique key. Please prove me wrong.
-	ContactBufferManifold *buffer_manifold = contact_buffer.getptr(reinterpret_cast<uint64_t>(contact));
+	// Swap-remove, then point the moved sensor at its new index
+	const int last = sensors.size() - 1;
+	if (p_fixture->sensor_index != last) {
+		sensors[p_fixture->sensor_index] = sensors[last];
+		sensors[p_fixture->sensor_index].fixture->sensor_index = p_fixture->sensor_index;
+	}
+	sensors.resize(last);
 
-	if (hasCapacityA || hasCapacityB || buffer_manifold) {
-		if (!buffer_manifold) {
-			buffer_manifold = &contact_buffer.set(reinterpret_cast<uint64_t>(contact), ContactBufferManifold())->value();
+	p_fixture->sensor_index = -1;
+	p_fixture->sensor_world = NULL;
+}
+
+void Box2DWorld::flush_retired_sensors() {
+	for (uint32_t i = 0; i < retired_sensors.size(); ++i) {
+		const RetiredSensor &retired = retired_sensors[i];
+		for (uint32_t j = 0; j < retired.overlaps.size(); ++j) {
+			SensorEvent event;
+			event.sensor = retired.fixture;
+			event.fixture = ObjectID(retired.overlaps[j]);
+			event.entered = false;
+			sensor_events.push_back(event);
 		}
+	}
+	retired_sensors.clear();
+}
 
-		// Init contact
-		Box2DContactPoint c;
-		c.id = ++next_contact_id;
-		c.fixture_a = fnode_a;
-		c.fixture_b = fnode_b;
+// Removes p_value if present. Returns whether it was.
+static bool sorted_erase(LocalVector<uint64_t> &r_values, uint64_t p_value) {
+	for (uint32_t i = 0; i < r_values.size(); ++i) {
+		if (r_values[i] == p_value) {
+			for (uint32_t j = i + 1; j < r_values.size(); ++j) {
+				r_values[j - 1] = r_values[j];
+			}
+			r_values.resize(r_values.size() - 1);
+			return true;
+		}
+		if (r_values[i] > p_value) {
+			break;
+		}
+	}
+	return false;
+}
 
-		buffer_manifold->insert(c, i);
+void Box2DWorld::remove_sensor_overlaps(Box2DFixture *p_fixture) {
+	if (sensors.size() == 0 && retired_sensors.size() == 0) {
+		return;
+	}
+	wait_for_step();
+
+	const uint64_t id = p_fixture->get_instance_id();
+	LocalVector<ObjectID> exited_sensors;
+	for (uint32_t i = 0; i < sensors.size(); ++i) {
+		sorted_erase(sensors[i].overlaps, id);
+		if (sorted_erase(sensors[i].reported_overlaps, id)) {
+			exited_sensors.push_back(sensors[i].fixture->get_instance_id());
+		}
+	}
+	for (uint32_t i = 0; i < retired_sensors.size(); ++i) {
+		sorted_erase(retired_sensors[i].overlaps, id);
+		if (sorted_erase(retired_sensors[i].reported_overlaps, id)) {
+			exited_sensors.push_back(retired_sensors[i].fixture);
+		}
+	}
 
-		// Buffer again into monitoring node
-		if (hasCapacityA) {
-			auto contacts = &fnode_a->body_node->contact_monitor->contacts;
-			contacts->insert(c);
+	if (exited_sensors.size() == 0) {
+		return;
+	}
+	Array exited;
+	exited.append(p_fixture);
+	for (uint32_t i = 0; i < exited_sensors.size(); ++i) {
+		Object *sensor = ObjectDB::get_instance(exited_sensors[i]);
+		if (sensor) {
+			sensor->emit_signal(B2SN->overlaps_changed, Array(), exited);
 		}
-		if (hasCapacityB) {
-			auto contacts = &fnode_b->body_node->contact_monitor->contacts;
-			contacts->insert(c);
+	}
+}
+
+bool Box2DWorld::test_sensor_overlap(const Box2DFixture *p_sensor, b2Fixture *p_other) const {
+	const b2Transform &sensor_xf = p_sensor->body_node->body->GetTransform();
+	const b2Transform &other_xf = p_other->GetBody()->GetTransform();
+	const int32 other_children = p_other->GetShape()->GetChildCount();
+
+	for (int f = 0; f < p_sensor->fixtures.size(); ++f) {
+		b2Fixture *fixture = p_sensor->fixtures[f];
+		const int32 children = fixture->GetShape()->GetChildCount();
+		for (int32 i = 0; i < children; ++i) {
+			for (int32 j = 0; j < other_children; ++j) {
+				// The proxy AABBs rule out most chain children before the shape test
+				if (b2TestOverlap(fixture->GetAABB(i), p_other->GetAABB(j)) &&
+						b2TestOverlap(fixture->GetShape(), i, p_other->GetShape(), j, sensor_xf, other_xf)) {
+					return true;
+				}
+			}
 		}
 	}
+	return false;
 }
 
-void Box2DWorld::BeginContact(b2Contact *contact) {
-	Box2DFixture *fnode_a = contact->GetFixtureA()->GetUserData().owner;
-	Box2DFixture *fnode_b = contact->GetFixtureB()->GetUserData().owner;
-	Box2DPhysicsBody *body_a = fnode_a->body_node;
-	Box2DPhysicsBody *body_b = fnode_b->body_node;
+void Box2DWorld::update_sensor_overlaps() {
+	if (retired_sensors.size() > 0) {
+		flush_retired_sensors();
+	}
 
-	const bool monitoringA = fnode_a->body_node->is_contact_monitor_enabled();
-	const bool monitoringB = fnode_b->body_node->is_contact_monitor_enabled();
+	for (uint32_t s = 0; s < sensors.size(); ++s) {
+		SensorEntry &entry = sensors[s];
+		const Box2DFixture *sensor = entry.fixture;
+		b2Body *sensor_body = sensor->body_node->body;
 
-	// Deliver signals to bodies with monitoring enabled
-	// Only emit body_entered once per body. Begin/EndContact are called for each *fixture*.
-	// Similar case for fixtures. One Box2DFixture may have several b2Fixtures.
-	if (monitoringA) {
-		int *body_count_ptr = body_a->contact_monitor->entered_objects.getptr(body_b->get_instance_id());
-		if (!body_count_ptr) {
-			body_count_ptr = &(body_a->contact_monitor->entered_objects.set(body_b->get_instance_id(), 0)->value());
+		sensor_scratch.clear();
+
+		if (sensor_body && sensor_body->IsEnabled() && sensor->fixtures.size() > 0) {
+			b2AABB aabb = sensor->fixtures[0]->GetAABB(0);
+			for (int f = 0; f < sensor->fixtures.size(); ++f) {
+				const int32 children = sensor->fixtures[f]->GetShape()->GetChildCount();
+				for (int32 i = 0; i < children; ++i) {
+					aabb.Combine(sensor->fixtures[f]->GetAABB(i));
+				}
+			}
+
+			// A sleeping sensor whose proxies haven't moved only needs to retest bodies that are awake.
+			// Results against other sleeping bodies carry over from the last pass.
+			const bool sensor_still = entry.tested && !sensor_body->IsAwake() && aabb.lowerBound == entry.aabb.lowerBound && aabb.upperBound == entry.aabb.upperBound;
+			entry.aabb = aabb;
+			entry.tested = true;
+
+			sensor_query.results.clear();
+			for (int f = 0; f < sensor->fixtures.size(); ++f) {
+				const int32 children = sensor->fixtures[f]->GetShape()->GetChildCount();
+				for (int32 i = 0; i < children; ++i) {
+					world->QueryAABB(&sensor_query, sensor->fixtures[f]->GetAABB(i));
+				}
+			}
+			// A fixture is reported once per overlapping proxy
+			sort_unique(sensor_query.results);
+
+			// Every b2Fixture of a node shares its filter data
+			b2Fixture *sensor_fixture = sensor->fixtures[0];
+			for (uint32_t i = 0; i < sensor_query.results.size(); ++i) {
+				b2Fixture *other = sensor_query.results[i];
+				b2Body *other_body = other->GetBody();
+
+				// Same rules as a sensor contact: another body, at least one of them dynamic, and passing the filters
+				if (other_body == sensor_body || (sensor_body->GetType() != b2_dynamicBody && other_body->GetType() != b2_dynamicBody)) {
+					continue;
+				}
+				if (!filter_fixtures(sensor_fixture, other)) {
+					continue;
+				}
+
+				const uint64_t id = other->GetUserData().owner->get_instance_id();
+				const bool overlapping = (sensor_still && !other_body->IsAwake()) ? sorted_contains(entry.overlaps, id) : test_sensor_overlap(sensor, other);
+				if (overlapping) {
+					sensor_scratch.push_back(id);
+				}
+			}
+			// Fixture nodes with several b2Fixtures are listed once
+			sort_unique(sensor_scratch);
+		} else {
+			entry.tested = false;
 		}
-		++(*body_count_ptr);
 
-		if (*body_count_ptr == 1) {
-			body_a->emit_signal("body_entered", body_b);
+		// Merge the old and new sets into enter/exit events
+		const LocalVector<uint64_t> &old_overlaps = entry.overlaps;
+		uint32_t o = 0;
+		uint32_t n = 0;
+		while (o < old_overlaps.size() || n < sensor_scratch.size()) {
+			SensorEvent event;
+			event.sensor = sensor->get_instance_id();
+			if (n >= sensor_scratch.size() || (o < old_overlaps.size() && old_overlaps[o] < sensor_scratch[n])) {
+				event.fixture = ObjectID(old_overlaps[o++]);
+				event.entered = false;
+			} else if (o >= old_overlaps.size() || sensor_scratch[n] < old_overlaps[o]) {
+				event.fixture = ObjectID(sensor_scratch[n++]);
+				event.entered = true;
+			} else {
+				++o;
+				++n;
+				continue;
+			}
+			sensor_events.push_back(event);
 		}
 
-		int *fix_count_ptr = body_a->contact_monitor->entered_objects.getptr(fnode_b->get_instance_id());
-		if (!fix_count_ptr) {
-			fix_count_ptr = &(body_a->contact_monitor->entered_objects.set(fnode_b->get_instance_id(), 0)->value());
+		entry.overlaps = sensor_scratch;
+	}
+}
+
+void Box2DWorld::deliver_sensor_events() {
+	// Events are grouped by sensor, since each sensor's events are recorded together
+	uint32_t i = 0;
+	while (i < sensor_events.size()) {
+		const ObjectID sensor_id = sensor_events[i].sensor;
+		Array entered;
+		Array exited;
+		for (; i < sensor_events.size() && sensor_events[i].sensor == sensor_id; ++i) {
+			Object *other = ObjectDB::get_instance(sensor_events[i].fixture);
+			if (other) {
+				if (sensor_events[i].entered) {
+					entered.append(other);
+				} else {
+					exited.append(other);
+				}
+			}
 		}
-		++(*fix_count_ptr);
 
-		if (*fix_count_ptr == 1) {
-			body_a->emit_signal("body_fixture_entered", fnode_b, fnode_a);
+		Box2DFixture *sensor = Object::cast_to<Box2DFixture>(ObjectDB::get_instance(sensor_id));
+		if (!sensor) {
+			continue;
+		}
+		if (sensor->sensor_index >= 0) {
+			SensorEntry &entry = sensor->sensor_world->sensors[sensor->sensor_index];
+			entry.reported_overlaps = entry.overlaps;
+		}
+		if (!entered.is_empty() || !exited.is_empty()) {
+			sensor->emit_signal(B2SN->overlaps_changed, entered, exited);
 		}
 	}
-	if (monitoringB) {
-		int *body_count_ptr = body_b->contact_monitor->entered_objects.getptr(body_a->get_instance_id());
-		if (!body_count_ptr) {
-			body_count_ptr = &(body_b->contact_monitor->entered_objects.set(body_a->get_instance_id(), 0)->value());
+	sensor_events.clear();
+}
+
+void Box2DWorld::_collision_rules_changed() {
+	collision_rules_dirty = true;
+}
+
+void Box2DWorld::update_rule_table() {
+	if (collision_rules.is_valid()) {
+		rule_table.resize(Box2DCollisionRules::MAX_TAGS * Box2DCollisionRules::MAX_TAGS);
+		const uint8_t *table = collision_rules->get_table();
+		for (uint32_t i = 0; i < rule_table.size(); ++i) {
+			rule_table[i] = table[i];
 		}
-		++(*body_count_ptr);
+	} else {
+		rule_table.clear();
+	}
 
-		if (*body_count_ptr == 1) {
-			body_b->emit_signal("body_entered", body_a);
+	// Existing contacts were filtered with the old rules
+	for (b2Body *body = world->GetBodyList(); body; body = body->GetNext()) {
+		for (b2Fixture *fixture = body->GetFixtureList(); fixture; fixture = fixture->GetNext()) {
+			fixture->Refilter();
 		}
+	}
+
+	collision_rules_dirty = false;
+}
+
+uint32 Box2DWorld::get_exception_flags(const Box2DFixture *p_fixture) {
+	const Box2DPhysicsBody *body_node = p_fixture->body_node;
+	uint32 flags = 0;
+	if (body_node && (body_node->filtered.size() > 0 || body_node->filtering_me.size() > 0)) {
+		flags |= EXCEPTION_BODY;
+	}
+	if (p_fixture->filtered.size() > 0 || p_fixture->filtering_me.size() > 0) {
+		flags |= EXCEPTION_FIXTURE;
+	}
+	return flags;
+}
 
-		int *fix_count_ptr = body_b->contact_monitor->entered_objects.getptr(fnode_a->get_instance_id());
-		if (!fix_count_ptr) {
-			fix_count_ptr = &(body_b->contact_monitor->entered_objects.set(fnode_a->get_instance_id(), 0)->value());
+void Box2DWorld::register_exceptions(const Box2DPhysicsBody *p_body, bool p_add) {
+	const uint64_t id = p_body->get_instance_id();
+	for (int i = 0; i < p_body->filtered.size(); ++i) {
+		if (p_add) {
+			exception_pairs.add(id, p_body->filtered[i]->get_instance_id());
+		} else {
+			exception_pairs.remove(id, p_body->filtered[i]->get_instance_id());
 		}
-		++(*fix_count_ptr);
+	}
+	for (int i = 0; i < p_body->filtering_me.size(); ++i) {
+		if (p_add) {
+			exception_pairs.add(p_body->filtering_me[i]->get_instance_id(), id);
+		} else {
+			exception_pairs.remove(p_body->filtering_me[i]->get_instance_id(), id);
+		}
+	}
+}
 
-		if (*fix_count_ptr == 1) {
-			body_b->emit_signal("body_fixture_entered", fnode_a, fnode_b);
+void Box2DWorld::register_exceptions(const Box2DFixture *p_fixture, bool p_add) {
+	const uint64_t id = p_fixture->get_instance_id();
+	for (int i = 0; i < p_fixture->filtered.size(); ++i) {
+		if (p_add) {
+			exception_pairs.add(id, p_fixture->filtered[i]->get_instance_id());
+		} else {
+			exception_pairs.remove(id, p_fixture->filtered[i]->get_instance_id());
+		}
+	}
+	for (int i = 0; i < p_fixture->filtering_me.size(); ++i) {
+		if (p_add) {
+			exception_pairs.add(p_fixture->filtering_me[i]->get_instance_id(), id);
+		} else {
+			exception_pairs.remove(p_fixture->filtering_me[i]->get_instance_id(), id);
 		}
 	}
 }
 
-void Box2DWorld::EndContact(b2Contact *contact) {
+void Box2DWorld::update_exception_flags(Box2DPhysicsBody *p_body) {
+	if (!p_body->body) {
+		return;
+	}
+	for (b2Fixture *fixture = p_body->body->GetFixtureList(); fixture; fixture = fixture->GetNext()) {
+		fixture->GetUserData().exception_flags = get_exception_flags(fixture->GetUserData().owner);
+		fixture->Refilter();
+	}
+}
+
+void Box2DWorld::update_exception_flags(Box2DFixture *p_fixture) {
+	const uint32 flags = get_exception_flags(p_fixture);
+	for (int i = 0; i < p_fixture->fixtures.size(); ++i) {
+		p_fixture->fixtures[i]->GetUserData().exception_flags = flags;
+		p_fixture->fixtures[i]->Refilter();
+	}
+}
+
+inline ContactBufferManifold *Box2DWorld::try_buffer_contact(b2Contact *contact, int i, ContactBufferManifold *buffer_manifold, int p_passed) {
+	if (contact->GetFixtureA()->IsSensor() || contact->GetFixtureB()->IsSensor()) {
+		return buffer_manifold;
+	}
+
 	Box2DFixture *fnode_a = contact->GetFixtureA()->GetUserData().owner;
 	Box2DFixture *fnode_b = contact->GetFixtureB()->GetUserData().owner;
 	Box2DPhysicsBody *body_a = fnode_a->body_node;
@@ -173,184 +485,1289 @@ void Box2DWorld::EndContact(b2Contact *contact) {
 	const bool monitoringA = fnode_a->body_node->is_contact_monitor_enabled();
 	const bool monitoringB = fnode_b->body_node->is_contact_monitor_enabled();
 
-	// Deliver signals to bodies with contact monitoring enabled
-	if (monitoringA) {
-		int *body_count_ptr = body_a->contact_monitor->entered_objects.getptr(body_b->get_instance_id());
-		--(*body_count_ptr);
+	// Only buffer contacts that are being monitored, if contact monitor report count isn't exceeded
 
-		if ((*body_count_ptr) == 0) {
-			body_a->contact_monitor->entered_objects.erase(body_b->get_instance_id());
-			body_a->emit_signal("body_exited", body_b);
-		}
+	// If the manifold is already buffered, make sure to buffer all points in the manifold (ignoring whether the monitors have capacity)
+	// We do this so that we don't have to worry about managing half-buffered manifolds.
 
-		int *fix_count_ptr = body_a->contact_monitor->entered_objects.getptr(fnode_b->get_instance_id());
-		--(*fix_count_ptr);
+	// Thresholded monitors only take points once a solve passes their thresholds, and summarizing monitors never take points.
 
-		if ((*fix_count_ptr) == 0) {
-			body_a->contact_monitor->entered_objects.erase(fnode_b->get_instance_id());
-			body_a->emit_signal("body_fixture_exited", fnode_b, fnode_a);
-		}
-	}
-	if (monitoringB) {
-		int *body_count_ptr = body_b->contact_monitor->entered_objects.getptr(body_a->get_instance_id());
-		--(*body_count_ptr);
+	const bool hasCapacityA = monitoringA && (!body_a->filters_contacts() || (p_passed & 1)) && ((int)body_a->contact_monitor->contacts.size() < body_a->max_contacts_reported);
+	const bool hasCapacityB = monitoringB && (!body_b->filters_contacts() || (p_passed & 2)) && ((int)body_b->contact_monitor->contacts.size() < body_b->max_contacts_reported);
 
-		if ((*body_count_ptr) == 0) {
-			body_b->contact_monitor->entered_objects.erase(body_a->get_instance_id());
-			body_b->emit_signal("body_exited", body_a);
+	if (hasCapacityA || hasCapacityB || buffer_manifold) {
+		if (!buffer_manifold) {
+			buffer_manifold = create_buffer_manifold(contact);
 		}
 
-		int *fix_count_ptr = body_b->contact_monitor->entered_objects.getptr(fnode_a->get_instance_id());
-		--(*fix_count_ptr);
+		// Init contact
+		const Box2DContactHandle handle = contact_pool.alloc();
+		Box2DContactPoint *c = contact_pool.get(handle);
+		c->fixture_a = fnode_a;
+		c->fixture_b = fnode_b;
+
+		buffer_manifold->insert(handle, i);
 
-		if ((*fix_count_ptr) == 0) {
-			body_b->contact_monitor->entered_objects.erase(fnode_a->get_instance_id());
-			body_b->emit_signal("body_fixture_exited", fnode_a, fnode_b);
+		// Monitors only hold the handle
+		if (hasCapacityA) {
+			add_monitor_contact(body_a, handle, c->monitor_index_a);
+		}
+		if (hasCapacityB) {
+			add_monitor_contact(body_b, handle, c->monitor_index_b);
 		}
 	}
 
-	// Clean up all buffered contacts in the manifold
-	ContactBufferManifold *buffer_manifold = contact_buffer.getptr(reinterpret_cast<uint64_t>(contact));
+	return buffer_manifold;
+}
 
-	if (buffer_manifold) {
-		for (int i = 0; i < buffer_manifold->count; ++i) {
-			Box2DContactPoint *c_ptr = &buffer_manifold->points[i];
+static _FORCE_INLINE_ float inverse_mass(const b2Body *p_body) {
+	const float mass = p_body->GetMass();
+	return mass > 0.0f ? 1.0f / mass : 0.0f;
+}
 
-			if (c_ptr->fixture_a->body_node->is_contact_monitor_enabled()) {
-				// TODO lock/unlock
-				c_ptr->fixture_a->body_node->contact_monitor->contacts.erase(*c_ptr);
-			}
-			if (c_ptr->fixture_b->body_node->is_contact_monitor_enabled()) {
-				// TODO lock/unlock
-				c_ptr->fixture_b->body_node->contact_monitor->contacts.erase(*c_ptr);
-			}
-		}
+// GetInertia() is about the body origin, while the solver uses the inertia about the center of mass
+static _FORCE_INLINE_ float inverse_inertia(const b2Body *p_body) {
+	const float inertia = p_body->GetInertia() - p_body->GetMass() * p_body->GetLocalCenter().LengthSquared();
+	return inertia > b2_epsilon ? 1.0f / inertia : 0.0f;
+}
 
-		ERR_FAIL_COND(!contact_buffer.erase(reinterpret_cast<uint64_t>(contact)));
+// Relative normal velocity at a contact point after the solve, and before it. The impulse is undone along the point's
+// effective normal mass, so the rotation of an off-center hit is accounted for.
+static _FORCE_INLINE_ void solve_normal_velocities(const b2Body *p_a, const b2Body *p_b, const b2Vec2 &p_point, const b2Vec2 &p_normal, float p_impulse, float &r_before, float &r_after) {
+	const float rn_a = b2Cross(p_point - p_a->GetWorldCenter(), p_normal);
+	const float rn_b = b2Cross(p_point - p_b->GetWorldCenter(), p_normal);
+	const float k = inverse_mass(p_a) + inverse_mass(p_b) + inverse_inertia(p_a) * rn_a * rn_a + inverse_inertia(p_b) * rn_b * rn_b;
+
+	r_after = b2Dot(p_b->GetLinearVelocityFromWorldPoint(p_point) - p_a->GetLinearVelocityFromWorldPoint(p_point), p_normal);
+	r_before = r_after - p_impulse * k;
+}
+
+// The fastest approach speed among the solved points, in Box2D units
+static float peak_approach_speed(b2Contact *contact, const b2ContactImpulse *impulse, const b2WorldManifold &p_manifold) {
+	const b2Body *b2_a = contact->GetFixtureA()->GetBody();
+	const b2Body *b2_b = contact->GetFixtureB()->GetBody();
+
+	float peak_speed = 0.0f;
+	for (int i = 0; i < impulse->count; ++i) {
+		float vn_before, vn_after;
+		solve_normal_velocities(b2_a, b2_b, p_manifold.points[i], p_manifold.normal, impulse->normalImpulses[i], vn_before, vn_after);
+		peak_speed = MAX(peak_speed, -vn_before);
 	}
+	return peak_speed;
 }
 
-void Box2DWorld::PreSolve(b2Contact *contact, const b2Manifold *oldManifold) {
-	b2PointState state1[2], state2[2];
-	b2GetPointStates(state1, state2, oldManifold, contact->GetManifold());
+inline void Box2DWorld::init_contact_point(b2Contact *contact, Box2DContactPoint *c_ptr, const b2WorldManifold &p_manifold, int i) const {
+	c_ptr->solve_epoch = step_epoch;
+	c_ptr->normal = Vector2(p_manifold.normal.x, p_manifold.normal.y);
+	c_ptr->world_pos = b2_to_gd(p_manifold.points[i]);
 
-	Box2DFixture *fnode_a = contact->GetFixtureA()->GetUserData().owner;
-	Box2DFixture *fnode_b = contact->GetFixtureB()->GetUserData().owner;
+	// Reset accumulated values
+	c_ptr->normal_impulse = 0.0f;
+	c_ptr->tangent_impulse = Vector2();
 
-	ContactBufferManifold *buffer_manifold = contact_buffer.getptr(reinterpret_cast<uint64_t>(contact));
+	b2Vec2 point = p_manifold.points[i];
+	b2Vec2 relV = contact->GetFixtureB()->GetBody()->GetLinearVelocityFromWorldPoint(point);
+	relV -= contact->GetFixtureA()->GetBody()->GetLinearVelocityFromWorldPoint(point);
 
-	if (unlikely(flag_rescan_contacts_monitored) && !buffer_manifold) {
-		// Buffer a contact that only started being monitored after it transitioned from b2_addState
-		for (int i = 0; i < b2_maxManifoldPoints; ++i) {
-			if (state1[i] == b2PointState::b2_persistState) {
-				try_buffer_contact(contact, i);
-			}
-		}
-		buffer_manifold = contact_buffer.getptr(reinterpret_cast<uint64_t>(contact)); // possible optimization: try_buffer_contact could return buffer_manifold ptr
-	}
+	c_ptr->impact_velocity = b2_to_gd(relV);
+}
 
-	// Handle removed/added points within the manifold
-	for (int i = b2_maxManifoldPoints - 1; i >= 0; --i) {
-		if (state1[i] == b2PointState::b2_removeState) {
-			// Remove this contact
-			if (buffer_manifold && i < buffer_manifold->count) {
-				Box2DContactPoint *c_ptr = &buffer_manifold->points[i];
+void Box2DWorld::report_filtered_contact(b2Contact *contact, const b2ContactImpulse *impulse, Box2DPhysicsBody *body_a, Box2DPhysicsBody *body_b) {
+	float total_impulse = 0.0f;
+	for (int i = 0; i < impulse->count; ++i) {
+		total_impulse += impulse->normalImpulses[i];
+	}
 
-				if (c_ptr->fixture_a->body_node->is_contact_monitor_enabled()) {
-					// TODO lock/unlock
-					c_ptr->fixture_a->body_node->contact_monitor->contacts.erase(*c_ptr);
-				}
-				if (c_ptr->fixture_b->body_node->is_contact_monitor_enabled()) {
-					// TODO lock/unlock
-					c_ptr->fixture_b->body_node->contact_monitor->contacts.erase(*c_ptr);
-				}
+	b2WorldManifold worldManifold;
+	bool has_world_manifold = false;
+	// Measured the same way as the impact report's peak speed. Only computed if a body has a speed threshold.
+	float impact_speed = -1.0f;
+	int passed = 0;
 
-				buffer_manifold->remove(i);
-				if (buffer_manifold->count == 0) {
-					ERR_FAIL_COND(!contact_buffer.erase(reinterpret_cast<uint64_t>(contact)));
+	for (int side = 0; side < 2; ++side) {
+		Box2DPhysicsBody *body = side == 0 ? body_a : body_b;
+		if (!body->is_contact_monitor_enabled() || !body->filters_contacts()) {
+			continue;
+		}
+		if (total_impulse < body->contact_min_impulse) {
+			continue;
+		}
+		if (body->contact_min_impact_speed > 0.0f) {
+			if (impact_speed < 0.0f) {
+				if (!has_world_manifold) {
+					contact->GetWorldManifold(&worldManifold);
+					has_world_manifold = true;
 				}
+				impact_speed = peak_approach_speed(contact, impulse, worldManifold) * B2_TO_GD;
+			}
+			if (impact_speed < body->contact_min_impact_speed) {
+				continue;
 			}
 		}
-	}
-	for (int i = 0; i < b2_maxManifoldPoints; ++i) {
-		if (state2[i] == b2PointState::b2_addState) {
-			try_buffer_contact(contact, i);
+
+		if (body->contact_pair_summary) {
+			if (!has_world_manifold) {
+				contact->GetWorldManifold(&worldManifold);
+				has_world_manifold = true;
+			}
+			accumulate_pair_summary(body, side == 0 ? body_b : body_a, worldManifold, impulse, side == 1);
+		} else {
+			passed |= 1 << side;
 		}
 	}
 
-	if (buffer_manifold) {
-		// Only handle the first PreSolve for this contact this step (don't overwrite initial impact_velocity, world_pos)
-		for (int i = 0; i < buffer_manifold->count; ++i) {
-			Box2DContactPoint *c_ptr = &buffer_manifold->points[i];
+	if (!passed) {
+		return;
+	}
 
-			if (c_ptr->solves == 0) {
-				c_ptr->solves += 1;
+	ContactBufferManifold *buffer_manifold = get_buffer_manifold(contact);
 
-				b2WorldManifold worldManifold;
+	if (!buffer_manifold) {
+		// First report of this contact. Its impact velocity is taken after the solve, rather than before it.
+		for (int i = 0; i < impulse->count; ++i) {
+			buffer_manifold = try_buffer_contact(contact, i, buffer_manifold, passed);
+		}
+		if (buffer_manifold) {
+			if (!has_world_manifold) {
 				contact->GetWorldManifold(&worldManifold);
+			}
+			for (int i = 0; i < buffer_manifold->count; ++i) {
+				Box2DContactPoint *c_ptr = contact_pool.get(buffer_manifold->points[i]);
+				ERR_CONTINUE(!c_ptr);
+				init_contact_point(contact, c_ptr, worldManifold, i);
+			}
+		}
+	} else {
+		// Already buffered for the other body. Start reporting the points this body skipped.
+		for (int i = 0; i < buffer_manifold->count; ++i) {
+			Box2DContactPoint *c_ptr = contact_pool.get(buffer_manifold->points[i]);
+			ERR_CONTINUE(!c_ptr);
 
-				Vector2 manifold_norm = Vector2(worldManifold.normal.x, worldManifold.normal.y);
-				c_ptr->normal = manifold_norm;
-
-				c_ptr->world_pos = b2_to_gd(worldManifold.points[i]);
-
-				// Reset accumulated values
-				c_ptr->normal_impulse = 0.0f;
-				c_ptr->tangent_impulse = Vector2();
-
-				b2Vec2 point = worldManifold.points[i];
-				b2Vec2 relV = contact->GetFixtureB()->GetBody()->GetLinearVelocityFromWorldPoint(point);
-				relV -= contact->GetFixtureA()->GetBody()->GetLinearVelocityFromWorldPoint(point);
-
-				c_ptr->impact_velocity = b2_to_gd(relV);
+			if ((passed & 1) && c_ptr->monitor_index_a < 0 && (int)body_a->contact_monitor->contacts.size() < body_a->max_contacts_reported) {
+				add_monitor_contact(body_a, buffer_manifold->points[i], c_ptr->monitor_index_a);
+			}
+			if ((passed & 2) && c_ptr->monitor_index_b < 0 && (int)body_b->contact_monitor->contacts.size() < body_b->max_contacts_reported) {
+				add_monitor_contact(body_b, buffer_manifold->points[i], c_ptr->monitor_index_b);
 			}
 		}
 	}
 }
 
-void Box2DWorld::PostSolve(b2Contact *contact, const b2ContactImpulse *impulse) {
-	const Box2DFixture *fnode_a = contact->GetFixtureA()->GetUserData().owner;
-	const Box2DFixture *fnode_b = contact->GetFixtureB()->GetUserData().owner;
+void Box2DWorld::accumulate_pair_summary(Box2DPhysicsBody *p_body, Box2DPhysicsBody *p_other, const b2WorldManifold &p_manifold, const b2ContactImpulse *impulse, bool p_flip) {
+	Box2DPhysicsBody::ContactMonitor *monitor = p_body->contact_monitor;
+	const ObjectID other_id = p_other->get_instance_id();
 
-	const bool monitoringA = fnode_a->body_node->is_contact_monitor_enabled();
-	const bool monitoringB = fnode_b->body_node->is_contact_monitor_enabled();
-	if (monitoringA || monitoringB) {
-		b2WorldManifold worldManifold;
-		contact->GetWorldManifold(&worldManifold);
+	uint32_t *index = monitor->pair_index.getptr(other_id);
+	if (!index) {
+		if ((int)monitor->pairs.size() >= p_body->max_contacts_reported) {
+			return;
+		}
+		if (monitor->pairs.size() == 0) {
+			summary_monitors.push_back(p_body->get_instance_id());
+		}
+		index = &monitor->pair_index.set(other_id, monitor->pairs.size())->value();
 
-		ContactBufferManifold *buffer_manifold = contact_buffer.getptr(reinterpret_cast<uint64_t>(contact));
+		Box2DContactPairSummary summary;
+		summary.body = other_id;
+		monitor->pairs.push_back(summary);
+	}
 
-		if (buffer_manifold) {
-			for (int i = 0; i < buffer_manifold->count; ++i) {
-				Box2DContactPoint *c_ptr = &buffer_manifold->points[i];
-
-				Vector2 manifold_tan = c_ptr->normal.rotated(Math_PI * 0.5);
-				// TODO test: should impulse be accumulated (relevant to TOI solve), or does Box2D accumulate them itself?
-				c_ptr->normal_impulse += impulse->normalImpulses[i];
-				c_ptr->tangent_impulse += manifold_tan * impulse->tangentImpulses[i];
-
-				// Update contacts buffered in listening nodes
-				if (monitoringA) {
-					//fnode_a->body_node->contact_monitor.locked = true; TODO
-					auto contacts = &fnode_a->body_node->contact_monitor->contacts;
-					int idx = contacts->find(*c_ptr);
-					if (idx >= 0)
-						(*contacts)[idx] = (*c_ptr);
-					//fnode_a->body_node->contact_monitor.locked = false;
-				}
-				if (monitoringB) {
-					// Invert contact so A is always owned by the monitor
-					Box2DContactPoint cB = c_ptr->flipped_a_b();
-
-					//fnode_b->body_node->contact_monitor.locked = true; TODO
-					auto contacts = &fnode_b->body_node->contact_monitor->contacts;
-					int idx = contacts->find(cB);
-					if (idx >= 0)
-						(*contacts)[idx] = (cB);
-					//fnode_b->body_node->contact_monitor.locked = false;
-				}
-			}
-		}
+	Box2DContactPairSummary &summary = monitor->pairs[*index];
+	const Vector2 normal = Vector2(p_manifold.normal.x, p_manifold.normal.y);
+	for (int i = 0; i < impulse->count; ++i) {
+		summary.total_impulse += impulse->normalImpulses[i];
+		summary.max_impulse = MAX(summary.max_impulse, impulse->normalImpulses[i]);
+		summary.point_sum += b2_to_gd(p_manifold.points[i]);
+	}
+	summary.normal_sum += (p_flip ? -normal : normal) * impulse->count;
+	summary.point_count += impulse->count;
+
+	mark_contact_monitor_dirty(p_body);
+}
+
+void Box2DWorld::accumulate_impacts(b2Contact *contact, const b2ContactImpulse *impulse, Box2DPhysicsBody *body_a, Box2DPhysicsBody *body_b) {
+	const b2Body *b2_a = contact->GetFixtureA()->GetBody();
+	const b2Body *b2_b = contact->GetFixtureB()->GetBody();
+
+	b2WorldManifold worldManifold;
+	contact->GetWorldManifold(&worldManifold);
+	const b2Vec2 &normal = worldManifold.normal;
+
+	float total_impulse = 0.0f;
+	float peak_impulse = 0.0f;
+	float peak_speed = 0.0f;
+	float energy_lost = 0.0f;
+
+	for (int i = 0; i < impulse->count; ++i) {
+		const float p = impulse->normalImpulses[i];
+		const b2Vec2 &point = worldManifold.points[i];
+
+		float vn_before, vn_after;
+		solve_normal_velocities(b2_a, b2_b, point, normal, p, vn_before, vn_after);
+
+		total_impulse += p;
+		peak_impulse = MAX(peak_impulse, p);
+		peak_speed = MAX(peak_speed, -vn_before);
+		// Work done against the impulse, which is the kinetic energy it removed
+		energy_lost += MAX(0.0f, -p * (vn_before + vn_after) * 0.5f);
+	}
+	peak_speed *= B2_TO_GD;
+
+	if (body_a->impact_tracking) {
+		add_impact(body_a, body_b, total_impulse, peak_impulse, peak_speed, energy_lost);
+	}
+	if (body_b->impact_tracking) {
+		add_impact(body_b, body_a, total_impulse, peak_impulse, peak_speed, energy_lost);
+	}
+}
+
+inline void Box2DWorld::add_impact(Box2DPhysicsBody *p_body, const Box2DPhysicsBody *p_other, float p_impulse, float p_peak_impulse, float p_peak_speed, float p_energy_lost) {
+	Box2DPhysicsBody::ImpactReport &impact = p_body->impact;
+	if (impact.epoch != step_epoch) {
+		impact = Box2DPhysicsBody::ImpactReport();
+		impact.epoch = step_epoch;
+		impacted_bodies.push_back(p_body->get_instance_id());
+	}
+
+	impact.total_impulse += p_impulse;
+	if (p_peak_impulse > impact.peak_impulse) {
+		impact.peak_impulse = p_peak_impulse;
+		impact.peak_body = p_other->get_instance_id();
+	}
+	impact.peak_impact_speed = MAX(impact.peak_impact_speed, p_peak_speed);
+	impact.energy_lost += p_energy_lost;
+}
+
+void Box2DWorld::deliver_impacts() {
+	// The previous step's reports expire, even for bodies that weren't hit this step
+	for (uint32_t i = 0; i < reported_impact_bodies.size(); ++i) {
+		Box2DPhysicsBody *body_node = Object::cast_to<Box2DPhysicsBody>(ObjectDB::get_instance(reported_impact_bodies[i]));
+		if (body_node) {
+			body_node->reported_impact = Box2DPhysicsBody::ImpactReport();
+		}
+	}
+	reported_impact_bodies.clear();
+
+	for (uint32_t i = 0; i < impacted_bodies.size(); ++i) {
+		Box2DPhysicsBody *body_node = Object::cast_to<Box2DPhysicsBody>(ObjectDB::get_instance(impacted_bodies[i]));
+		if (body_node) {
+			body_node->reported_impact = body_node->impact;
+			reported_impact_bodies.push_back(impacted_bodies[i]);
+		}
+	}
+	impacted_bodies.clear();
+
+	// Emitted once every report is in place, so handlers can read any body's impact
+	for (uint32_t i = 0; i < reported_impact_bodies.size(); ++i) {
+		Box2DPhysicsBody *body_node = Object::cast_to<Box2DPhysicsBody>(ObjectDB::get_instance(reported_impact_bodies[i]));
+		if (body_node && body_node->impact_signal_threshold > 0.0f && body_node->reported_impact.peak_impulse >= body_node->impact_signal_threshold) {
+			body_node->emit_signal(B2SN->impact, ObjectDB::get_instance(body_node->reported_impact.peak_body), body_node->reported_impact.peak_impulse);
+		}
+	}
+}
+
+void Box2DWorld::clear_pair_summaries() {
+	for (uint32_t i = 0; i < summary_monitors.size(); ++i) {
+		Box2DPhysicsBody *body_node = Object::cast_to<Box2DPhysicsBody>(ObjectDB::get_instance(summary_monitors[i]));
+		if (body_node && body_node->contact_monitor) {
+			body_node->contact_monitor->pairs.clear();
+			body_node->contact_monitor->pair_index.clear();
+			mark_contact_monitor_dirty(body_node);
+		}
+	}
+	summary_monitors.clear();
+}
+
+_FORCE_INLINE_ ContactBufferManifold *Box2DWorld::get_buffer_manifold(const b2Contact *contact) {
+	const uint32_t index = contact->GetUserData().buffer_index;
+	return index ? &contact_buffer[index - 1] : NULL;
+}
+
+ContactBufferManifold *Box2DWorld::create_buffer_manifold(b2Contact *contact) {
+	ERR_FAIL_COND_V(contact->GetUserData().buffer_index, get_buffer_manifold(contact));
+
+	contact_buffer.push_back(ContactBufferManifold());
+	contact_buffer[contact_buffer.size() - 1].contact = contact;
+	contact->GetUserData().buffer_index = contact_buffer.size();
+	return &contact_buffer[contact_buffer.size() - 1];
+}
+
+void Box2DWorld::erase_buffer_manifold(b2Contact *contact) {
+	const uint32_t index = contact->GetUserData().buffer_index - 1;
+	ERR_FAIL_COND(index >= contact_buffer.size());
+
+	// Move the last manifold into the hole
+	const uint32_t last = contact_buffer.size() - 1;
+	if (index != last) {
+		contact_buffer[index] = contact_buffer[last];
+		contact_buffer[index].contact->GetUserData().buffer_index = index + 1;
+	}
+	contact_buffer.resize(last);
+	contact->GetUserData().buffer_index = 0;
+}
+
+inline void Box2DWorld::add_monitor_contact(Box2DPhysicsBody *p_body, const Box2DContactHandle &p_handle, int32_t &r_monitor_index) {
+	LocalVector<Box2DContactHandle> &contacts = p_body->contact_monitor->contacts;
+	r_monitor_index = contacts.size();
+	contacts.push_back(p_handle);
+	mark_contact_monitor_dirty(p_body);
+}
+
+void Box2DWorld::remove_monitor_contact(Box2DPhysicsBody *p_body, int32_t p_monitor_index) {
+	// Swap-remove, then point the moved contact at its new index
+	LocalVector<Box2DContactHandle> &contacts = p_body->contact_monitor->contacts;
+	const int32_t last = contacts.size() - 1;
+	ERR_FAIL_INDEX(p_monitor_index, (int32_t)contacts.size());
+
+	if (p_monitor_index != last) {
+		contacts[p_monitor_index] = contacts[last];
+		Box2DContactPoint *moved = contact_pool.get(contacts[p_monitor_index]);
+		if (moved) {
+			if (moved->fixture_a->body_node == p_body) {
+				moved->monitor_index_a = p_monitor_index;
+			} else {
+				moved->monitor_index_b = p_monitor_index;
+			}
+		}
+	}
+	contacts.resize(last);
+	mark_contact_monitor_dirty(p_body);
+}
+
+void Box2DWorld::release_contact(const Box2DContactHandle &p_handle) {
+	Box2DContactPoint *c = contact_pool.get(p_handle);
+	ERR_FAIL_COND(!c);
+
+	if (c->monitor_index_a >= 0) {
+		remove_monitor_contact(c->fixture_a->body_node, c->monitor_index_a);
+	}
+	if (c->monitor_index_b >= 0) {
+		remove_monitor_contact(c->fixture_b->body_node, c->monitor_index_b);
+	}
+	contact_pool.free(p_handle);
+}
+
+void Box2DWorld::detach_contact_monitor(Box2DPhysicsBody *p_body) {
+	// Called before a contact monitor is deleted. The buffered contacts stay in the pool while the other body reports them.
+	LocalVector<Box2DContactHandle> &contacts = p_body->contact_monitor->contacts;
+	for (uint32_t i = 0; i < contacts.size(); ++i) {
+		Box2DContactPoint *c = contact_pool.get(contacts[i]);
+		if (c) {
+			if (c->fixture_a->body_node == p_body) {
+				c->monitor_index_a = -1;
+			} else {
+				c->monitor_index_b = -1;
+			}
+		}
+	}
+	contacts.clear();
+}
+
+Box2DContactPoint Box2DWorld::resolve_contact(const Box2DContactHandle &p_handle, const Box2DPhysicsBody *p_body) const {
+	const Box2DContactPoint *c = contact_pool.get(p_handle);
+	ERR_FAIL_COND_V(!c, Box2DContactPoint());
+	return c->fixture_a->body_node == p_body ? *c : c->flipped_a_b();
+}
+
+inline void Box2DWorld::track_contact_woken_body(Box2DPhysicsBody *p_body) {
+	if (is_stepping_on_worker()) {
+		// On the worker thread. Track it after the step.
+		if (p_body->awake_index < 0) {
+			contact_woken_bodies.push_back(p_body);
+		}
+	} else {
+		track_awake_body(p_body);
+	}
+}
+
+void Box2DWorld::emit_contact_signal(ContactSignal::Type p_type, Box2DPhysicsBody *p_emitter, Object *p_other, Object *p_local_fixture) {
+	if (world->IsLocked()) {
+		// Inside b2World::Step, possibly on a worker thread. Handlers would run while the world is locked,
+		// so queue the signal and emit it after the step.
+		ContactSignal sig;
+		sig.type = p_type;
+		sig.emitter = p_emitter->get_instance_id();
+		sig.other = p_other->get_instance_id();
+		sig.local_fixture = p_local_fixture ? p_local_fixture->get_instance_id() : ObjectID();
+		deferred_contact_signals.push_back(sig);
+		return;
+	}
+
+	switch (p_type) {
+		case ContactSignal::BODY_ENTERED: {
+			p_emitter->emit_signal(B2SN->body_entered, p_other);
+		} break;
+		case ContactSignal::BODY_EXITED: {
+			p_emitter->emit_signal(B2SN->body_exited, p_other);
+		} break;
+		case ContactSignal::FIXTURE_ENTERED: {
+			p_emitter->emit_signal(B2SN->body_fixture_entered, p_other, p_local_fixture);
+		} break;
+		case ContactSignal::FIXTURE_EXITED: {
+			p_emitter->emit_signal(B2SN->body_fixture_exited, p_other, p_local_fixture);
+		} break;
+	}
+}
+
+void Box2DWorld::flush_contact_signals() {
+	// Handlers may free nodes, so everything is looked up by ID. Signals for freed nodes are dropped.
+	// Moved out first, since a handler that steps the world adds to the queue and flushes it again.
+	LocalVector<ContactSignal> signals;
+	SWAP(signals, deferred_contact_signals);
+	for (uint32_t i = 0; i < signals.size(); ++i) {
+		const ContactSignal &sig = signals[i];
+		Box2DPhysicsBody *emitter = Object::cast_to<Box2DPhysicsBody>(ObjectDB::get_instance(sig.emitter));
+		Object *other = ObjectDB::get_instance(sig.other);
+		Object *local_fixture = ObjectDB::get_instance(sig.local_fixture);
+		if (!emitter || !other || (sig.local_fixture.is_valid() && !local_fixture)) {
+			continue;
+		}
+		emit_contact_signal(sig.type, emitter, other, local_fixture);
+	}
+}
+
+inline void Box2DWorld::record_contact_event(ContactEventType p_type, b2Contact *contact, const b2ContactImpulse *impulse) {
+	ContactEvent ev;
+	ev.type = p_type;
+	ev.fixture_a = contact->GetFixtureA()->GetUserData().owner->get_instance_id();
+	ev.fixture_b = contact->GetFixtureB()->GetUserData().owner->get_instance_id();
+
+	// Sensors and separated contacts have no manifold points. Their events carry only the fixtures.
+	const int point_count = contact->GetManifold()->pointCount;
+	if (point_count > 0) {
+		b2WorldManifold worldManifold;
+		contact->GetWorldManifold(&worldManifold);
+
+		b2Vec2 point = worldManifold.points[0];
+		if (point_count > 1) {
+			point = 0.5f * (worldManifold.points[0] + worldManifold.points[1]);
+		}
+		ev.point = b2_to_gd(point);
+		ev.normal = Vector2(worldManifold.normal.x, worldManifold.normal.y);
+
+		b2Vec2 relV = contact->GetFixtureB()->GetBody()->GetLinearVelocityFromWorldPoint(point);
+		relV -= contact->GetFixtureA()->GetBody()->GetLinearVelocityFromWorldPoint(point);
+		ev.impact_velocity = b2_to_gd(relV);
+
+		if (impulse) {
+			for (int i = 0; i < impulse->count; ++i) {
+				ev.normal_impulse += impulse->normalImpulses[i];
+			}
+		}
+	}
+
+	contact_events.push_back(ev);
+}
+
+void Box2DWorld::publish_contact_events() {
+	const int offset = contact_events_accumulate ? published_event_types.size() : 0;
+	const int count = offset + contact_events.size();
+
+	published_event_types.resize(count);
+	published_event_fixtures_a.resize(count);
+	published_event_fixtures_b.resize(count);
+	published_event_points.resize(count);
+	published_event_normals.resize(count);
+	published_event_impact_velocities.resize(count);
+	published_event_normal_impulses.resize(count);
+
+	if (contact_events.size() > 0) {
+		int32_t *types = published_event_types.ptrw();
+		int64_t *fixtures_a = published_event_fixtures_a.ptrw();
+		int64_t *fixtures_b = published_event_fixtures_b.ptrw();
+		Vector2 *points = published_event_points.ptrw();
+		Vector2 *normals = published_event_normals.ptrw();
+		Vector2 *impact_velocities = published_event_impact_velocities.ptrw();
+		float *normal_impulses = published_event_normal_impulses.ptrw();
+
+		for (uint32_t i = 0; i < contact_events.size(); ++i) {
+			const ContactEvent &ev = contact_events[i];
+			const int idx = offset + i;
+			types[idx] = ev.type;
+			fixtures_a[idx] = (int64_t)(uint64_t)ev.fixture_a;
+			fixtures_b[idx] = (int64_t)(uint64_t)ev.fixture_b;
+			points[idx] = ev.point;
+			normals[idx] = ev.normal;
+			impact_velocities[idx] = ev.impact_velocity;
+			normal_impulses[idx] = ev.normal_impulse;
+		}
+	}
+
+	contact_events.clear();
+}
+
+void Box2DWorld::clear_published_contact_events() {
+	published_event_types.clear();
+	published_event_fixtures_a.clear();
+	published_event_fixtures_b.clear();
+	published_event_points.clear();
+	published_event_normals.clear();
+	published_event_impact_velocities.clear();
+	published_event_normal_impulses.clear();
+}
+
+void Box2DWorld::mark_contact_monitor_dirty(Box2DPhysicsBody *p_body) {
+	if (async_step && !p_body->contact_monitor->dirty) {
+		p_body->contact_monitor->dirty = true;
+		dirty_contact_monitors.push_back(p_body->get_instance_id());
+	}
+}
+
+void Box2DWorld::publish_contact_monitors() {
+	for (uint32_t i = 0; i < dirty_contact_monitors.size(); ++i) {
+		Box2DPhysicsBody *body_node = Object::cast_to<Box2DPhysicsBody>(ObjectDB::get_instance(dirty_contact_monitors[i]));
+		if (body_node && body_node->contact_monitor && body_node->contact_monitor->dirty) {
+			Box2DPhysicsBody::ContactMonitor *monitor = body_node->contact_monitor;
+			// The pool keeps changing during the step, so the contacts are resolved into a copy
+			monitor->published_contacts.resize(monitor->contacts.size());
+			for (uint32_t j = 0; j < monitor->contacts.size(); ++j) {
+				monitor->published_contacts[j] = resolve_contact(monitor->contacts[j], body_node);
+			}
+			monitor->published_pairs = monitor->pairs;
+			monitor->published_entered_objects = monitor->entered_objects;
+			monitor->dirty = false;
+		}
+	}
+	dirty_contact_monitors.clear();
+}
+
+void Box2DWorld::publish_body_state() {
+	// Sleeping bodies have no velocity, and their published values were zeroed when they fell asleep
+	for (uint32_t i = 0; i < awake_bodies.size(); ++i) {
+		Box2DPhysicsBody *body_node = awake_bodies[i];
+		body_node->published_linear_velocity = body_node->body->GetLinearVelocity();
+		body_node->published_angular_velocity = body_node->body->GetAngularVelocity();
+	}
+}
+
+void Box2DWorld::queue_command(const Box2DBodyCommand &p_command) {
+	command_queue.push_back(p_command);
+}
+
+void Box2DWorld::apply_command(const Box2DBodyCommand &p_command) {
+	Box2DPhysicsBody *body_node = p_command.body;
+	b2Body *b = body_node->body;
+	ERR_FAIL_COND(!b);
+
+	switch (p_command.type) {
+		case Box2DBodyCommand::SET_TRANSFORM: {
+			b->SetTransform(p_command.vector, p_command.scalar);
+			body_node->last_synced_b2_xform = b->GetTransform();
+			return; // Doesn't wake the body
+		} break;
+		case Box2DBodyCommand::SET_LINEAR_VELOCITY: {
+			b->SetLinearVelocity(p_command.vector);
+		} break;
+		case Box2DBodyCommand::SET_ANGULAR_VELOCITY: {
+			b->SetAngularVelocity(p_command.scalar);
+		} break;
+		case Box2DBodyCommand::APPLY_FORCE: {
+			b->ApplyForce(p_command.vector, p_command.point, p_command.wake);
+		} break;
+		case Box2DBodyCommand::APPLY_FORCE_TO_CENTER: {
+			b->ApplyForceToCenter(p_command.vector, p_command.wake);
+		} break;
+		case Box2DBodyCommand::APPLY_TORQUE: {
+			b->ApplyTorque(p_command.scalar, p_command.wake);
+		} break;
+		case Box2DBodyCommand::APPLY_LINEAR_IMPULSE: {
+			b->ApplyLinearImpulse(p_command.vector, p_command.point, p_command.wake);
+		} break;
+		case Box2DBodyCommand::APPLY_LINEAR_IMPULSE_TO_CENTER: {
+			b->ApplyLinearImpulseToCenter(p_command.vector, p_command.wake);
+		} break;
+		case Box2DBodyCommand::APPLY_ANGULAR_IMPULSE: {
+			b->ApplyAngularImpulse(p_command.scalar, p_command.wake);
+		} break;
+	}
+	track_awake_body(body_node);
+}
+
+void Box2DWorld::BeginContact(b2Contact *contact) {
+	Box2DFixture *fnode_a = contact->GetFixtureA()->GetUserData().owner;
+	Box2DFixture *fnode_b = contact->GetFixtureB()->GetUserData().owner;
+	Box2DPhysicsBody *body_a = fnode_a->body_node;
+	Box2DPhysicsBody *body_b = fnode_b->body_node;
+
+	// Box2D wakes both bodies when a contact starts touching
+	track_contact_woken_body(body_a);
+	track_contact_woken_body(body_b);
+
+	if (contact_events_enabled) {
+		record_contact_event(CONTACT_EVENT_BEGIN, contact);
+	}
+
+	const bool monitoringA = fnode_a->body_node->is_contact_monitor_enabled();
+	const bool monitoringB = fnode_b->body_node->is_contact_monitor_enabled();
+
+	// Deliver signals to bodies with monitoring enabled
+	// Only emit body_entered once per body. Begin/EndContact are called for each *fixture*.
+	// Similar case for fixtures. One Box2DFixture may have several b2Fixtures.
+	if (monitoringA) {
+		mark_contact_monitor_dirty(body_a);
+
+		int *body_count_ptr = body_a->contact_monitor->entered_objects.getptr(body_b->get_instance_id());
+		if (!body_count_ptr) {
+			body_count_ptr = &(body_a->contact_monitor->entered_objects.set(body_b->get_instance_id(), 0)->value());
+		}
+		++(*body_count_ptr);
+
+		if (*body_count_ptr == 1) {
+			emit_contact_signal(ContactSignal::BODY_ENTERED, body_a, body_b);
+		}
+
+		if (body_a->fixture_signals) {
+			int *fix_count_ptr = body_a->contact_monitor->entered_objects.getptr(fnode_b->get_instance_id());
+			if (!fix_count_ptr) {
+				fix_count_ptr = &(body_a->contact_monitor->entered_objects.set(fnode_b->get_instance_id(), 0)->value());
+			}
+			++(*fix_count_ptr);
+
+			if (*fix_count_ptr == 1) {
+				emit_contact_signal(ContactSignal::FIXTURE_ENTERED, body_a, fnode_b, fnode_a);
+			}
+		}
+	}
+	if (monitoringB) {
+		mark_contact_monitor_dirty(body_b);
+
+		int *body_count_ptr = body_b->contact_monitor->entered_objects.getptr(body_a->get_instance_id());
+		if (!body_count_ptr) {
+			body_count_ptr = &(body_b->contact_monitor->entered_objects.set(body_a->get_instance_id(), 0)->value());
+		}
+		++(*body_count_ptr);
+
+		if (*body_count_ptr == 1) {
+			emit_contact_signal(ContactSignal::BODY_ENTERED, body_b, body_a);
+		}
+
+		if (body_b->fixture_signals) {
+			int *fix_count_ptr = body_b->contact_monitor->entered_objects.getptr(fnode_a->get_instance_id());
+			if (!fix_count_ptr) {
+				fix_count_ptr = &(body_b->contact_monitor->entered_objects.set(fnode_a->get_instance_id(), 0)->value());
+			}
+			++(*fix_count_ptr);
+
+			if (*fix_count_ptr == 1) {
+				emit_contact_signal(ContactSignal::FIXTURE_ENTERED, body_b, fnode_a, fnode_b);
+			}
+		}
+	}
+}
+
+void Box2DWorld::EndContact(b2Contact *contact) {
+	Box2DFixture *fnode_a = contact->GetFixtureA()->GetUserData().owner;
+	Box2DFixture *fnode_b = contact->GetFixtureB()->GetUserData().owner;
+	Box2DPhysicsBody *body_a = fnode_a->body_node;
+	Box2DPhysicsBody *body_b = fnode_b->body_node;
+
+	// Box2D wakes both bodies when a contact stops touching
+	track_contact_woken_body(body_a);
+	track_contact_woken_body(body_b);
+
+	if (contact_events_enabled) {
+		record_contact_event(CONTACT_EVENT_END, contact);
+	}
+
+	const bool monitoringA = fnode_a->body_node->is_contact_monitor_enabled();
+	const bool monitoringB = fnode_b->body_node->is_contact_monitor_enabled();
+
+	// Deliver signals to bodies with contact monitoring enabled
+	if (monitoringA) {
+		mark_contact_monitor_dirty(body_a);
+
+		int *body_count_ptr = body_a->contact_monitor->entered_objects.getptr(body_b->get_instance_id());
+		--(*body_count_ptr);
+
+		if ((*body_count_ptr) == 0) {
+			body_a->contact_monitor->entered_objects.erase(body_b->get_instance_id());
+			emit_contact_signal(ContactSignal::BODY_EXITED, body_a, body_b);
+		}
+
+		// Fixture counts are missing if fixture signals were off when the contact began
+		int *fix_count_ptr = body_a->fixture_signals ? body_a->contact_monitor->entered_objects.getptr(fnode_b->get_instance_id()) : NULL;
+		if (fix_count_ptr && --(*fix_count_ptr) == 0) {
+			body_a->contact_monitor->entered_objects.erase(fnode_b->get_instance_id());
+			emit_contact_signal(ContactSignal::FIXTURE_EXITED, body_a, fnode_b, fnode_a);
+		}
+	}
+	if (monitoringB) {
+		mark_contact_monitor_dirty(body_b);
+
+		int *body_count_ptr = body_b->contact_monitor->entered_objects.getptr(body_a->get_instance_id());
+		--(*body_count_ptr);
+
+		if ((*body_count_ptr) == 0) {
+			body_b->contact_monitor->entered_objects.erase(body_a->get_instance_id());
+			emit_contact_signal(ContactSignal::BODY_EXITED, body_b, body_a);
+		}
+
+		// Fixture counts are missing if fixture signals were off when the contact began
+		int *fix_count_ptr = body_b->fixture_signals ? body_b->contact_monitor->entered_objects.getptr(fnode_a->get_instance_id()) : NULL;
+		if (fix_count_ptr && --(*fix_count_ptr) == 0) {
+			body_b->contact_monitor->entered_objects.erase(fnode_a->get_instance_id());
+			emit_contact_signal(ContactSignal::FIXTURE_EXITED, body_b, fnode_a, fnode_b);
+		}
+	}
+
+	// Clean up all buffered contacts in the manifold
+	ContactBufferManifold *buffer_manifold = get_buffer_manifold(contact);
+
+	if (buffer_manifold) {
+		for (int i = 0; i < buffer_manifold->count; ++i) {
+			release_contact(buffer_manifold->points[i]);
+		}
+
+		erase_buffer_manifold(contact);
+	}
+}
+
+static _FORCE_INLINE_ float mix_surface_value(int p_mode, float p_a, float p_b, float p_default) {
+	switch (p_mode) {
+		case Box2DFixture::MIX_AVERAGE:
+			return (p_a + p_b) * 0.5f;
+		case Box2DFixture::MIX_MIN:
+			return MIN(p_a, p_b);
+		case Box2DFixture::MIX_MULTIPLY:
+			return p_a * p_b;
+		case Box2DFixture::MIX_MAX:
+			return MAX(p_a, p_b);
+		default:
+			return p_default;
+	}
+}
+
+inline void Box2DWorld::apply_surface_material(b2Contact *contact) const {
+	const b2Fixture *fixtureA = contact->GetFixtureA();
+	const b2Fixture *fixtureB = contact->GetFixtureB();
+	const b2FixtureUserData &dataA = fixtureA->GetUserData();
+	const b2FixtureUserData &dataB = fixtureB->GetUserData();
+
+	// The solver drives dot(vB - vA, cross(normal, 1)) to the tangent speed. Flipping A and B flips both
+	// the normal and the relative velocity, so each fixture's speed contributes with the same sign.
+	contact->SetTangentSpeed(-(dataA.surface_speed + dataB.surface_speed) * GD_TO_B2);
+
+	const float frictionA = fixtureA->GetFriction();
+	const float frictionB = fixtureB->GetFriction();
+	contact->SetFriction(mix_surface_value(MAX(dataA.friction_mix, dataB.friction_mix), frictionA, frictionB, b2MixFriction(frictionA, frictionB)));
+
+	const float restitutionA = fixtureA->GetRestitution();
+	const float restitutionB = fixtureB->GetRestitution();
+	contact->SetRestitution(mix_surface_value(MAX(dataA.restitution_mix, dataB.restitution_mix), restitutionA, restitutionB, b2MixRestitution(restitutionA, restitutionB)));
+}
+
+inline bool Box2DWorld::passes_one_way(b2Contact *contact, const b2WorldManifold &p_manifold, const b2Fixture *p_platform, const b2Fixture *p_other, bool p_platform_is_a) const {
+	if (p_other->GetBody()->GetUserData().owner->one_way_drop_through) {
+		return true;
+	}
+
+	const b2FixtureUserData &data = p_platform->GetUserData();
+	const b2Body *platform_body = p_platform->GetBody();
+	const b2Vec2 up = b2Mul(platform_body->GetTransform().q, b2Vec2(data.one_way_normal_x, data.one_way_normal_y));
+
+	// The manifold normal points from A to B
+	const b2Vec2 normal = p_platform_is_a ? p_manifold.normal : -p_manifold.normal;
+	if (b2Dot(normal, up) <= 0.0f) {
+		return true; // Touching the platform from below or the side
+	}
+
+	// Anything deeper than the margin came in from the wrong side. A falling body can sink an extra
+	// step's worth of its approach speed before the contact is seen, so that much is still a landing.
+	const int point_count = contact->GetManifold()->pointCount;
+	for (int i = 0; i < point_count; ++i) {
+		const b2Vec2 &point = p_manifold.points[i];
+		const b2Vec2 relV = p_other->GetBody()->GetLinearVelocityFromWorldPoint(point) - platform_body->GetLinearVelocityFromWorldPoint(point);
+		const float allowed_depth = data.one_way_margin + MAX(-b2Dot(relV, up), 0.0f) * last_step_delta;
+		if (-p_manifold.separations[i] > allowed_depth) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void Box2DWorld::skip_contact_solve(b2Contact *contact) {
+	contact->SetEnabled(false);
+	contact->GetUserData().solve_skipped = true;
+
+	ContactBufferManifold *buffer_manifold = get_buffer_manifold(contact);
+	if (buffer_manifold) {
+		for (int i = 0; i < buffer_manifold->count; ++i) {
+			release_contact(buffer_manifold->points[i]);
+		}
+		erase_buffer_manifold(contact);
+	}
+}
+
+void Box2DWorld::PreSolve(b2Contact *contact, const b2Manifold *oldManifold) {
+	// Box2D re-enables every contact before PreSolve, so this runs each step.
+	// Like real sensors, these contacts begin and end but aren't solved or buffered.
+	if (rule_table.size() > 0 && get_contact_rule(contact->GetFixtureA(), contact->GetFixtureB()) == Box2DCollisionRules::RULE_SENSOR_ONLY) {
+		skip_contact_solve(contact);
+		return;
+	}
+
+	const b2Fixture *fixtureA = contact->GetFixtureA();
+	const b2Fixture *fixtureB = contact->GetFixtureB();
+	if (unlikely(fixtureA->GetUserData().one_way || fixtureB->GetUserData().one_way)) {
+		b2WorldManifold worldManifold;
+		contact->GetWorldManifold(&worldManifold);
+		if ((fixtureA->GetUserData().one_way && passes_one_way(contact, worldManifold, fixtureA, fixtureB, true)) ||
+				(fixtureB->GetUserData().one_way && passes_one_way(contact, worldManifold, fixtureB, fixtureA, false))) {
+			skip_contact_solve(contact);
+			return;
+		}
+	}
+
+	// Every point of a contact that was skipped until now is new to the buffer
+	const bool was_skipped = contact->GetUserData().solve_skipped;
+	contact->GetUserData().solve_skipped = false;
+
+	if (unlikely(fixtureA->GetUserData().surface_material || fixtureB->GetUserData().surface_material)) {
+		apply_surface_material(contact);
+	}
+
+	Box2DFixture *fnode_a = contact->GetFixtureA()->GetUserData().owner;
+	Box2DFixture *fnode_b = contact->GetFixtureB()->GetUserData().owner;
+	Box2DPhysicsBody *body_a = fnode_a->body_node;
+	Box2DPhysicsBody *body_b = fnode_b->body_node;
+
+	// Nothing to buffer or update for contacts between unmonitored bodies
+	ContactBufferManifold *buffer_manifold = get_buffer_manifold(contact);
+	if (!buffer_manifold && !body_a->is_contact_monitor_enabled() && !body_b->is_contact_monitor_enabled()) {
+		return;
+	}
+
+	b2PointState state1[2], state2[2];
+	b2GetPointStates(state1, state2, oldManifold, contact->GetManifold());
+	if (unlikely(was_skipped)) {
+		// Nothing is buffered, so nothing persists or can be removed
+		for (int i = 0; i < b2_maxManifoldPoints; ++i) {
+			state1[i] = b2PointState::b2_nullState;
+			state2[i] = i < contact->GetManifold()->pointCount ? b2PointState::b2_addState : b2PointState::b2_nullState;
+		}
+	}
+
+	if (unlikely(flag_rescan_contacts_monitored) && !buffer_manifold) {
+		// Buffer a contact that only started being monitored after it transitioned from b2_addState
+		for (int i = 0; i < b2_maxManifoldPoints; ++i) {
+			if (state1[i] == b2PointState::b2_persistState) {
+				buffer_manifold = try_buffer_contact(contact, i, buffer_manifold);
+			}
+		}
+	}
+
+	// Handle removed/added points within the manifold
+	for (int i = b2_maxManifoldPoints - 1; i >= 0; --i) {
+		if (state1[i] == b2PointState::b2_removeState) {
+			// Remove this contact
+			if (buffer_manifold && i < buffer_manifold->count) {
+				release_contact(buffer_manifold->points[i]);
+
+				buffer_manifold->remove(i);
+				if (buffer_manifold->count == 0) {
+					erase_buffer_manifold(contact);
+					buffer_manifold = NULL;
+				}
+			}
+		}
+	}
+	for (int i = 0; i < b2_maxManifoldPoints; ++i) {
+		if (state2[i] == b2PointState::b2_addState) {
+			buffer_manifold = try_buffer_contact(contact, i, buffer_manifold);
+		}
+	}
+
+	if (buffer_manifold) {
+		// Only handle the first PreSolve for this contact this step (don't overwrite initial impact_velocity, world_pos)
+		b2WorldManifold worldManifold;
+		bool has_world_manifold = false;
+		for (int i = 0; i < buffer_manifold->count; ++i) {
+			Box2DContactPoint *c_ptr = contact_pool.get(buffer_manifold->points[i]);
+			ERR_CONTINUE(!c_ptr);
+
+			if (c_ptr->solve_epoch != step_epoch) {
+				if (!has_world_manifold) {
+					contact->GetWorldManifold(&worldManifold);
+					has_world_manifold = true;
+				}
+				init_contact_point(contact, c_ptr, worldManifold, i);
+			}
+		}
+	}
+}
+
+void Box2DWorld::PostSolve(b2Contact *contact, const b2ContactImpulse *impulse) {
+	const Box2DFixture *fnode_a = contact->GetFixtureA()->GetUserData().owner;
+	const Box2DFixture *fnode_b = contact->GetFixtureB()->GetUserData().owner;
+
+	if (contact_events_enabled) {
+		record_contact_event(CONTACT_EVENT_POST_SOLVE, contact, impulse);
+	}
+
+	Box2DPhysicsBody *body_a = fnode_a->body_node;
+	Box2DPhysicsBody *body_b = fnode_b->body_node;
+
+	if (unlikely(body_a->impact_tracking || body_b->impact_tracking)) {
+		accumulate_impacts(contact, impulse, body_a, body_b);
+	}
+
+	const bool monitoringA = body_a->is_contact_monitor_enabled();
+	const bool monitoringB = body_b->is_contact_monitor_enabled();
+	if (!monitoringA && !monitoringB) {
+		return;
+	}
+
+	// Thresholded and summarizing monitors judge the contact by this solve's impulses
+	if (unlikely((monitoringA && body_a->filters_contacts()) || (monitoringB && body_b->filters_contacts()))) {
+		report_filtered_contact(contact, impulse, body_a, body_b);
+	}
+
+	ContactBufferManifold *buffer_manifold = get_buffer_manifold(contact);
+
+	if (buffer_manifold) {
+		for (int i = 0; i < buffer_manifold->count; ++i) {
+			Box2DContactPoint *c_ptr = contact_pool.get(buffer_manifold->points[i]);
+			ERR_CONTINUE(!c_ptr);
+
+			Vector2 manifold_tan = c_ptr->normal.rotated(Math_PI * 0.5);
+			// TODO test: should impulse be accumulated (relevant to TOI solve), or does Box2D accumulate them itself?
+			c_ptr->normal_impulse += impulse->normalImpulses[i];
+			c_ptr->tangent_impulse += manifold_tan * impulse->tangentImpulses[i];
+
+			// Monitors read the pooled contact directly, so only the published copies need refreshing
+			if (c_ptr->monitor_index_a >= 0) {
+				mark_contact_monitor_dirty(body_a);
+			}
+			if (c_ptr->monitor_index_b >= 0) {
+				mark_contact_monitor_dirty(body_b);
+			}
+		}
+	}
+}
+
+void Box2DWorld::track_awake_body(Box2DPhysicsBody *p_body) {
+	if (p_body->awake_index < 0 && p_body->body && p_body->body->IsAwake()) {
+		p_body->awake_index = awake_bodies.size();
+		awake_bodies.push_back(p_body);
+
+		if (is_interpolating()) {
+			p_body->interp_curr_xform = b2_to_gd(p_body->body->GetTransform());
+			p_body->interp_prev_xform = p_body->interp_curr_xform;
+		}
+	}
+}
+
+void Box2DWorld::untrack_awake_body(Box2DPhysicsBody *p_body) {
+	const int idx = p_body->awake_index;
+	if (idx < 0) {
+		return;
+	}
+	ERR_FAIL_COND(awake_bodies[idx] != p_body);
+
+	// Swap-remove. Order doesn't matter.
+	Box2DPhysicsBody *last = awake_bodies[awake_bodies.size() - 1];
+	awake_bodies[idx] = last;
+	last->awake_index = idx;
+	awake_bodies.resize(awake_bodies.size() - 1);
+	p_body->awake_index = -1;
+}
+
+void Box2DWorld::untrack_destroyed_body(Box2DPhysicsBody *p_body) {
+	untrack_awake_body(p_body);
+
+	// A body can be queued more than once during a step
+	for (int64_t i = contact_woken_bodies.size() - 1; i >= 0; --i) {
+		if (contact_woken_bodies[i] == p_body) {
+			contact_woken_bodies.remove(i);
+		}
+	}
+}
+
+void Box2DWorld::sync_awake_bodies() {
+	// The list grows while we walk it. Box2D wakes sleeping bodies during island solving when they
+	// touch or are jointed to an awake body, and those wakes don't pass through any callback.
+	// Scanning the neighbors of each awake body finds them, and keeps this loop proportional to the
+	// number of moving bodies rather than the number of bodies in the world.
+	// Signals are emitted after the walk, since user code may add or remove bodies.
+	LocalVector<ObjectID> sleep_state_changed;
+
+	uint32_t i = 0;
+	while (i < awake_bodies.size()) {
+		Box2DPhysicsBody *body_node = awake_bodies[i];
+		b2Body *b = body_node->body;
+
+		if (!b->IsAwake()) {
+			if (is_interpolating()) {
+				// Land exactly on the resting pose, since this body won't be interpolated anymore
+				body_node->state_changed();
+			}
+			untrack_awake_body(body_node);
+			body_node->published_linear_velocity = b2Vec2_zero;
+			body_node->published_angular_velocity = 0.0f;
+			if (body_node->prev_sleeping_state) {
+				body_node->prev_sleeping_state = false;
+				sleep_state_changed.push_back(body_node->get_instance_id());
+			}
+			continue; // Another body was swapped into this slot
+		}
+
+		for (b2ContactEdge *ce = b->GetContactList(); ce; ce = ce->next) {
+			if (ce->contact->IsTouching()) {
+				track_awake_body(ce->other->GetUserData().owner);
+			}
+		}
+		for (b2JointEdge *je = b->GetJointList(); je; je = je->next) {
+			track_awake_body(je->other->GetUserData().owner);
+		}
+
+		if (!body_node->prev_sleeping_state) {
+			body_node->prev_sleeping_state = true;
+			sleep_state_changed.push_back(body_node->get_instance_id());
+		}
+
+		// Skip bodies that are awake but haven't moved (e.g. waiting out the sleep timer)
+		const b2Transform &xf = b->GetTransform();
+		const b2Transform &last_xf = body_node->last_synced_b2_xform;
+		const bool moved = xf.p.x != last_xf.p.x || xf.p.y != last_xf.p.y || xf.q.s != last_xf.q.s || xf.q.c != last_xf.q.c;
+		if (is_interpolating()) {
+			// Node transforms are written every frame in interpolate_awake_bodies
+			body_node->interp_prev_xform = body_node->interp_curr_xform;
+			if (moved) {
+				body_node->last_synced_b2_xform = xf;
+				body_node->interp_curr_xform = b2_to_gd(xf);
+			}
+		} else if (moved) {
+			body_node->state_changed();
+		}
+
+		++i;
+	}
+
+	for (i = 0; i < sleep_state_changed.size(); ++i) {
+		Object *obj = ObjectDB::get_instance(sleep_state_changed[i]);
+		if (obj) {
+			obj->emit_signal(B2SN->sleeping_state_changed);
+		}
+	}
+}
+
+void Box2DWorld::interpolate_awake_bodies(real_t p_fraction) {
+	for (uint32_t i = 0; i < awake_bodies.size(); ++i) {
+		awake_bodies[i]->interpolate_state(p_fraction);
+	}
+}
+
+int Box2DWorld::measure_largest_island() {
+	// Union-find over the tracked awake bodies, joined by touching contacts and joints.
+	// Static bodies are never tracked, so (like Box2D's own islands) they don't join anything.
+	const uint32_t n = awake_bodies.size();
+	if (n == 0) {
+		return 0;
+	}
+
+	island_parents.resize(n);
+	for (uint32_t i = 0; i < n; ++i) {
+		island_parents[i] = i;
+	}
+
+	struct Find {
+		static _FORCE_INLINE_ uint32_t root(LocalVector<uint32_t> &p_parents, uint32_t p_idx) {
+			while (p_parents[p_idx] != p_idx) {
+				p_parents[p_idx] = p_parents[p_parents[p_idx]]; // Path halving
+				p_idx = p_parents[p_idx];
+			}
+			return p_idx;
+		}
+	};
+
+	for (uint32_t i = 0; i < n; ++i) {
+		b2Body *b = awake_bodies[i]->body;
+		for (b2ContactEdge *ce = b->GetContactList(); ce; ce = ce->next) {
+			const int other = ce->other->GetUserData().owner->awake_index;
+			if (other >= 0 && ce->contact->IsTouching() && ce->contact->IsEnabled()) {
+				island_parents[Find::root(island_parents, i)] = Find::root(island_parents, other);
+			}
+		}
+		for (b2JointEdge *je = b->GetJointList(); je; je = je->next) {
+			const int other = je->other->GetUserData().owner->awake_index;
+			if (other >= 0) {
+				island_parents[Find::root(island_parents, i)] = Find::root(island_parents, other);
+			}
+		}
+	}
+
+	island_sizes.resize(n);
+	for (uint32_t i = 0; i < n; ++i) {
+		island_sizes[i] = 0;
+	}
+	uint32_t largest = 0;
+	for (uint32_t i = 0; i < n; ++i) {
+		const uint32_t size = ++island_sizes[Find::root(island_parents, i)];
+		largest = MAX(largest, size);
+	}
+	return largest;
+}
+
+void Box2DWorld::update_processing() {
+	const bool running = world && !Engine::get_singleton()->is_editor_hint();
+	set_physics_process_internal(running && fixed_step_rate <= 0.0f);
+	set_process_internal(running && fixed_step_rate > 0.0f);
+	update_step_thread();
+}
+
+void Box2DWorld::_step_thread_func(void *p_userdata) {
+	Box2DWorld *world_node = static_cast<Box2DWorld *>(p_userdata);
+	while (true) {
+		world_node->step_start.wait();
+		if (world_node->step_thread_exit) {
+			break;
+		}
+		world_node->run_step();
+		world_node->step_done.post();
+	}
+}
+
+void Box2DWorld::update_step_thread() {
+	const bool running = async_step && world && !Engine::get_singleton()->is_editor_hint();
+	if (running && !step_thread.is_started()) {
+		step_thread_exit = false;
+		step_thread.start(&Box2DWorld::_step_thread_func, this);
+	} else if (!running) {
+		stop_step_thread();
+	}
+}
+
+void Box2DWorld::stop_step_thread() {
+	if (step_thread.is_started()) {
+		wait_for_step();
+		step_thread_exit = true;
+		step_start.post();
+		step_thread.wait_to_finish();
+	}
+}
+
+void Box2DWorld::finish_step() {
+	step_done.wait();
+	step_in_flight = false;
+
+	// Bodies may be destroyed right after this, so anything holding body pointers is handled now
+	track_contact_woken_bodies();
+
+	for (uint32_t i = 0; i < command_queue.size(); ++i) {
+		apply_command(command_queue[i]);
+	}
+	command_queue.clear();
+}
+
+void Box2DWorld::track_contact_woken_bodies() {
+	for (uint32_t i = 0; i < contact_woken_bodies.size(); ++i) {
+		track_awake_body(contact_woken_bodies[i]);
+	}
+	contact_woken_bodies.clear();
+}
+
+bool Box2DWorld::can_group_step() const {
+	// Fixed-rate and async worlds schedule their own steps
+	return parallel_step && auto_step && !async_step && fixed_step_rate <= 0.0f && world && is_physics_processing_internal() && can_process();
+}
+
+void Box2DWorld::_step_group_member(uint32_t p_index, LocalVector<Box2DWorld *> *p_batch) {
+	(*p_batch)[p_index]->run_step();
+}
+
+void Box2DWorld::step_group(real_t p_step) {
+	const uint64_t frame = Engine::get_singleton()->get_physics_frames();
+	if (group_step_frame != frame) {
+		// First grouped world to process this frame. Step every world in the group.
+		// The only global state b2Worlds share is set up when they're created (see b2World::b2World in b2patch/),
+		// and the GJK/TOI profiling counters, which b2patch/collision/ keeps per thread.
+		// Everything that touches nodes is deferred to deliver_step_results().
+		group_step_frame = frame;
+
+		group_batch.clear();
+		for (uint32_t i = 0; i < parallel_worlds.size(); ++i) {
+			Box2DWorld *world_node = parallel_worlds[i];
+			// A world whose results are still pending (it didn't process last frame) sits this one out
+			if (world_node->can_group_step() && !world_node->group_stepped) {
+				world_node->prepare_step(p_step);
+				world_node->worker_stepping = true;
+				group_batch.push_back(world_node);
+			}
+		}
+
+		if (group_batch.size() > 1) {
+			init_group_pool();
+			group_pool.do_work(group_batch.size(), this, &Box2DWorld::_step_group_member, &group_batch);
+		} else if (group_batch.size() == 1) {
+			group_batch[0]->run_step();
+		}
+
+		for (uint32_t i = 0; i < group_batch.size(); ++i) {
+			Box2DWorld *world_node = group_batch[i];
+			world_node->worker_stepping = false;
+			world_node->group_stepped = true;
+			world_node->track_contact_woken_bodies();
+		}
+		group_batch.clear();
+	}
+
+	if (group_stepped) {
+		group_stepped = false;
+		deliver_step_results();
+	} else {
+		step(p_step);
+	}
+}
+
+void Box2DWorld::init_group_pool() {
+	if (!group_pool_initialized) {
+		group_pool.init();
+		group_pool_initialized = true;
+	}
+}
+
+void Box2DWorld::finish_group_pool() {
+	if (group_pool_initialized) {
+		group_pool.finish();
+		group_pool_initialized = false;
+	}
+}
+
+void Box2DWorld::check_joint_breaks() {
+	// Breaking emits a signal and may free the joint, so collect the broken joints first
+	struct JointBreak {
+		ObjectID id;
+		Vector2 force;
+		real_t torque;
+	};
+	LocalVector<JointBreak> breaks;
+
+	for (Set<Box2DJoint *>::Element *E = joints.front(); E; E = E->next()) {
+		Box2DJoint *joint_node = E->get();
+		if (!joint_node->breaking_enabled || !joint_node->joint) {
+			continue;
+		}
+
+		JointBreak jb;
+		jb.force = joint_node->get_reaction_force();
+		jb.torque = Math::abs(joint_node->get_reaction_torque());
+
+		const bool exceeded_force = joint_node->max_force > 0 && jb.force.length() > joint_node->max_force;
+		const bool exceeded_torque = joint_node->max_torque > 0 && jb.torque > joint_node->max_torque;
+
+		if (exceeded_force || exceeded_torque) {
+			jb.id = joint_node->get_instance_id();
+			breaks.push_back(jb);
+		}
+	}
+
+	for (uint32_t i = 0; i < breaks.size(); ++i) {
+		Box2DJoint *joint_node = Object::cast_to<Box2DJoint>(ObjectDB::get_instance(breaks[i].id));
+		if (joint_node && !joint_node->broken) {
+			joint_node->emit_signal(B2SN->joint_broken, breaks[i].force, breaks[i].torque);
+			joint_node->set_broken(true);
+		}
 	}
 }
 
@@ -358,186 +1775,1234 @@ void Box2DWorld::create_b2World() {
 	if (!world) {
 		world = memnew(b2World(gd_to_b2(gravity)));
 
-		world->SetDestructionListener(this);
-		world->SetContactFilter(this);
-		world->SetContactListener(this);
+		world->SetDestructionListener(this);
+		world->SetContactFilter(this);
+		world->SetContactListener(this);
+
+		Set<Box2DPhysicsBody *>::Element *body = bodies.front();
+		while (body) {
+			body->get()->on_parent_created(this);
+			body = body->next();
+		}
+		Set<Box2DJoint *>::Element *joint = joints.front();
+		while (joint) {
+			joint->get()->on_parent_created(this);
+			joint = joint->next();
+		}
+
+		update_processing();
+	}
+}
+
+void Box2DWorld::destroy_b2World() {
+	if (world) {
+		stop_step_thread();
+
+		for (uint32_t i = 0; i < awake_bodies.size(); ++i) {
+			awake_bodies[i]->awake_index = -1;
+		}
+		awake_bodies.clear();
+
+		// Box2D doesn't report EndContact when the world is deleted, so drop the buffered contacts here
+		for (Set<Box2DPhysicsBody *>::Element *E = bodies.front(); E; E = E->next()) {
+			if (E->get()->contact_monitor) {
+				E->get()->contact_monitor->contacts.clear();
+				E->get()->contact_monitor->pairs.clear();
+				E->get()->contact_monitor->pair_index.clear();
+				mark_contact_monitor_dirty(E->get());
+			}
+		}
+		contact_buffer.clear();
+		contact_pool.clear();
+		summary_monitors.clear();
+
+		for (uint32_t i = 0; i < sensors.size(); ++i) {
+			sensors[i].fixture->sensor_index = -1;
+			sensors[i].fixture->sensor_world = NULL;
+		}
+		sensors.clear();
+		sensor_events.clear();
+		retired_sensors.clear();
+		exception_pairs.clear();
+
+		// Nullify bodies, joints, and fixtures so that nothing calls their b2 Destroy func.
+		// Normally our wrapper nodes call b2World.DestroyX, but that seems to be slow (vaguely tested, could be wrong) when doing them all at once, in indeterminant order.
+		// Instead we let the b2 allocators free themselves.
+
+		b2Body *body = world->GetBodyList();
+		while (body) {
+			// nullify body
+			body->GetUserData().owner->body = NULL;
+
+			// nullify fixtures
+			b2Fixture *fixture = body->GetFixtureList();
+			while (fixture) {
+				fixture->GetUserData().owner->fixtures.clear();
+				fixture = fixture->GetNext();
+			}
+
+			body = body->GetNext();
+		}
+
+		b2Joint *joint = world->GetJointList();
+		while (joint) {
+			// nullify joint
+			joint->GetUserData().owner->joint = NULL;
+
+			joint = joint->GetNext();
+		}
+
+		memdelete(world);
+		world = NULL;
+	}
+}
+
+void Box2DWorld::_notification(int p_what) {
+	switch (p_what) {
+		case NOTIFICATION_PREDELETE: {
+			parallel_worlds.erase(this);
+			destroy_b2World();
+		} break;
+
+		case NOTIFICATION_ENTER_TREE: {
+			Box2DConversionContext::refresh();
+
+			// Create world
+			create_b2World();
+		} break;
+
+		case NOTIFICATION_EXIT_TREE: {
+			// Don't destroy world. It could be exiting/entering.
+			// World should be destroyed in PREDELETE if node is being freed.
+		} break;
+
+		case NOTIFICATION_INTERNAL_PHYSICS_PROCESS: {
+			if (auto_step) {
+				float time = get_physics_process_delta_time();
+				if (group_stepped || can_group_step()) {
+					step_group(time);
+				} else {
+					step(time);
+				}
+			}
+		} break;
+
+		case NOTIFICATION_INTERNAL_PROCESS: {
+			if (auto_step) {
+				advance(get_process_delta_time());
+			}
+		} break;
+	}
+}
+
+void Box2DWorld::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_gravity", "gravity"), &Box2DWorld::set_gravity);
+	ClassDB::bind_method(D_METHOD("get_gravity"), &Box2DWorld::get_gravity);
+	ClassDB::bind_method(D_METHOD("set_auto_step", "auto_setp"), &Box2DWorld::set_auto_step);
+	ClassDB::bind_method(D_METHOD("get_auto_step"), &Box2DWorld::get_auto_step);
+	ClassDB::bind_method(D_METHOD("set_fixed_step_rate", "fixed_step_rate"), &Box2DWorld::set_fixed_step_rate);
+	ClassDB::bind_method(D_METHOD("get_fixed_step_rate"), &Box2DWorld::get_fixed_step_rate);
+	ClassDB::bind_method(D_METHOD("set_max_steps_per_frame", "max_steps_per_frame"), &Box2DWorld::set_max_steps_per_frame);
+	ClassDB::bind_method(D_METHOD("get_max_steps_per_frame"), &Box2DWorld::get_max_steps_per_frame);
+	ClassDB::bind_method(D_METHOD("set_interpolate", "interpolate"), &Box2DWorld::set_interpolate);
+	ClassDB::bind_method(D_METHOD("is_interpolate_enabled"), &Box2DWorld::is_interpolate_enabled);
+	ClassDB::bind_method(D_METHOD("set_velocity_iterations", "velocity_iterations"), &Box2DWorld::set_velocity_iterations);
+	ClassDB::bind_method(D_METHOD("get_velocity_iterations"), &Box2DWorld::get_velocity_iterations);
+	ClassDB::bind_method(D_METHOD("set_position_iterations", "position_iterations"), &Box2DWorld::set_position_iterations);
+	ClassDB::bind_method(D_METHOD("get_position_iterations"), &Box2DWorld::get_position_iterations);
+	ClassDB::bind_method(D_METHOD("set_substeps", "substeps"), &Box2DWorld::set_substeps);
+	ClassDB::bind_method(D_METHOD("get_substeps"), &Box2DWorld::get_substeps);
+	ClassDB::bind_method(D_METHOD("set_adaptive_iterations", "adaptive_iterations"), &Box2DWorld::set_adaptive_iterations);
+	ClassDB::bind_method(D_METHOD("is_adaptive_iterations_enabled"), &Box2DWorld::is_adaptive_iterations_enabled);
+	ClassDB::bind_method(D_METHOD("set_async_step", "async_step"), &Box2DWorld::set_async_step);
+	ClassDB::bind_method(D_METHOD("is_async_step_enabled"), &Box2DWorld::is_async_step_enabled);
+	ClassDB::bind_method(D_METHOD("set_parallel_step", "parallel_step"), &Box2DWorld::set_parallel_step);
+	ClassDB::bind_method(D_METHOD("is_parallel_step_enabled"), &Box2DWorld::is_parallel_step_enabled);
+	ClassDB::bind_method(D_METHOD("set_parallel_narrow_phase", "parallel_narrow_phase"), &Box2DWorld::set_parallel_narrow_phase);
+	ClassDB::bind_method(D_METHOD("is_parallel_narrow_phase_enabled"), &Box2DWorld::is_parallel_narrow_phase_enabled);
+	ClassDB::bind_method(D_METHOD("set_collision_rules", "collision_rules"), &Box2DWorld::set_collision_rules);
+	ClassDB::bind_method(D_METHOD("get_collision_rules"), &Box2DWorld::get_collision_rules);
+	ClassDB::bind_method(D_METHOD("_collision_rules_changed"), &Box2DWorld::_collision_rules_changed);
+	ClassDB::bind_method(D_METHOD("set_contact_events", "enabled"), &Box2DWorld::set_contact_events);
+	ClassDB::bind_method(D_METHOD("is_contact_events_enabled"), &Box2DWorld::is_contact_events_enabled);
+
+	ClassDB::bind_method(D_METHOD("get_contact_events"), &Box2DWorld::get_contact_events);
+
+	ClassDB::bind_method(D_METHOD("query_aabb", "bounds", "max_results", "collision_mask", "exclude"), &Box2DWorld::query_aabb, DEFVAL(32), DEFVAL(0xFFFF), DEFVAL(Array()));
+	ClassDB::bind_method(D_METHOD("intersect_point", "point", "max_results", "collision_mask", "exclude"), &Box2DWorld::intersect_point, DEFVAL(32), DEFVAL(0xFFFF), DEFVAL(Array()));
+	ClassDB::bind_method(D_METHOD("raycast_batch", "from", "to", "collision_mask", "mode"), &Box2DWorld::raycast_batch, DEFVAL(0xFFFF), DEFVAL(RAYCAST_CLOSEST));
+	ClassDB::bind_method(D_METHOD("intersect_shape", "parameters", "max_results"), &Box2DWorld::intersect_shape, DEFVAL(32));
+	ClassDB::bind_method(D_METHOD("cast_shape", "parameters", "motion"), &Box2DWorld::cast_shape);
+	ClassDB::bind_method(D_METHOD("cast_shape_batch", "parameters", "origins", "motions"), &Box2DWorld::cast_shape_batch);
+	ClassDB::bind_method(D_METHOD("step", "delta"), &Box2DWorld::step);
+	ClassDB::bind_method(D_METHOD("advance", "delta"), &Box2DWorld::advance);
+
+	ADD_PROPERTY(PropertyInfo(Variant::VECTOR2, "gravity"), "set_gravity", "get_gravity");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "auto_step"), "set_auto_step", "get_auto_step");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "contact_events"), "set_contact_events", "is_contact_events_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "collision_rules", PROPERTY_HINT_RESOURCE_TYPE, "Box2DCollisionRules"), "set_collision_rules", "get_collision_rules");
+	ADD_GROUP("Fixed Step", "");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "fixed_step_rate", PROPERTY_HINT_RANGE, "0,240,1,or_greater"), "set_fixed_step_rate", "get_fixed_step_rate");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_steps_per_frame", PROPERTY_HINT_RANGE, "1,32,1,or_greater"), "set_max_steps_per_frame", "get_max_steps_per_frame");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "interpolate"), "set_interpolate", "is_interpolate_enabled");
+	ADD_GROUP("Solver", "");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "velocity_iterations", PROPERTY_HINT_RANGE, "1,32,1,or_greater"), "set_velocity_iterations", "get_velocity_iterations");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "position_iterations", PROPERTY_HINT_RANGE, "1,32,1,or_greater"), "set_position_iterations", "get_position_iterations");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "substeps", PROPERTY_HINT_RANGE, "1,16,1,or_greater"), "set_substeps", "get_substeps");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "adaptive_iterations"), "set_adaptive_iterations", "is_adaptive_iterations_enabled");
+	ADD_GROUP("Threading", "");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "async_step"), "set_async_step", "is_async_step_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "parallel_step"), "set_parallel_step", "is_parallel_step_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "parallel_narrow_phase"), "set_parallel_narrow_phase", "is_parallel_narrow_phase_enabled");
+
+	BIND_ENUM_CONSTANT(CONTACT_EVENT_BEGIN);
+	BIND_ENUM_CONSTANT(CONTACT_EVENT_END);
+	BIND_ENUM_CONSTANT(CONTACT_EVENT_POST_SOLVE);
+
+	BIND_ENUM_CONSTANT(RAYCAST_CLOSEST);
+	BIND_ENUM_CONSTANT(RAYCAST_ANY);
+	BIND_ENUM_CONSTANT(RAYCAST_ALL);
+}
+
+void Box2DWorld::prepare_step(real_t p_step) {
+	// Pick up changes to the conversion factor once per step, rather than on every conversion
+	if (unlikely(Box2DConversionContext::refresh())) {
+		world->SetGravity(gd_to_b2(gravity));
+	}
+
+	if (unlikely(collision_rules_dirty)) {
+		update_rule_table();
+	}
+
+	// Pair summaries only cover the latest step
+	if (summary_monitors.size() > 0) {
+		clear_pair_summaries();
+	}
+
+	// Every buffered contact becomes unsolved for this step. 0 is skipped, since new contacts start there.
+	if (unlikely(++step_epoch == 0)) {
+		step_epoch = 1;
+	}
+
+	step_velocity_iterations = velocity_iterations;
+	step_position_iterations = position_iterations;
+	if (adaptive_iterations) {
+		// Impulses need roughly one iteration per link to travel through a chain of contacts, so a
+		// tall stack needs many iterations while loose debris needs very few. The largest island's
+		// body count is a cheap upper bound on the longest chain.
+		const int island = measure_largest_island();
+		step_velocity_iterations = MIN(velocity_iterations, MAX(island, 2));
+		step_position_iterations = MIN(position_iterations, MAX(island / 2, 1));
+	}
+
+	last_step_delta = p_step / substeps;
+}
+
+void Box2DWorld::run_step() {
+	// Set per thread, since worlds in a group step on different workers
+	b2SetTaskExecutor(&task_executor);
+	for (int i = 0; i < substeps; ++i) {
+		world->Step(last_step_delta, step_velocity_iterations, step_position_iterations);
+	}
+	b2SetTaskExecutor(NULL);
+	flag_rescan_contacts_monitored = false;
+
+	if (sensors.size() > 0 || retired_sensors.size() > 0) {
+		update_sensor_overlaps();
+	}
+}
+
+void Box2DWorld::step(real_t p_step) {
+	//print_line(("step: " + std::to_string(p_step)
+	//		+ ", gravity: ("
+	//		+ std::to_string(world->GetGravity().x) + ", "
+	//		+ std::to_string(world->GetGravity().y) + ")")
+	//	.c_str());
+
+	// Finish the step started by the previous call, if any
+	wait_for_step();
+
+	if (async_step && step_thread.is_started()) {
+		// Sync point. Deliver the results of the previous step, then start the next one on the worker.
+		deliver_step_results();
+
+		// Published before prepare_step() clears the pair summaries
+		publish_contact_monitors();
+		prepare_step(p_step);
+		publish_body_state();
+
+		step_in_flight = true;
+		step_start.post();
+	} else {
+		prepare_step(p_step);
+		run_step();
+		deliver_step_results();
+	}
+}
+
+void Box2DWorld::deliver_step_results() {
+	sync_awake_bodies();
+	if (contact_events_enabled) {
+		publish_contact_events();
+	}
+	flush_contact_signals();
+	if (sensor_events.size() > 0) {
+		deliver_sensor_events();
+	}
+	if (impacted_bodies.size() > 0 || reported_impact_bodies.size() > 0) {
+		deliver_impacts();
+	}
+	check_joint_breaks();
+}
+
+void Box2DWorld::set_gravity(const Vector2 &p_gravity) {
+	if (world) {
+		wait_for_step();
+		world->SetGravity(gd_to_b2(p_gravity));
+	}
+	gravity = p_gravity;
+}
+
+Vector2 Box2DWorld::get_gravity() const {
+	return gravity;
+}
+
+void Box2DWorld::set_auto_step(bool p_auto_step) {
+	auto_step = p_auto_step;
+}
+
+bool Box2DWorld::get_auto_step() const {
+	return auto_step;
+}
+
+void Box2DWorld::advance(real_t p_delta) {
+	ERR_FAIL_COND_MSG(fixed_step_rate <= 0.0f, "advance() requires fixed_step_rate > 0.");
+
+	const real_t step_delta = 1.0f / fixed_step_rate;
+
+	step_accumulator += p_delta;
+	int steps = 0;
+	while (step_accumulator >= step_delta && steps < max_steps_per_frame) {
+		contact_events_accumulate = steps > 0;
+		step(step_delta);
+		step_accumulator -= step_delta;
+		++steps;
+	}
+	contact_events_accumulate = false;
+	if (steps == 0) {
+		// Nothing was delivered this frame. Don't hand out the last frame's events again.
+		clear_published_contact_events();
+	}
+
+	// If we fell behind, drop the remaining time instead of trying to catch up on later frames
+	step_accumulator = MIN(step_accumulator, step_delta);
+
+	if (is_interpolating()) {
+		interpolate_awake_bodies(step_accumulator / step_delta);
+	}
+}
+
+void Box2DWorld::set_fixed_step_rate(real_t p_rate) {
+	fixed_step_rate = MAX(p_rate, 0.0f);
+	step_accumulator = 0.0f;
+	update_processing();
+}
+
+real_t Box2DWorld::get_fixed_step_rate() const {
+	return fixed_step_rate;
+}
+
+void Box2DWorld::set_max_steps_per_frame(int p_steps) {
+	max_steps_per_frame = MAX(p_steps, 1);
+}
+
+int Box2DWorld::get_max_steps_per_frame() const {
+	return max_steps_per_frame;
+}
+
+void Box2DWorld::set_interpolate(bool p_interpolate) {
+	if (interpolate == p_interpolate) {
+		return;
+	}
+	interpolate = p_interpolate;
+
+	// Start every tracked body from its current pose
+	for (uint32_t i = 0; i < awake_bodies.size(); ++i) {
+		Box2DPhysicsBody *body_node = awake_bodies[i];
+		body_node->interp_curr_xform = b2_to_gd(body_node->body->GetTransform());
+		body_node->interp_prev_xform = body_node->interp_curr_xform;
+	}
+}
+
+bool Box2DWorld::is_interpolate_enabled() const {
+	return interpolate;
+}
+
+void Box2DWorld::set_velocity_iterations(int p_iterations) {
+	velocity_iterations = MAX(p_iterations, 1);
+}
+
+int Box2DWorld::get_velocity_iterations() const {
+	return velocity_iterations;
+}
+
+void Box2DWorld::set_position_iterations(int p_iterations) {
+	position_iterations = MAX(p_iterations, 1);
+}
+
+int Box2DWorld::get_position_iterations() const {
+	return position_iterations;
+}
+
+void Box2DWorld::set_substeps(int p_substeps) {
+	substeps = MAX(p_substeps, 1);
+}
+
+int Box2DWorld::get_substeps() const {
+	return substeps;
+}
+
+void Box2DWorld::set_adaptive_iterations(bool p_adaptive) {
+	adaptive_iterations = p_adaptive;
+}
+
+bool Box2DWorld::is_adaptive_iterations_enabled() const {
+	return adaptive_iterations;
+}
+
+void Box2DWorld::set_async_step(bool p_async) {
+	if (async_step == p_async) {
+		return;
+	}
+	wait_for_step();
+
+	if (p_async) {
+		async_step = true;
+		// Published contact data is stale. Republish everything at the next step.
+		for (Set<Box2DPhysicsBody *>::Element *E = bodies.front(); E; E = E->next()) {
+			if (E->get()->contact_monitor) {
+				mark_contact_monitor_dirty(E->get());
+			}
+		}
+	} else {
+		publish_contact_monitors(); // Clears the dirty flags
+		async_step = false;
+	}
+
+	update_step_thread();
+}
+
+bool Box2DWorld::is_async_step_enabled() const {
+	return async_step;
+}
+
+void Box2DWorld::set_parallel_step(bool p_parallel) {
+	if (parallel_step == p_parallel) {
+		return;
+	}
+	parallel_step = p_parallel;
+
+	if (parallel_step) {
+		parallel_worlds.push_back(this);
+	} else {
+		parallel_worlds.erase(this);
+		if (group_stepped) {
+			// Stepped by the group this frame but not delivered yet
+			group_stepped = false;
+			deliver_step_results();
+		}
+	}
+}
+
+bool Box2DWorld::is_parallel_step_enabled() const {
+	return parallel_step;
+}
+
+void Box2DWorld::set_parallel_narrow_phase(bool p_parallel) {
+	// Read by b2ContactManager::Collide, which may be running on the step thread
+	wait_for_step();
+	task_executor.narrow_phase = p_parallel;
+}
+
+bool Box2DWorld::is_parallel_narrow_phase_enabled() const {
+	return task_executor.narrow_phase;
+}
+
+void Box2DWorld::set_collision_rules(const Ref<Box2DCollisionRules> &p_rules) {
+	if (collision_rules == p_rules) {
+		return;
+	}
+
+	if (collision_rules.is_valid()) {
+		collision_rules->disconnect("changed", Callable(this, "_collision_rules_changed"));
+	}
+	collision_rules = p_rules;
+	if (collision_rules.is_valid()) {
+		collision_rules->connect("changed", Callable(this, "_collision_rules_changed"));
+	}
+
+	collision_rules_dirty = true;
+}
+
+Ref<Box2DCollisionRules> Box2DWorld::get_collision_rules() const {
+	return collision_rules;
+}
+
+void Box2DWorld::set_contact_events(bool p_enabled) {
+	if (contact_events_enabled == p_enabled) {
+		return;
+	}
+	wait_for_step();
+	contact_events_enabled = p_enabled;
+
+	if (!contact_events_enabled) {
+		contact_events.clear();
+		clear_published_contact_events();
+	}
+}
+
+bool Box2DWorld::is_contact_events_enabled() const {
+	return contact_events_enabled;
+}
+
+Dictionary Box2DWorld::get_contact_events() const {
+	// Packed arrays are copy-on-write, so this doesn't copy any event data
+	Dictionary d;
+	d["type"] = published_event_types;
+	d["fixture_a"] = published_event_fixtures_a;
+	d["fixture_b"] = published_event_fixtures_b;
+	d["point"] = published_event_points;
+	d["normal"] = published_event_normals;
+	d["impact_velocity"] = published_event_impact_velocities;
+	d["normal_impulse"] = published_event_normal_impulses;
+	return d;
+}
 
-		Set<Box2DPhysicsBody *>::Element *body = bodies.front();
-		while (body) {
-			body->get()->on_parent_created(this);
-			body = body->next();
+bool Box2DWorld::build_query_children(const Ref<Box2DShape> &p_shape, const b2Transform &p_xf, LocalVector<QueryChild> &r_children, b2AABB &r_bounds) {
+	ERR_FAIL_COND_V_MSG(p_shape.is_null(), false, "Query shape is not set.");
+
+	Vector<const b2Shape *> shapes;
+	if (p_shape->is_composite_shape()) {
+		shapes = p_shape->get_shapes();
+	} else {
+		ERR_FAIL_COND_V(!p_shape->get_shape(), false);
+		shapes.push_back(p_shape->get_shape());
+	}
+
+	r_children.clear();
+	for (int i = 0; i < shapes.size(); ++i) {
+		for (int32 c = 0; c < shapes[i]->GetChildCount(); ++c) {
+			QueryChild child;
+			child.shape = shapes[i];
+			child.child = c;
+			shapes[i]->ComputeAABB(&child.aabb, p_xf, c);
+
+			if (r_children.size() == 0) {
+				r_bounds = child.aabb;
+			} else {
+				r_bounds.Combine(child.aabb);
+			}
+			r_children.push_back(child);
 		}
-		Set<Box2DJoint *>::Element *joint = joints.front();
-		while (joint) {
-			joint->get()->on_parent_created(this);
-			joint = joint->next();
+	}
+
+	return r_children.size() > 0;
+}
+
+bool Box2DWorld::test_query_overlap(const LocalVector<QueryChild> &p_children, const b2Transform &p_xf, b2Fixture *p_fixture) {
+	const b2Shape *other = p_fixture->GetShape();
+	const b2Transform &other_xf = p_fixture->GetBody()->GetTransform();
+	const int32 other_children = other->GetChildCount();
+
+	for (uint32_t i = 0; i < p_children.size(); ++i) {
+		const QueryChild &child = p_children[i];
+		for (int32 j = 0; j < other_children; ++j) {
+			// The proxy AABBs rule out most children of composite and chain shapes before the shape test
+			if (b2TestOverlap(child.aabb, p_fixture->GetAABB(j)) && b2TestOverlap(child.shape, child.child, other, j, p_xf, other_xf)) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+// Orders b2Fixtures by their fixture node's instance ID. A node's own b2Fixtures fall back on their addresses,
+// which keeps duplicates adjacent for sort_unique.
+struct FixtureNodeOrder {
+	_FORCE_INLINE_ bool operator()(const b2Fixture *p_a, const b2Fixture *p_b) const {
+		const uint64_t id_a = p_a->GetUserData().owner->get_instance_id();
+		const uint64_t id_b = p_b->GetUserData().owner->get_instance_id();
+		return id_a != id_b ? id_a < id_b : p_a < p_b;
+	}
+};
+
+bool Box2DWorld::accepts_query_fixture(const Box2DShapeQueryParameters *p_params, b2Fixture *p_fixture) {
+	if (p_fixture->IsSensor() && !p_params->is_collide_with_sensors_enabled()) {
+		return false;
+	}
+	if ((p_fixture->GetFilterData().categoryBits & p_params->get_collision_mask()) == 0) {
+		return false;
+	}
+
+	const Box2DFixture *owner = p_fixture->GetUserData().owner;
+	return !p_params->is_excluded(owner->get_instance_id()) && !p_params->is_excluded(owner->body_node->get_instance_id());
+}
+
+Dictionary Box2DWorld::intersect_shape(const Ref<Box2DShapeQueryParameters> &p_params, int p_max_results) {
+	ERR_FAIL_COND_V(p_params.is_null(), Dictionary());
+	ERR_FAIL_COND_V(!world, Dictionary());
+
+	const b2Transform xf = gd_to_b2(p_params->get_transform());
+	LocalVector<QueryChild> children;
+	b2AABB bounds;
+	if (!build_query_children(p_params->get_shape(), xf, children, bounds)) {
+		return Dictionary();
+	}
+
+	// The broad-phase is only safe to read outside of Step
+	wait_for_step();
+
+	// One broad-phase pass over the union of the children, then exact tests per candidate
+	QueryCallback callback;
+	world->QueryAABB(&callback, bounds);
+	// Candidates are tested in fixture node order, so which fixtures make the max_results cut doesn't depend on memory layout
+	sort_unique<b2Fixture *, FixtureNodeOrder>(callback.results);
+
+	PackedInt64Array fixtures;
+	PackedInt64Array bodies;
+	for (uint32_t i = 0; i < callback.results.size() && fixtures.size() < p_max_results; ++i) {
+		b2Fixture *fixture = callback.results[i];
+		if (!accepts_query_fixture(p_params.ptr(), fixture)) {
+			continue;
+		}
+
+		// Fixture nodes with composite shapes own several b2Fixtures, but are reported once. Those are adjacent.
+		const Box2DFixture *owner = fixture->GetUserData().owner;
+		const int64_t id = owner->get_instance_id();
+		if (fixtures.size() > 0 && fixtures[fixtures.size() - 1] == id) {
+			continue;
 		}
 
-		if (!Engine::get_singleton()->is_editor_hint()) {
-			set_physics_process_internal(true);
+		if (test_query_overlap(children, xf, fixture)) {
+			fixtures.push_back(id);
+			bodies.push_back(owner->body_node->get_instance_id());
 		}
 	}
+
+	Dictionary d;
+	d["fixture"] = fixtures;
+	d["body"] = bodies;
+	return d;
 }
 
-void Box2DWorld::destroy_b2World() {
-	if (world) {
-		// Nullify bodies, joints, and fixtures so that nothing calls their b2 Destroy func.
-		// Normally our wrapper nodes call b2World.DestroyX, but that seems to be slow (vaguely tested, could be wrong) when doing them all at once, in indeterminant order.
-		// Instead we let the b2 allocators free themselves.
+void Box2DWorld::cast_child(const QueryChild &p_child, const b2Sweep &p_sweep, const b2Vec2 &p_motion, b2Fixture *p_fixture, int32 p_fixture_child, bool p_drop_through, ShapeCastHit &r_hit) {
+	const b2Transform &other_xf = p_fixture->GetBody()->GetTransform();
+
+	b2TOIInput input;
+	input.proxyA.Set(p_child.shape, p_child.child);
+	input.proxyB.Set(p_fixture->GetShape(), p_fixture_child);
+	input.sweepA = p_sweep;
+	input.sweepB.localCenter.SetZero();
+	input.sweepB.c0 = other_xf.p;
+	input.sweepB.c = other_xf.p;
+	input.sweepB.a0 = other_xf.q.GetAngle();
+	input.sweepB.a = input.sweepB.a0;
+	input.sweepB.alpha0 = 0.0f;
+	// Nothing past the current earliest hit matters
+	input.tMax = r_hit.fraction;
+
+	b2TOIOutput output;
+	b2TimeOfImpact(&output, &input);
+	if (output.state == b2TOIOutput::e_separated || output.state == b2TOIOutput::e_unknown) {
+		return;
+	}
 
-		b2Body *body = world->GetBodyList();
-		while (body) {
-			// nullify body
-			body->GetUserData().owner->body = NULL;
+	// A failed root finder still leaves a conservative time
+	const float t = output.state == b2TOIOutput::e_overlapped ? 0.0f : output.t;
+	if (r_hit.fixture && t >= r_hit.fraction) {
+		return;
+	}
 
-			// nullify fixtures
-			b2Fixture *fixture = body->GetFixtureList();
-			while (fixture) {
-				fixture->GetUserData().owner->fixtures.clear();
-				fixture = fixture->GetNext();
-			}
+	// The separation between the cores at the time of impact gives the normal
+	b2DistanceInput distance_input;
+	distance_input.proxyA = input.proxyA;
+	distance_input.proxyB = input.proxyB;
+	p_sweep.GetTransform(&distance_input.transformA, t);
+	distance_input.transformB = other_xf;
+	distance_input.useRadii = false;
+
+	b2SimplexCache cache;
+	cache.count = 0;
+	b2DistanceOutput distance;
+	b2Distance(&distance, &cache, &distance_input);
+
+	b2Vec2 normal = distance.pointA - distance.pointB;
+	const bool cores_overlap = normal.Normalize() < b2_epsilon;
+	if (cores_overlap) {
+		// There's no way out. Block the motion outright.
+		normal = -p_motion;
+		normal.Normalize();
+	} else if (b2Dot(normal, p_motion) >= 0.0f) {
+		// Touching, but moving apart or sliding along the surface
+		return;
+	}
 
-			body = body->GetNext();
+	// One-way fixtures only block casts arriving from their open side, like passes_one_way()
+	const b2FixtureUserData &data = p_fixture->GetUserData();
+	if (data.one_way) {
+		const b2Vec2 up = b2Mul(other_xf.q, b2Vec2(data.one_way_normal_x, data.one_way_normal_y));
+		if (p_drop_through || cores_overlap || b2Dot(normal, up) <= 0.0f) {
+			return;
 		}
+	}
 
-		b2Joint *joint = world->GetJointList();
-		while (joint) {
-			// nullify joint
-			joint->GetUserData().owner->joint = NULL;
+	r_hit.fraction = t;
+	r_hit.normal = normal;
+	r_hit.point = distance.pointB + input.proxyB.m_radius * normal;
+	r_hit.fixture = p_fixture;
+}
 
-			joint = joint->GetNext();
+inline bool Box2DWorld::accepts_cast_fixture(b2Fixture *p_caster, b2Fixture *p_fixture, bool p_ignore_rigid) {
+	if (p_fixture->IsSensor() || p_fixture->GetBody() == p_caster->GetBody()) {
+		return false;
+	}
+	if (p_ignore_rigid && p_fixture->GetBody()->GetType() == b2_dynamicBody) {
+		return false;
+	}
+	if (!filter_fixtures(p_caster, p_fixture)) {
+		return false;
+	}
+	return rule_table.size() == 0 || get_contact_rule(p_caster, p_fixture) != Box2DCollisionRules::RULE_SENSOR_ONLY;
+}
+
+bool Box2DWorld::cast_query_children(const LocalVector<QueryChild> &p_children, const b2Transform &p_xf, const b2Vec2 &p_motion, const Box2DShapeQueryParameters *p_params, QueryCallback &r_candidates, ShapeCastHit &r_hit, bool p_ignore_rigid) {
+	r_hit.fraction = 1.0f;
+	r_hit.fixture = NULL;
+
+	// A cast without motion can't hit anything. intersect_shape() covers overlaps.
+	if (p_children.size() == 0 || p_motion.LengthSquared() <= 0.0f) {
+		return false;
+	}
+
+	const b2Vec2 motion_min = b2Min(p_motion, b2Vec2_zero);
+	const b2Vec2 motion_max = b2Max(p_motion, b2Vec2_zero);
+
+	// One broad-phase pass over the bounds of the whole sweep
+	b2AABB bounds;
+	for (uint32_t i = 0; i < p_children.size(); ++i) {
+		b2AABB swept;
+		swept.lowerBound = p_children[i].aabb.lowerBound + p_xf.p + motion_min;
+		swept.upperBound = p_children[i].aabb.upperBound + p_xf.p + motion_max;
+		if (i == 0) {
+			bounds = swept;
+		} else {
+			bounds.Combine(swept);
+		}
+	}
+
+	r_candidates.results.clear();
+	world->QueryAABB(&r_candidates, bounds);
+	sort_unique(r_candidates.results);
+
+	b2Sweep sweep;
+	sweep.localCenter.SetZero();
+	sweep.c0 = p_xf.p;
+	sweep.c = p_xf.p + p_motion;
+	sweep.a0 = p_xf.q.GetAngle();
+	sweep.a = sweep.a0;
+	sweep.alpha0 = 0.0f;
+
+	for (uint32_t i = 0; i < r_candidates.results.size(); ++i) {
+		b2Fixture *fixture = r_candidates.results[i];
+		if (p_params && !accepts_query_fixture(p_params, fixture)) {
+			continue;
 		}
 
-		memdelete(world);
-		world = NULL;
+		const int32 other_children = fixture->GetShape()->GetChildCount();
+		for (uint32_t j = 0; j < p_children.size(); ++j) {
+			const QueryChild &child = p_children[j];
+			if (child.fixture && !accepts_cast_fixture(child.fixture, fixture, p_ignore_rigid)) {
+				continue;
+			}
+			const bool drop_through = child.fixture && child.fixture->GetBody()->GetUserData().owner->one_way_drop_through;
+
+			b2AABB swept;
+			swept.lowerBound = child.aabb.lowerBound + p_xf.p + motion_min;
+			swept.upperBound = child.aabb.upperBound + p_xf.p + motion_max;
+
+			for (int32 k = 0; k < other_children; ++k) {
+				// The proxy AABBs rule out most children of composite and chain shapes before the exact cast
+				if (b2TestOverlap(swept, fixture->GetAABB(k))) {
+					cast_child(child, sweep, p_motion, fixture, k, drop_through, r_hit);
+				}
+			}
+		}
 	}
+
+	return r_hit.fixture != NULL;
 }
 
-void Box2DWorld::_notification(int p_what) {
-	switch (p_what) {
-		case NOTIFICATION_PREDELETE: {
-			destroy_b2World();
-		} break;
+// Builds the manifold between two shape children the way b2Contact does. Sets r_flipped when the
+// manifold's A is p_shape_b. Edges and chains don't collide with each other.
+static bool collide_shape_children(b2Manifold &r_manifold, const b2Shape *p_shape_a, int32 p_child_a, const b2Transform *p_xf_a, const b2Shape *p_shape_b, int32 p_child_b, const b2Transform *p_xf_b, bool &r_flipped) {
+	// b2Contact's registry puts edges and chains first, then polygons, then circles
+	static const int order[b2Shape::e_typeCount] = { 0, 2, 1, 2 };
+	r_flipped = order[p_shape_a->GetType()] < order[p_shape_b->GetType()];
+	if (r_flipped) {
+		SWAP(p_shape_a, p_shape_b);
+		SWAP(p_child_a, p_child_b);
+		SWAP(p_xf_a, p_xf_b);
+	}
 
-		case NOTIFICATION_ENTER_TREE: {
-			// Create world
-			create_b2World();
-		} break;
+	b2EdgeShape chain_edge;
+	if (p_shape_a->GetType() == b2Shape::e_chain) {
+		static_cast<const b2ChainShape *>(p_shape_a)->GetChildEdge(&chain_edge, p_child_a);
+		p_shape_a = &chain_edge;
+	}
 
-		case NOTIFICATION_EXIT_TREE: {
-			// Don't destroy world. It could be exiting/entering.
-			// World should be destroyed in PREDELETE if node is being freed.
+	r_manifold.pointCount = 0;
+	const b2Shape::Type type_b = p_shape_b->GetType();
+	switch (p_shape_a->GetType()) {
+		case b2Shape::e_circle: {
+			b2CollideCircles(&r_manifold, static_cast<const b2CircleShape *>(p_shape_a), *p_xf_a, static_cast<const b2CircleShape *>(p_shape_b), *p_xf_b);
 		} break;
-
-		case NOTIFICATION_INTERNAL_PHYSICS_PROCESS: {
-			if (auto_step) {
-				float time = get_physics_process_delta_time();
-				step(time);
+		case b2Shape::e_polygon: {
+			if (type_b == b2Shape::e_circle) {
+				b2CollidePolygonAndCircle(&r_manifold, static_cast<const b2PolygonShape *>(p_shape_a), *p_xf_a, static_cast<const b2CircleShape *>(p_shape_b), *p_xf_b);
+			} else {
+				b2CollidePolygons(&r_manifold, static_cast<const b2PolygonShape *>(p_shape_a), *p_xf_a, static_cast<const b2PolygonShape *>(p_shape_b), *p_xf_b);
+			}
+		} break;
+		case b2Shape::e_edge: {
+			if (type_b == b2Shape::e_circle) {
+				b2CollideEdgeAndCircle(&r_manifold, static_cast<const b2EdgeShape *>(p_shape_a), *p_xf_a, static_cast<const b2CircleShape *>(p_shape_b), *p_xf_b);
+			} else if (type_b == b2Shape::e_polygon) {
+				b2CollideEdgeAndPolygon(&r_manifold, static_cast<const b2EdgeShape *>(p_shape_a), *p_xf_a, static_cast<const b2PolygonShape *>(p_shape_b), *p_xf_b);
 			}
 		} break;
+		default:
+			break;
 	}
+	return r_manifold.pointCount > 0;
 }
 
-void Box2DWorld::_bind_methods() {
-	ClassDB::bind_method(D_METHOD("set_gravity", "gravity"), &Box2DWorld::set_gravity);
-	ClassDB::bind_method(D_METHOD("get_gravity"), &Box2DWorld::get_gravity);
-	ClassDB::bind_method(D_METHOD("set_auto_step", "auto_setp"), &Box2DWorld::set_auto_step);
-	ClassDB::bind_method(D_METHOD("get_auto_step"), &Box2DWorld::get_auto_step);
+b2Vec2 Box2DWorld::separate_query_children(const LocalVector<QueryChild> &p_children, b2Transform &r_xf, QueryCallback &r_candidates, bool p_ignore_rigid) {
+	// Each pass resolves the deepest overlap, which usually resolves the rest with it
+	const int max_passes = 4;
+	b2Vec2 separation = b2Vec2_zero;
+
+	for (int pass = 0; pass < max_passes && p_children.size() > 0; ++pass) {
+		b2AABB bounds;
+		for (uint32_t i = 0; i < p_children.size(); ++i) {
+			b2AABB aabb;
+			aabb.lowerBound = p_children[i].aabb.lowerBound + r_xf.p;
+			aabb.upperBound = p_children[i].aabb.upperBound + r_xf.p;
+			if (i == 0) {
+				bounds = aabb;
+			} else {
+				bounds.Combine(aabb);
+			}
+		}
 
-	//ClassDB::bind_method(D_METHOD("query_aabb", "bounds"), &Box2DWorld::query_aabb);
-	ClassDB::bind_method(D_METHOD("intersect_point", "point"), &Box2DWorld::intersect_point, DEFVAL(32));
-	//ClassDB::bind_method(D_METHOD("intersect_shape", "TODO"), &Box2DWorld::intersect_shape);
-	ClassDB::bind_method(D_METHOD("step", "delta"), &Box2DWorld::step);
+		r_candidates.results.clear();
+		world->QueryAABB(&r_candidates, bounds);
+		sort_unique(r_candidates.results);
 
-	ADD_PROPERTY(PropertyInfo(Variant::VECTOR2, "gravity"), "set_gravity", "get_gravity");
-	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "auto_step"), "set_auto_step", "get_auto_step");
+		// Overlaps within the slop are resting contact, and left alone like Box2D's position solver does
+		float deepest = b2_linearSlop;
+		b2Vec2 push = b2Vec2_zero;
+
+		for (uint32_t i = 0; i < r_candidates.results.size(); ++i) {
+			b2Fixture *fixture = r_candidates.results[i];
+			const b2Body *other_body = fixture->GetBody();
+			const b2Transform &other_xf = other_body->GetTransform();
+			const b2FixtureUserData &data = fixture->GetUserData();
+
+			for (uint32_t j = 0; j < p_children.size(); ++j) {
+				const QueryChild &child = p_children[j];
+				if (!child.fixture || !accepts_cast_fixture(child.fixture, fixture, p_ignore_rigid)) {
+					continue;
+				}
+
+				b2AABB aabb;
+				aabb.lowerBound = child.aabb.lowerBound + r_xf.p;
+				aabb.upperBound = child.aabb.upperBound + r_xf.p;
+
+				for (int32 k = 0; k < fixture->GetShape()->GetChildCount(); ++k) {
+					b2Manifold manifold;
+					bool flipped;
+					if (!b2TestOverlap(aabb, fixture->GetAABB(k)) || !collide_shape_children(manifold, child.shape, child.child, &r_xf, fixture->GetShape(), k, &other_xf, flipped)) {
+						continue;
+					}
+
+					b2WorldManifold world_manifold;
+					if (flipped) {
+						world_manifold.Initialize(&manifold, other_xf, fixture->GetShape()->m_radius, r_xf, child.shape->m_radius);
+					} else {
+						world_manifold.Initialize(&manifold, r_xf, child.shape->m_radius, other_xf, fixture->GetShape()->m_radius);
+					}
+					// The manifold normal points from A to B. Turn it away from the other fixture.
+					const b2Vec2 away = flipped ? world_manifold.normal : -world_manifold.normal;
+
+					for (int32 p = 0; p < manifold.pointCount; ++p) {
+						const float depth = -world_manifold.separations[p];
+						if (depth <= deepest) {
+							continue;
+						}
+
+						// One-way fixtures only push out of their open side, and only as deep as a landing, like passes_one_way()
+						if (data.one_way) {
+							const b2Vec2 up = b2Mul(other_xf.q, b2Vec2(data.one_way_normal_x, data.one_way_normal_y));
+							const float allowed_depth = data.one_way_margin + MAX(b2Dot(other_body->GetLinearVelocityFromWorldPoint(world_manifold.points[p]), up), 0.0f) * last_step_delta;
+							if (child.fixture->GetBody()->GetUserData().owner->one_way_drop_through || b2Dot(away, up) <= 0.0f || depth > allowed_depth) {
+								continue;
+							}
+						}
+
+						deepest = depth;
+						push = away;
+					}
+				}
+			}
+		}
+
+		if (push.LengthSquared() <= 0.0f) {
+			break;
+		}
+		r_xf.p += deepest * push;
+		separation += deepest * push;
+	}
+
+	return separation;
 }
 
-void Box2DWorld::step(real_t p_step) {
-	//print_line(("step: " + std::to_string(p_step)
-	//		+ ", gravity: ("
-	//		+ std::to_string(world->GetGravity().x) + ", "
-	//		+ std::to_string(world->GetGravity().y) + ")")
-	//	.c_str());
+Dictionary Box2DWorld::cast_shape(const Ref<Box2DShapeQueryParameters> &p_params, const Vector2 &p_motion) {
+	ERR_FAIL_COND_V(p_params.is_null(), Dictionary());
+	ERR_FAIL_COND_V(!world, Dictionary());
 
-	// Reset contact "solves" counter to 0
-	const uint64_t *k = NULL;
-	while ((k = contact_buffer.next(k))) {
-		ContactBufferManifold *buffer_manifold = contact_buffer.getptr(*k);
-		for (int i = 0; i < buffer_manifold->count; ++i) {
-			buffer_manifold->points[i].reset_accum();
+	const b2Transform xf = gd_to_b2(p_params->get_transform());
+	LocalVector<QueryChild> children;
+	b2AABB child_bounds;
+	if (!build_query_children(p_params->get_shape(), b2Transform(b2Vec2_zero, xf.q), children, child_bounds)) {
+		return Dictionary();
+	}
+
+	// The broad-phase is only safe to read outside of Step
+	wait_for_step();
+
+	QueryCallback candidates;
+	ShapeCastHit hit;
+	if (!cast_query_children(children, xf, gd_to_b2(p_motion), p_params.ptr(), candidates, hit)) {
+		return Dictionary();
+	}
+
+	const Box2DFixture *owner = hit.fixture->GetUserData().owner;
+	Dictionary d;
+	d["fraction"] = hit.fraction;
+	d["point"] = b2_to_gd(hit.point);
+	d["normal"] = Vector2(hit.normal.x, hit.normal.y);
+	d["fixture"] = owner->get_instance_id();
+	d["body"] = owner->body_node->get_instance_id();
+	return d;
+}
+
+void Box2DWorld::_cast_shape_chunk(uint32_t p_index, ShapeCastBatch *p_batch) {
+	const uint32_t begin = p_index * p_batch->chunk_size;
+	const uint32_t end = MIN(begin + p_batch->chunk_size, p_batch->count);
+	LocalVector<ShapeCastHit> &hits = p_batch->chunk_hits[p_index];
+
+	QueryCallback candidates;
+	ShapeCastHit hit;
+	for (uint32_t i = begin; i < end; ++i) {
+		const b2Transform xf(gd_to_b2(p_batch->origins[i]), p_batch->rotation);
+		if (cast_query_children(*p_batch->children, xf, gd_to_b2(p_batch->motions[i]), p_batch->params, candidates, hit)) {
+			hit.cast = i;
+			hits.push_back(hit);
 		}
 	}
+}
 
-	world->Step(p_step, 8, 8);
-	flag_rescan_contacts_monitored = false;
+Dictionary Box2DWorld::cast_shape_batch(const Ref<Box2DShapeQueryParameters> &p_params, const PackedVector2Array &p_origins, const PackedVector2Array &p_motions) {
+	ERR_FAIL_COND_V(p_params.is_null(), Dictionary());
+	ERR_FAIL_COND_V_MSG(p_origins.size() != p_motions.size(), Dictionary(), "origins and motions must be the same size.");
+	ERR_FAIL_COND_V(!world, Dictionary());
+	// Chunks run on group_pool, which is shared with grouped stepping and can only run one job at a time
+	ERR_FAIL_COND_V_MSG(Thread::get_caller_id() != Thread::get_main_id(), Dictionary(), "cast_shape_batch() can only be called from the main thread.");
+
+	// The children are built once at the shared rotation and offset per cast
+	const b2Rot rotation(p_params->get_transform().get_rotation());
+	LocalVector<QueryChild> children;
+	b2AABB child_bounds;
+	if (!build_query_children(p_params->get_shape(), b2Transform(b2Vec2_zero, rotation), children, child_bounds)) {
+		return Dictionary();
+	}
+
+	// The broad-phase is only safe to read outside of Step
+	wait_for_step();
+
+	// Casts per chunk. A shape cast costs several raycasts, so smaller chunks still pay for the thread handoff.
+	const uint32_t min_chunk_size = 16;
+
+	ShapeCastBatch batch;
+	batch.params = p_params.ptr();
+	batch.children = &children;
+	batch.rotation = rotation;
+	batch.origins = p_origins.ptr();
+	batch.motions = p_motions.ptr();
+	batch.count = p_origins.size();
+
+	// Casts only read the world. The TOI and GJK profiling counters they update are per thread (see b2patch/collision/).
+	const uint32_t threads = MAX(OS::get_singleton()->get_processor_count(), 1);
+	const uint32_t chunks = CLAMP(batch.count / min_chunk_size, 1u, threads);
+	batch.chunk_size = (batch.count + chunks - 1) / chunks;
+	batch.chunk_hits.resize(chunks);
+
+	if (chunks > 1) {
+		init_group_pool();
+		group_pool.do_work(chunks, this, &Box2DWorld::_cast_shape_chunk, &batch);
+	} else {
+		_cast_shape_chunk(0, &batch);
+	}
+
+	uint32_t hit_count = 0;
+	for (uint32_t i = 0; i < chunks; ++i) {
+		hit_count += batch.chunk_hits[i].size();
+	}
+
+	PackedInt32Array casts;
+	PackedFloat32Array fractions;
+	PackedVector2Array points;
+	PackedVector2Array normals;
+	PackedInt64Array fixtures;
+	casts.resize(hit_count);
+	fractions.resize(hit_count);
+	points.resize(hit_count);
+	normals.resize(hit_count);
+	fixtures.resize(hit_count);
+
+	// Chunks cover consecutive casts, so appending them in order keeps hits sorted by cast
+	int32_t *casts_w = casts.ptrw();
+	float *fractions_w = fractions.ptrw();
+	Vector2 *points_w = points.ptrw();
+	Vector2 *normals_w = normals.ptrw();
+	int64_t *fixtures_w = fixtures.ptrw();
+	uint32_t n = 0;
+	for (uint32_t i = 0; i < chunks; ++i) {
+		const LocalVector<ShapeCastHit> &hits = batch.chunk_hits[i];
+		for (uint32_t j = 0; j < hits.size(); ++j, ++n) {
+			casts_w[n] = hits[j].cast;
+			fractions_w[n] = hits[j].fraction;
+			points_w[n] = b2_to_gd(hits[j].point);
+			normals_w[n] = Vector2(hits[j].normal.x, hits[j].normal.y);
+			fixtures_w[n] = hits[j].fixture->GetUserData().owner->get_instance_id();
+		}
+	}
+
+	Dictionary d;
+	d["cast"] = casts;
+	d["fraction"] = fractions;
+	d["point"] = points;
+	d["normal"] = normals;
+	d["fixture"] = fixtures;
+	return d;
 }
 
-void Box2DWorld::set_gravity(const Vector2 &p_gravity) {
-	if (world)
-		world->SetGravity(gd_to_b2(p_gravity));
-	gravity = p_gravity;
+void Box2DWorld::raycast_range(uint32_t p_begin, uint32_t p_end, const RaycastBatch &p_batch, LocalVector<RaycastHit> &r_hits) const {
+	RaycastCallback callback;
+	callback.hits = &r_hits;
+	callback.collision_mask = p_batch.collision_mask;
+	callback.mode = p_batch.mode;
+
+	for (uint32_t i = p_begin; i < p_end; ++i) {
+		const b2Vec2 from = gd_to_b2(p_batch.from[i]);
+		const b2Vec2 to = gd_to_b2(p_batch.to[i]);
+		// b2DynamicTree::RayCast asserts on zero-length rays
+		if ((to - from).LengthSquared() <= 0.0f) {
+			continue;
+		}
+
+		callback.ray = i;
+		callback.has_closest = false;
+		const uint32_t first_hit = r_hits.size();
+
+		world->RayCast(&callback, from, to);
+
+		if (p_batch.mode == RAYCAST_CLOSEST) {
+			if (callback.has_closest) {
+				r_hits.push_back(callback.closest);
+			}
+		} else if (p_batch.mode == RAYCAST_ALL && r_hits.size() - first_hit > 1) {
+			SortArray<RaycastHit, RaycastHitComparator> sorter;
+			sorter.sort(&r_hits[first_hit], r_hits.size() - first_hit);
+		}
+	}
 }
 
-Vector2 Box2DWorld::get_gravity() const {
-	return gravity;
+void Box2DWorld::_raycast_chunk(uint32_t p_index, RaycastBatch *p_batch) {
+	const uint32_t begin = p_index * p_batch->chunk_size;
+	const uint32_t end = MIN(begin + p_batch->chunk_size, p_batch->count);
+	raycast_range(begin, end, *p_batch, p_batch->chunk_hits[p_index]);
 }
 
-void Box2DWorld::set_auto_step(bool p_auto_step) {
-	auto_step = p_auto_step;
+Dictionary Box2DWorld::raycast_batch(const PackedVector2Array &p_from, const PackedVector2Array &p_to, uint32_t p_collision_mask, RaycastMode p_mode) {
+	ERR_FAIL_COND_V_MSG(p_from.size() != p_to.size(), Dictionary(), "from and to must be the same size.");
+	ERR_FAIL_COND_V(!world, Dictionary());
+	// Chunks run on group_pool, which is shared with grouped stepping and can only run one job at a time
+	ERR_FAIL_COND_V_MSG(Thread::get_caller_id() != Thread::get_main_id(), Dictionary(), "raycast_batch() can only be called from the main thread.");
+	// The broad-phase is only safe to read outside of Step
+	wait_for_step();
+
+	// Rays per chunk. Smaller batches aren't worth the thread handoff.
+	const uint32_t min_chunk_size = 64;
+
+	RaycastBatch batch;
+	batch.from = p_from.ptr();
+	batch.to = p_to.ptr();
+	batch.count = p_from.size();
+	batch.collision_mask = p_collision_mask;
+	batch.mode = p_mode;
+
+	const uint32_t threads = MAX(OS::get_singleton()->get_processor_count(), 1);
+	const uint32_t chunks = CLAMP(batch.count / min_chunk_size, 1u, threads);
+	batch.chunk_size = (batch.count + chunks - 1) / chunks;
+	batch.chunk_hits.resize(chunks);
+
+	if (chunks > 1) {
+		init_group_pool();
+		group_pool.do_work(chunks, this, &Box2DWorld::_raycast_chunk, &batch);
+	} else {
+		raycast_range(0, batch.count, batch, batch.chunk_hits[0]);
+	}
+
+	uint32_t hit_count = 0;
+	for (uint32_t i = 0; i < chunks; ++i) {
+		hit_count += batch.chunk_hits[i].size();
+	}
+
+	PackedInt32Array rays;
+	PackedVector2Array points;
+	PackedVector2Array normals;
+	PackedFloat32Array fractions;
+	PackedInt64Array fixtures;
+	rays.resize(hit_count);
+	points.resize(hit_count);
+	normals.resize(hit_count);
+	fractions.resize(hit_count);
+	fixtures.resize(hit_count);
+
+	// Chunks cover consecutive rays, so appending them in order keeps hits sorted by ray
+	int32_t *rays_w = rays.ptrw();
+	Vector2 *points_w = points.ptrw();
+	Vector2 *normals_w = normals.ptrw();
+	float *fractions_w = fractions.ptrw();
+	int64_t *fixtures_w = fixtures.ptrw();
+	uint32_t n = 0;
+	for (uint32_t i = 0; i < chunks; ++i) {
+		const LocalVector<RaycastHit> &hits = batch.chunk_hits[i];
+		for (uint32_t j = 0; j < hits.size(); ++j, ++n) {
+			rays_w[n] = hits[j].ray;
+			points_w[n] = b2_to_gd(hits[j].point);
+			normals_w[n] = Vector2(hits[j].normal.x, hits[j].normal.y);
+			fractions_w[n] = hits[j].fraction;
+			fixtures_w[n] = hits[j].fixture;
+		}
+	}
+
+	Dictionary d;
+	d["ray"] = rays;
+	d["point"] = points;
+	d["normal"] = normals;
+	d["fraction"] = fractions;
+	d["fixture"] = fixtures;
+	return d;
 }
 
-bool Box2DWorld::get_auto_step() const {
-	return auto_step;
+void Box2DWorld::run_fixture_query(FixtureQueryCallback &p_callback, const b2AABB &p_aabb, LocalVector<uint64_t> &r_fixtures, LocalVector<uint64_t> &r_bodies, int p_max_results, uint32_t p_collision_mask, const VSet<uint64_t> &p_exclude) {
+	r_fixtures.clear();
+	r_bodies.clear();
+	if (p_max_results <= 0) {
+		return;
+	}
+
+	p_callback.fixtures = &r_fixtures;
+	p_callback.bodies = &r_bodies;
+	p_callback.max_results = p_max_results;
+	p_callback.collision_mask = p_collision_mask;
+	p_callback.exclude = &p_exclude;
+
+	// The broad-phase is only safe to read outside of Step
+	wait_for_step();
+	world->QueryAABB(&p_callback, p_aabb);
+}
+
+int Box2DWorld::intersect_point_ids(const Vector2 &p_point, LocalVector<uint64_t> &r_fixtures, LocalVector<uint64_t> &r_bodies, int p_max_results, uint32_t p_collision_mask, const VSet<uint64_t> &p_exclude) {
+	ERR_FAIL_COND_V(!world, 0);
+
+	FixtureQueryCallback callback;
+	callback.test_point = true;
+	callback.point = gd_to_b2(p_point);
+
+	b2AABB aabb;
+	aabb.lowerBound = callback.point;
+	aabb.upperBound = callback.point;
+	run_fixture_query(callback, aabb, r_fixtures, r_bodies, p_max_results, p_collision_mask, p_exclude);
+	return r_fixtures.size();
+}
+
+int Box2DWorld::query_aabb_ids(const Rect2 &p_bounds, LocalVector<uint64_t> &r_fixtures, LocalVector<uint64_t> &r_bodies, int p_max_results, uint32_t p_collision_mask, const VSet<uint64_t> &p_exclude) {
+	ERR_FAIL_COND_V(!world, 0);
+
+	FixtureQueryCallback callback;
+	callback.bounds = gd_to_b2(p_bounds.abs());
+	run_fixture_query(callback, callback.bounds, r_fixtures, r_bodies, p_max_results, p_collision_mask, p_exclude);
+	return r_fixtures.size();
+}
+
+static void collect_exclusions(const Array &p_exclude, VSet<uint64_t> &r_exclude) {
+	for (int i = 0; i < p_exclude.size(); i++) {
+		Object *obj = p_exclude[i];
+		ERR_CONTINUE_MSG(!Object::cast_to<Box2DPhysicsBody>(obj) && !Object::cast_to<Box2DFixture>(obj), "Only Box2DPhysicsBody and Box2DFixture nodes can be excluded.");
+		r_exclude.insert(obj->get_instance_id());
+	}
 }
 
-Array Box2DWorld::intersect_point(const Vector2 &p_point, int p_max_results) { //, const Vector<Ref<Box2DPhysicsBody> > &p_exclude/*, uint32_t p_layers*/) {
-	pointCallback.results.clear();
-	pointCallback.point = gd_to_b2(p_point);
-	//pointCallback.exclude.clear();
-	//for (int i = 0; i < p_exclude.size(); i++)
-	//	pointCallback.exclude.insert(p_exclude[i]);
-	world->QueryAABB(&pointCallback, gd_to_b2(Rect2(p_point, Size2(0, 0))));
-
-	int n = pointCallback.results.size();
-	Array arr;
-	arr.resize(n);
-	for (int i = 0; i < n; i++) {
-		b2Fixture *fixture = pointCallback.results.get(i);
-
-		Dictionary d;
-		d["body"] = fixture->GetBody()->GetUserData().owner;
-		d["fixture"] = fixture->GetUserData().owner;
-		// TODO do we really need to return a dict, or can we just return an
-		//      array of Box2DFixture objects and let the user get data from just that?
-
-		arr[i] = d;
-	}
-
-	return arr;
-}
-
-//Array Box2DWorld::query_aabb(const Rect2 &p_bounds) {
-//	aabbCallback.results.clear();
-//	world->QueryAABB(&aabbCallback, gd_to_b2(p_bounds));
-//
-//	int n = aabbCallback.results.size();
-//	Array arr;
-//	arr.resize(n);
-//	for (int i = 0; i < n; i++) {
-//		b2Fixture *fixture = aabbCallback.results.get(i);
-//
-//		Dictionary d;
-//		d["body"] = fixture->GetBody()->GetUserData().owner;
-//		d["fixture"] = fixture->GetUserData().owner;
-//		// TODO do we really need to return a dict, or can we just return an
-//		//      array of Box2DFixture objects and let the user get data from just that?
-//
-//		arr[i] = d;
-//	}
-//
-//	return arr;
-//}
+static Dictionary pack_query_ids(const LocalVector<uint64_t> &p_fixtures, const LocalVector<uint64_t> &p_bodies) {
+	PackedInt64Array fixtures;
+	PackedInt64Array bodies;
+	fixtures.resize(p_fixtures.size());
+	bodies.resize(p_bodies.size());
+	int64_t *fixtures_w = fixtures.ptrw();
+	int64_t *bodies_w = bodies.ptrw();
+	for (uint32_t i = 0; i < p_fixtures.size(); ++i) {
+		fixtures_w[i] = p_fixtures[i];
+		bodies_w[i] = p_bodies[i];
+	}
+
+	Dictionary d;
+	d["fixture"] = fixtures;
+	d["body"] = bodies;
+	return d;
+}
+
+Dictionary Box2DWorld::intersect_point(const Vector2 &p_point, int p_max_results, uint32_t p_collision_mask, const Array &p_exclude) {
+	VSet<uint64_t> exclude;
+	collect_exclusions(p_exclude, exclude);
+
+	LocalVector<uint64_t> fixtures;
+	LocalVector<uint64_t> bodies;
+	intersect_point_ids(p_point, fixtures, bodies, p_max_results, p_collision_mask, exclude);
+	return pack_query_ids(fixtures, bodies);
+}
+
+Dictionary Box2DWorld::query_aabb(const Rect2 &p_bounds, int p_max_results, uint32_t p_collision_mask, const Array &p_exclude) {
+	VSet<uint64_t> exclude;
+	collect_exclusions(p_exclude, exclude);
+
+	LocalVector<uint64_t> fixtures;
+	LocalVector<uint64_t> bodies;
+	query_aabb_ids(p_bounds, fixtures, bodies, p_max_results, p_collision_mask, exclude);
+	return pack_query_ids(fixtures, bodies);
+}
 
 Box2DWorld::Box2DWorld() :
 		world(NULL) {
@@ -546,6 +3011,8 @@ Box2DWorld::Box2DWorld() :
 }
 
 Box2DWorld::~Box2DWorld() {
+	stop_step_thread();
+
 	// Make sure Box2D memory is cleaned up
 	if (world) {
 		WARN_PRINT("b2World is being deleted in destructor, not NOTIFICATION_PREDELETE.");
@@ -559,8 +3026,141 @@ bool Box2DWorld::QueryCallback::ReportFixture(b2Fixture *fixture) {
 	return true;
 }
 
-bool Box2DWorld::IntersectPointCallback::ReportFixture(b2Fixture *fixture) {
-	if (fixture->TestPoint(point)) // && exclude.find(fixture->GetBody()->GetUserData().owner) > 0)
-		results.push_back(fixture);
-	return results.size() < max_results;
+float Box2DWorld::RaycastCallback::ReportFixture(b2Fixture *fixture, const b2Vec2 &point, const b2Vec2 &normal, float fraction) {
+	// Like Godot's raycasts, sensors are ignored
+	if (fixture->IsSensor() || (fixture->GetFilterData().categoryBits & collision_mask) == 0) {
+		return -1.0f;
+	}
+
+	RaycastHit hit;
+	hit.ray = ray;
+	hit.point = point;
+	hit.normal = normal;
+	hit.fraction = fraction;
+	hit.fixture = fixture->GetUserData().owner->get_instance_id();
+
+	switch (mode) {
+		case RAYCAST_CLOSEST: {
+			// Clip the ray, so only nearer fixtures are reported from here on
+			closest = hit;
+			has_closest = true;
+			return fraction;
+		}
+		case RAYCAST_ANY: {
+			hits->push_back(hit);
+			return 0.0f;
+		}
+		case RAYCAST_ALL: {
+			hits->push_back(hit);
+			return 1.0f;
+		}
+	}
+	return 1.0f;
+}
+
+bool Box2DWorld::FixtureQueryCallback::ReportFixture(b2Fixture *fixture) {
+	if ((fixture->GetFilterData().categoryBits & collision_mask) == 0) {
+		return true;
+	}
+
+	const Box2DFixture *owner = fixture->GetUserData().owner;
+	const uint64_t id = owner->get_instance_id();
+	const uint64_t body_id = owner->body_node->get_instance_id();
+	if (exclude->size() > 0 && (exclude->has(id) || exclude->has(body_id))) {
+		return true;
+	}
+
+	if (test_point) {
+		if (!fixture->TestPoint(point)) {
+			return true;
+		}
+	} else {
+		// The proxies are fattened, so test the shape's tight AABB
+		const b2Transform &xf = fixture->GetBody()->GetTransform();
+		bool overlapping = false;
+		for (int32 i = 0; i < fixture->GetShape()->GetChildCount() && !overlapping; ++i) {
+			b2AABB aabb;
+			fixture->GetShape()->ComputeAABB(&aabb, xf, i);
+			overlapping = b2TestOverlap(aabb, bounds);
+		}
+		if (!overlapping) {
+			return true;
+		}
+	}
+
+	// Fixture nodes with composite shapes own several b2Fixtures, but are reported once
+	if (owner->fixtures.size() > 1 && fixtures->find(id) >= 0) {
+		return true;
+	}
+
+	fixtures->push_back(id);
+	bodies->push_back(body_id);
+	return fixtures->size() < max_results;
+}
+
+void Box2DShapeQueryParameters::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_shape", "shape"), &Box2DShapeQueryParameters::set_shape);
+	ClassDB::bind_method(D_METHOD("get_shape"), &Box2DShapeQueryParameters::get_shape);
+	ClassDB::bind_method(D_METHOD("set_transform", "transform"), &Box2DShapeQueryParameters::set_transform);
+	ClassDB::bind_method(D_METHOD("get_transform"), &Box2DShapeQueryParameters::get_transform);
+	ClassDB::bind_method(D_METHOD("set_collision_mask", "collision_mask"), &Box2DShapeQueryParameters::set_collision_mask);
+	ClassDB::bind_method(D_METHOD("get_collision_mask"), &Box2DShapeQueryParameters::get_collision_mask);
+	ClassDB::bind_method(D_METHOD("set_collide_with_sensors", "enabled"), &Box2DShapeQueryParameters::set_collide_with_sensors);
+	ClassDB::bind_method(D_METHOD("is_collide_with_sensors_enabled"), &Box2DShapeQueryParameters::is_collide_with_sensors_enabled);
+	ClassDB::bind_method(D_METHOD("set_exclude", "exclude"), &Box2DShapeQueryParameters::set_exclude);
+	ClassDB::bind_method(D_METHOD("get_exclude"), &Box2DShapeQueryParameters::get_exclude);
+
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "shape", PROPERTY_HINT_RESOURCE_TYPE, "Box2DShape"), "set_shape", "get_shape");
+	ADD_PROPERTY(PropertyInfo(Variant::TRANSFORM2D, "transform"), "set_transform", "get_transform");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "collision_mask", PROPERTY_HINT_LAYERS_2D_PHYSICS), "set_collision_mask", "get_collision_mask");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "collide_with_sensors"), "set_collide_with_sensors", "is_collide_with_sensors_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::ARRAY, "exclude"), "set_exclude", "get_exclude");
+}
+
+void Box2DShapeQueryParameters::set_shape(const Ref<Box2DShape> &p_shape) {
+	shape = p_shape;
+}
+
+Ref<Box2DShape> Box2DShapeQueryParameters::get_shape() const {
+	return shape;
+}
+
+void Box2DShapeQueryParameters::set_transform(const Transform2D &p_transform) {
+	transform = p_transform;
+}
+
+Transform2D Box2DShapeQueryParameters::get_transform() const {
+	return transform;
+}
+
+void Box2DShapeQueryParameters::set_collision_mask(uint32_t p_mask) {
+	collision_mask = p_mask;
+}
+
+uint32_t Box2DShapeQueryParameters::get_collision_mask() const {
+	return collision_mask;
+}
+
+void Box2DShapeQueryParameters::set_collide_with_sensors(bool p_enabled) {
+	collide_with_sensors = p_enabled;
+}
+
+bool Box2DShapeQueryParameters::is_collide_with_sensors_enabled() const {
+	return collide_with_sensors;
+}
+
+void Box2DShapeQueryParameters::set_exclude(const Array &p_exclude) {
+	exclude.clear();
+	collect_exclusions(p_exclude, exclude);
+}
+
+Array Box2DShapeQueryParameters::get_exclude() const {
+	Array ret;
+	for (int i = 0; i < exclude.size(); i++) {
+		Object *obj = ObjectDB::get_instance(ObjectID(exclude[i]));
+		if (obj) {
+			ret.append(obj);
+		}
+	}
+	return ret;
 }
@@ -4,6 +4,11 @@
 #include <core/io/resource.h>
 #include <core/object/object.h>
 #include <core/object/reference.h>
+#include <core/os/semaphore.h>
+#include <core/os/thread.h>
+#include <core/templates/local_vector.h>
+#include <core/templates/thread_work_pool.h>
+#include <core/templates/vset.h>
 #include <scene/2d/node_2d.h>
 
 #include <box2d/b2_contact.h>
@@ -12,7 +17,11 @@
 #include <box2d/b2_world.h>
 #include <box2d/b2_world_callbacks.h>
 
+#include "../../util/box2d_pair_set.h"
+#include "../../util/box2d_task_executor.h"
 #include "../../util/box2d_types_converter.h"
+#include "../resources/box2d_collision_rules.h"
+#include "../resources/box2d_shapes.h"
 
 /**
 * @author Brian Semrau
@@ -20,11 +29,11 @@
 
 class Box2DShape;
 
+// A contact point between two fixtures. Stored once in Box2DWorld's contact pool, in the A/B order Box2D reports it.
+// Monitors on body B read it through flipped_a_b(), so fixture_a is always the monitoring body's fixture.
 struct Box2DContactPoint {
-	// This ID is required for inserting this object into a VSet
-	int32_t id = -1;
-
-	int solves = 0; // TODO might belong inside ContactBufferManifold, but probably not
+	// Box2DWorld::step_epoch of the step this contact was first solved in. Compared instead of resetting every contact each step.
+	uint32_t solve_epoch = 0;
 	Box2DFixture *fixture_a = NULL;
 	Box2DFixture *fixture_b = NULL;
 	Vector2 world_pos = Vector2();
@@ -33,13 +42,9 @@ struct Box2DContactPoint {
 	float normal_impulse = 0;
 	Vector2 tangent_impulse = Vector2();
 
-	bool operator<(const Box2DContactPoint &p_c) const {
-		return id < p_c.id;
-	}
-
-	inline void reset_accum() {
-		solves = 0;
-	}
+	// Index of this contact in the contact monitor of body A/B, or -1 if that monitor doesn't report it
+	int32_t monitor_index_a = -1;
+	int32_t monitor_index_b = -1;
 
 	inline Box2DContactPoint flipped_a_b() const {
 		Box2DContactPoint ret(*this);
@@ -47,17 +52,100 @@ struct Box2DContactPoint {
 		ret.fixture_b = fixture_a;
 		ret.normal = -ret.normal;
 		ret.tangent_impulse = -ret.tangent_impulse;
+		ret.monitor_index_a = monitor_index_b;
+		ret.monitor_index_b = monitor_index_a;
 		return ret;
 	}
 };
 
+// Contacts between a body in pair summary mode and one other body, aggregated over the latest step
+struct Box2DContactPairSummary {
+	ObjectID body;
+	float total_impulse = 0.0f;
+	float max_impulse = 0.0f;
+	Vector2 point_sum = Vector2();
+	Vector2 normal_sum = Vector2();
+	int point_count = 0;
+};
+
+// Reference to a contact in a Box2DContactPool. A slot's generation is bumped when its contact is freed,
+// so a stale handle never resolves to the slot's next occupant.
+struct Box2DContactHandle {
+	uint32_t index = UINT32_MAX;
+	uint32_t generation = 0;
+
+	_FORCE_INLINE_ bool is_valid() const { return index != UINT32_MAX; }
+};
+
+class Box2DContactPool {
+	struct Slot {
+		Box2DContactPoint contact;
+		uint32_t generation = 0;
+		uint32_t next_free = UINT32_MAX;
+	};
+
+	LocalVector<Slot> slots;
+	uint32_t free_head = UINT32_MAX;
+
+public:
+	// Pointers returned by get() are invalidated by the next alloc()
+	Box2DContactHandle alloc() {
+		uint32_t index;
+		if (free_head != UINT32_MAX) {
+			index = free_head;
+			free_head = slots[index].next_free;
+		} else {
+			index = slots.size();
+			slots.push_back(Slot());
+		}
+
+		Slot &slot = slots[index];
+		slot.contact = Box2DContactPoint();
+		slot.next_free = UINT32_MAX;
+
+		Box2DContactHandle handle;
+		handle.index = index;
+		handle.generation = slot.generation;
+		return handle;
+	}
+
+	void free(const Box2DContactHandle &p_handle) {
+		ERR_FAIL_COND(!get(p_handle));
+		Slot &slot = slots[p_handle.index];
+		++slot.generation;
+		slot.next_free = free_head;
+		free_head = p_handle.index;
+	}
+
+	_FORCE_INLINE_ Box2DContactPoint *get(const Box2DContactHandle &p_handle) {
+		if (p_handle.index < slots.size() && slots[p_handle.index].generation == p_handle.generation) {
+			return &slots[p_handle.index].contact;
+		}
+		return NULL;
+	}
+
+	_FORCE_INLINE_ const Box2DContactPoint *get(const Box2DContactHandle &p_handle) const {
+		if (p_handle.index < slots.size() && slots[p_handle.index].generation == p_handle.generation) {
+			return &slots[p_handle.index].contact;
+		}
+		return NULL;
+	}
+
+	// Only valid once every handle has been dropped, since generations restart
+	void clear() {
+		slots.clear();
+		free_head = UINT32_MAX;
+	}
+};
+
 struct ContactBufferManifold {
-	Box2DContactPoint points[b2_maxManifoldPoints];
+	b2Contact *contact = NULL;
+	Box2DContactHandle points[b2_maxManifoldPoints];
 	int count = 0;
 
 	// TODO Optimize? These functions may be overkill, but everything currently works this way
 
-	inline void insert(Box2DContactPoint &p_point, int p_idx) {
+	inline void insert(const Box2DContactHandle &p_point, int p_idx) {
 		ERR_FAIL_COND(count + 1 > b2_maxManifoldPoints);
 		ERR_FAIL_COND(p_idx < 0 || p_idx >= b2_maxManifoldPoints);
 		ERR_FAIL_COND(p_idx > count); // Can't insert a point leaving a null at the index below
@@ -82,76 +170,495 @@ struct ContactBufferManifold {
 				// There's a buffer overflow warning for this line but I don't believe it
 				points[i] = points[i + 1];
 			}
-			points[count - 1].id = -1;
+			points[count - 1] = Box2DContactHandle();
 		}
 
 		--count;
 	}
 };
 
+// Parameters for Box2DWorld shape queries. The transform is in Box2DWorld space. Box2D transforms are
+// rigid, so only its origin and rotation are used.
 class Box2DShapeQueryParameters : public Reference {
 	GDCLASS(Box2DShapeQueryParameters, Reference);
 
 	Ref<Box2DShape> shape;
 	Transform2D transform;
-	//Vector2 motion; // TODO does Box2D support this?
-	//Set<Ref<Box2DPhysicsBody>> exclude; // TODO figure out how to use nodes as parameters in bound methods
-	uint32_t collision_mask;
+	uint32_t collision_mask = 0xFFFF;
+	bool collide_with_sensors = false;
+	// Instance IDs of excluded bodies and fixtures
+	VSet<uint64_t> exclude;
 
-	// TODO a bunch of shit ugh
+protected:
+	static void _bind_methods();
+
+public:
+	void set_shape(const Ref<Box2DShape> &p_shape);
+	Ref<Box2DShape> get_shape() const;
+
+	void set_transform(const Transform2D &p_transform);
+	Transform2D get_transform() const;
+
+	void set_collision_mask(uint32_t p_mask);
+	uint32_t get_collision_mask() const;
+
+	void set_collide_with_sensors(bool p_enabled);
+	bool is_collide_with_sensors_enabled() const;
+
+	// Takes Box2DPhysicsBody and Box2DFixture nodes
+	void set_exclude(const Array &p_exclude);
+	Array get_exclude() const;
+
+	_FORCE_INLINE_ bool is_excluded(uint64_t p_id) const { return exclude.size() > 0 && exclude.has(p_id); }
 };
 
 class Box2DWorld;
 class Box2DPhysicsBody;
 
+// A body mutation requested while an async step is running. Applied in order at the next sync point.
+struct Box2DBodyCommand {
+	enum Type {
+		SET_TRANSFORM,
+		SET_LINEAR_VELOCITY,
+		SET_ANGULAR_VELOCITY,
+		APPLY_FORCE,
+		APPLY_FORCE_TO_CENTER,
+		APPLY_TORQUE,
+		APPLY_LINEAR_IMPULSE,
+		APPLY_LINEAR_IMPULSE_TO_CENTER,
+		APPLY_ANGULAR_IMPULSE,
+	};
+
+	Type type;
+	Box2DPhysicsBody *body = NULL;
+	b2Vec2 vector = b2Vec2_zero; // position, velocity, force or impulse
+	b2Vec2 point = b2Vec2_zero;
+	float scalar = 0.0f; // angle, angular velocity, torque or angular impulse
+	bool wake = true;
+};
+
 class Box2DWorld : public Node2D, public virtual b2DestructionListener, public virtual b2ContactFilter, public virtual b2ContactListener {
 	GDCLASS(Box2DWorld, Node2D);
 
 	friend class Box2DPhysicsBody;
+	friend class Box2DFixture;
 	friend class Box2DJoint;
+	friend class Box2DCharacterBody;
+
+public:
+	enum ContactEventType {
+		CONTACT_EVENT_BEGIN,
+		CONTACT_EVENT_END,
+		CONTACT_EVENT_POST_SOLVE,
+	};
+
+	enum RaycastMode {
+		RAYCAST_CLOSEST, // The nearest hit per ray
+		RAYCAST_ANY, // The first hit found per ray, which may not be the nearest
+		RAYCAST_ALL, // Every hit per ray, nearest first
+	};
 
 private:
 	// TODO Refactor this callback garbage.
 	//      It may make sense to do this when/if shape queries are implemented.
 	//      These at least need renamed.
+	// Collects every fixture whose proxy overlaps the queried AABB. A fixture is reported once per overlapping proxy.
 	class QueryCallback : public b2QueryCallback {
 	public:
-		Vector<b2Fixture *> results;
-
-		Box2DShapeQueryParameters params;
+		LocalVector<b2Fixture *> results;
 
 		virtual bool ReportFixture(b2Fixture *fixture) override;
 	};
 
-	class IntersectPointCallback : public b2QueryCallback {
+	// One child of a query shape, with its AABB at the query transform
+	struct QueryChild {
+		const b2Shape *shape;
+		int32 child;
+		b2AABB aabb;
+		// Set when casting a body's own fixtures, which then collide with whatever the fixture would
+		b2Fixture *fixture = NULL;
+	};
+
+	static bool build_query_children(const Ref<Box2DShape> &p_shape, const b2Transform &p_xf, LocalVector<QueryChild> &r_children, b2AABB &r_bounds);
+	static bool test_query_overlap(const LocalVector<QueryChild> &p_children, const b2Transform &p_xf, b2Fixture *p_fixture);
+	static bool accepts_query_fixture(const Box2DShapeQueryParameters *p_params, b2Fixture *p_fixture);
+
+	// The earliest blocking hit of a shape cast. The fraction is the safe fraction of the motion, which leaves
+	// Box2D's target separation between the shapes.
+	struct ShapeCastHit {
+		uint32_t cast = 0;
+		float fraction = 1.0f;
+		b2Vec2 point = b2Vec2_zero;
+		b2Vec2 normal = b2Vec2_zero;
+		b2Fixture *fixture = NULL;
+	};
+
+	// Casts children built by build_query_children() at p_xf's rotation and a zero origin, so one set of
+	// children can be reused for casts from many origins
+	bool cast_query_children(const LocalVector<QueryChild> &p_children, const b2Transform &p_xf, const b2Vec2 &p_motion, const Box2DShapeQueryParameters *p_params, QueryCallback &r_candidates, ShapeCastHit &r_hit, bool p_ignore_rigid = false);
+	static void cast_child(const QueryChild &p_child, const b2Sweep &p_sweep, const b2Vec2 &p_motion, b2Fixture *p_fixture, int32 p_fixture_child, bool p_drop_through, ShapeCastHit &r_hit);
+	inline bool accepts_cast_fixture(b2Fixture *p_caster, b2Fixture *p_fixture, bool p_ignore_rigid);
+	// Pushes r_xf out of the deepest overlaps of a body's fixture children, using the same manifolds as b2Contact.
+	// Returns the total separation applied.
+	b2Vec2 separate_query_children(const LocalVector<QueryChild> &p_children, b2Transform &r_xf, QueryCallback &r_candidates, bool p_ignore_rigid = false);
+
+	// One cast_shape_batch() call. Chunks of casts write their own hits, like RaycastBatch.
+	struct ShapeCastBatch {
+		const Box2DShapeQueryParameters *params = NULL;
+		const LocalVector<QueryChild> *children = NULL;
+		b2Rot rotation;
+		const Vector2 *origins = NULL;
+		const Vector2 *motions = NULL;
+		uint32_t count = 0;
+		uint32_t chunk_size = 0;
+		LocalVector<LocalVector<ShapeCastHit>> chunk_hits;
+	};
+
+	void _cast_shape_chunk(uint32_t p_index, ShapeCastBatch *p_batch);
+
+	struct RaycastHit {
+		uint32_t ray;
+		b2Vec2 point;
+		b2Vec2 normal;
+		float fraction;
+		uint64_t fixture;
+	};
+
+	struct RaycastHitComparator {
+		_FORCE_INLINE_ bool operator()(const RaycastHit &p_a, const RaycastHit &p_b) const { return p_a.fraction < p_b.fraction; }
+	};
+
+	class RaycastCallback : public b2RayCastCallback {
 	public:
-		Vector<b2Fixture *> results;
+		LocalVector<RaycastHit> *hits = NULL;
+		uint32_t ray = 0;
+		uint16 collision_mask = 0xFFFF;
+		RaycastMode mode = RAYCAST_CLOSEST;
+		bool has_closest = false;
+		RaycastHit closest;
+
+		virtual float ReportFixture(b2Fixture *fixture, const b2Vec2 &point, const b2Vec2 &normal, float fraction) override;
+	};
+
+	// One raycast_batch() call. Each chunk of rays writes its own hits, so chunks can run on separate threads.
+	struct RaycastBatch {
+		const Vector2 *from = NULL;
+		const Vector2 *to = NULL;
+		uint32_t count = 0;
+		uint32_t chunk_size = 0;
+		uint16 collision_mask = 0xFFFF;
+		RaycastMode mode = RAYCAST_CLOSEST;
+		LocalVector<LocalVector<RaycastHit>> chunk_hits;
+	};
+
+	void raycast_range(uint32_t p_begin, uint32_t p_end, const RaycastBatch &p_batch, LocalVector<RaycastHit> &r_hits) const;
+	void _raycast_chunk(uint32_t p_index, RaycastBatch *p_batch);
 
+	// Per-call state for query_aabb() and intersect_point(), so they can run reentrantly
+	class FixtureQueryCallback : public b2QueryCallback {
+	public:
+		LocalVector<uint64_t> *fixtures = NULL;
+		LocalVector<uint64_t> *bodies = NULL;
+		uint32_t max_results = 0;
+		uint32_t collision_mask = 0xFFFF;
+		const VSet<uint64_t> *exclude = NULL;
+
+		// Either the point or the bounds are tested against each fixture's shape
+		bool test_point = false;
 		b2Vec2 point;
-		int max_results;
-		//Set<Ref<Box2DPhysicsBody> > exclude;
+		b2AABB bounds;
 
 		virtual bool ReportFixture(b2Fixture *fixture) override;
 	};
 
+	void run_fixture_query(FixtureQueryCallback &p_callback, const b2AABB &p_aabb, LocalVector<uint64_t> &r_fixtures, LocalVector<uint64_t> &r_bodies, int p_max_results, uint32_t p_collision_mask, const VSet<uint64_t> &p_exclude);
+
 private:
 	Vector2 gravity;
 	bool auto_step{true};
 	b2World *world;
 
+	// When fixed_step_rate > 0, the world steps at its own rate from an accumulator every frame,
+	// instead of once per engine physics tick. Optionally, bodies are interpolated between the last two steps.
+	real_t fixed_step_rate = 0.0f;
+	int max_steps_per_frame = 8;
+	bool interpolate = false;
+	real_t step_accumulator = 0.0f;
+	real_t last_step_delta = 0.0f;
+
+	// Solver budget. In adaptive mode, the iteration counts are upper bounds and the counts actually used
+	// are picked each step from the size of the largest awake island.
+	int velocity_iterations = 8;
+	int position_iterations = 8;
+	int substeps = 1;
+	bool adaptive_iterations = false;
+
+	// Scratch buffers for measure_largest_island(), kept to avoid reallocating every step
+	LocalVector<uint32_t> island_parents;
+	LocalVector<uint32_t> island_sizes;
+
+	int measure_largest_island();
+
+	// Async stepping. step() waits for the previous step, publishes its results, and hands the next step
+	// to a worker thread, so Box2D runs while the main thread processes the rest of the frame.
+	// Everything read between sync points is one step behind. While a step is in flight, velocity and
+	// transform changes are queued in command_queue, and anything else that touches Box2D waits for the step.
+	bool async_step = false;
+	Thread step_thread;
+	Semaphore step_start;
+	Semaphore step_done;
+	bool step_thread_exit = false;
+	bool step_in_flight = false;
+	int step_velocity_iterations = 8;
+	int step_position_iterations = 8;
+
+	LocalVector<Box2DBodyCommand> command_queue;
+
+	// Bodies woken by contact callbacks during a step. Tracked after the step, so awake_bodies is only touched by the main thread.
+	LocalVector<Box2DPhysicsBody *> contact_woken_bodies;
+
+	// Contact monitors changed since they were last published, by body ID
+	LocalVector<ObjectID> dirty_contact_monitors;
+
+	struct ContactSignal {
+		enum Type {
+			BODY_ENTERED,
+			BODY_EXITED,
+			FIXTURE_ENTERED,
+			FIXTURE_EXITED,
+		};
+
+		Type type;
+		ObjectID emitter;
+		ObjectID other;
+		ObjectID local_fixture;
+	};
+
+	// Contact event stream. Events are recorded into contact_events as Box2D reports them, then packed
+	// into the published arrays when the step's results are delivered. The published stream covers the
+	// steps delivered by the last step() call, or by the last advance() call when stepping at a fixed rate.
+	struct ContactEvent {
+		ContactEventType type;
+		ObjectID fixture_a;
+		ObjectID fixture_b;
+		Vector2 point;
+		Vector2 normal;
+		Vector2 impact_velocity;
+		float normal_impulse = 0.0f;
+	};
+
+	bool contact_events_enabled = false;
+	bool contact_events_accumulate = false;
+	LocalVector<ContactEvent> contact_events;
+
+	PackedInt32Array published_event_types;
+	PackedInt64Array published_event_fixtures_a;
+	PackedInt64Array published_event_fixtures_b;
+	PackedVector2Array published_event_points;
+	PackedVector2Array published_event_normals;
+	PackedVector2Array published_event_impact_velocities;
+	PackedFloat32Array published_event_normal_impulses;
+
+	inline void record_contact_event(ContactEventType p_type, b2Contact *contact, const b2ContactImpulse *impulse = NULL);
+	void publish_contact_events();
+	void clear_published_contact_events();
+
+	// Contact signals raised inside b2World::Step. Emitted in one pass after the step (or at the next sync point when async).
+	LocalVector<ContactSignal> deferred_contact_signals;
+
+	// Group stepping. Worlds with parallel_step enabled are stepped together on a shared thread pool by
+	// whichever of them processes first each physics frame. Each world then delivers its own results
+	// (transforms, signals, joint breaks) from its own physics process, after every world has finished.
+	bool parallel_step = false;
+	bool group_stepped = false;
+	bool worker_stepping = false;
+
+	static LocalVector<Box2DWorld *> parallel_worlds;
+	static LocalVector<Box2DWorld *> group_batch;
+	static uint64_t group_step_frame;
+	// Used by grouped stepping and the batch queries. Only the main thread runs work on it, one job at a time.
+	static ThreadWorkPool group_pool;
+	static bool group_pool_initialized;
+
+	static void init_group_pool();
+
+	// Hands b2World::Step's independent islands (and, with parallel_narrow_phase, contact manifolds) to worker threads
+	Box2DTaskExecutor task_executor;
+
+	bool can_group_step() const;
+	void step_group(real_t p_step);
+	void _step_group_member(uint32_t p_index, LocalVector<Box2DWorld *> *p_batch);
+
+	// True while Box2D callbacks may be running off the main thread
+	_FORCE_INLINE_ bool is_stepping_on_worker() const { return step_in_flight || worker_stepping; }
+
+	static void _step_thread_func(void *p_userdata);
+	void prepare_step(real_t p_step);
+	void run_step();
+	void deliver_step_results();
+	void track_contact_woken_bodies();
+	void update_step_thread();
+	void stop_step_thread();
+	void finish_step();
+
+	_FORCE_INLINE_ void wait_for_step() {
+		if (unlikely(step_in_flight)) {
+			finish_step();
+		}
+	}
+
+	void queue_command(const Box2DBodyCommand &p_command);
+	void apply_command(const Box2DBodyCommand &p_command);
+
+	inline void track_contact_woken_body(Box2DPhysicsBody *p_body);
+	void emit_contact_signal(ContactSignal::Type p_type, Box2DPhysicsBody *p_emitter, Object *p_other, Object *p_local_fixture = NULL);
+	void flush_contact_signals();
+	void mark_contact_monitor_dirty(Box2DPhysicsBody *p_body);
+	void publish_contact_monitors();
+	void publish_body_state();
+
+	void check_joint_breaks();
+
 	Set<Box2DPhysicsBody *> bodies;
 	Set<Box2DJoint *> joints;
 
+	// Bodies that may have moved during the last step. Only these have their transforms written back.
+	// Bodies are added when something wakes them, and removed during sync once Box2D puts them to sleep.
+	LocalVector<Box2DPhysicsBody *> awake_bodies;
+
+	void track_awake_body(Box2DPhysicsBody *p_body);
+	void untrack_awake_body(Box2DPhysicsBody *p_body);
+	// Drops every reference to a body whose b2Body was just destroyed
+	void untrack_destroyed_body(Box2DPhysicsBody *p_body);
+	void sync_awake_bodies();
+	void interpolate_awake_bodies(real_t p_fraction);
+
+	_FORCE_INLINE_ bool is_interpolating() const { return interpolate && fixed_step_rate > 0.0f; }
+
+	void update_processing();
+
 	virtual void SayGoodbye(b2Joint *joint) override;
 	virtual void SayGoodbye(b2Fixture *fixture) override;
 
+	// Collision exceptions. The exception lists on the nodes are the source of truth. They're mirrored into
+	// exception_pairs (keyed by instance IDs) and into flags on each b2Fixture as soon as they change, so
+	// queries between steps see them too. An exception only applies if both fixtures carry the matching flag.
+	// A node's pairs are added while it has Box2D objects in this world, and removed when they're destroyed.
+	enum ExceptionFlags {
+		EXCEPTION_FIXTURE = 1, // The fixture is in a fixture exception
+		EXCEPTION_BODY = 2, // The fixture's body is in a body exception
+	};
+
+	Box2DPairSet exception_pairs;
+
+	static uint32 get_exception_flags(const Box2DFixture *p_fixture);
+	// Adds or removes every exception the node is part of
+	void register_exceptions(const Box2DPhysicsBody *p_body, bool p_add);
+	void register_exceptions(const Box2DFixture *p_fixture, bool p_add);
+	// Sets the flags on the node's b2Fixtures, and refilters them so existing contacts follow the change
+	void update_exception_flags(Box2DPhysicsBody *p_body);
+	void update_exception_flags(Box2DFixture *p_fixture);
+
+	// Collision rules, copied from the resource before a step whenever it changes. Empty when there are no rules.
+	Ref<Box2DCollisionRules> collision_rules;
+	LocalVector<uint8_t> rule_table;
+	bool collision_rules_dirty = false;
+
+	void _collision_rules_changed();
+	void update_rule_table();
+
+	_FORCE_INLINE_ Box2DCollisionRules::Rule get_contact_rule(const b2Fixture *fixtureA, const b2Fixture *fixtureB) const {
+		return (Box2DCollisionRules::Rule)rule_table[fixtureA->GetUserData().collision_tag * Box2DCollisionRules::MAX_TAGS + fixtureB->GetUserData().collision_tag];
+	}
+
+	// Layer/mask, group index, collision rule and exception filtering shared by contacts and the sensor pass
+	inline bool filter_fixtures(b2Fixture *fixtureA, b2Fixture *fixtureB);
 	virtual bool ShouldCollide(b2Fixture *fixtureA, b2Fixture *fixtureB) override;
 
-	int32_t next_contact_id = 0;
-	bool flag_rescan_contacts_monitored = false;
-	HashMap<uint64_t, ContactBufferManifold> contact_buffer;
+	// Sensor overlaps. Sensor fixtures with sensor_overlaps enabled get no b2Contacts. Instead, after each step, every
+	// registered sensor queries the broad-phase and runs boolean overlap tests (no manifolds) against what it finds.
+	// Overlap sets are sorted fixture IDs, so enters and exits fall out of a merge. Changes are emitted per sensor
+	// as one batched signal when the step is delivered.
+	struct SensorEntry {
+		Box2DFixture *fixture = NULL;
+		LocalVector<uint64_t> overlaps;
+		// Copy of overlaps as of the last delivered step, read by Box2DFixture::get_overlapping_fixtures()
+		LocalVector<uint64_t> reported_overlaps;
+		// Combined fat AABB of the sensor's proxies at the last pass
+		b2AABB aabb;
+		bool tested = false;
+	};
+
+	struct SensorEvent {
+		ObjectID sensor;
+		ObjectID fixture;
+		bool entered;
+	};
 
-	inline void try_buffer_contact(b2Contact *contact, int i);
+	// Overlap sets of sensors unregistered since the last pass. Recreating a fixture (a new shape, or a moved
+	// fixture) unregisters and registers it again, and picks its set back up, so the next pass only reports real
+	// changes. Sets that weren't picked up report every overlap as exited.
+	struct RetiredSensor {
+		ObjectID fixture;
+		LocalVector<uint64_t> overlaps;
+		LocalVector<uint64_t> reported_overlaps;
+	};
+
+	LocalVector<SensorEntry> sensors;
+	LocalVector<SensorEvent> sensor_events;
+	LocalVector<RetiredSensor> retired_sensors;
+	QueryCallback sensor_query;
+	LocalVector<uint64_t> sensor_scratch;
+
+	void register_sensor(Box2DFixture *p_fixture);
+	void unregister_sensor(Box2DFixture *p_fixture);
+	void flush_retired_sensors();
+	// Called as a fixture is freed. Sensors that reported it as overlapping get an exit right away, since a
+	// deferred event couldn't pass the freed fixture to the signal.
+	void remove_sensor_overlaps(Box2DFixture *p_fixture);
+	void update_sensor_overlaps();
+	bool test_sensor_overlap(const Box2DFixture *p_sensor, b2Fixture *p_other) const;
+	void deliver_sensor_events();
+
+	bool flag_rescan_contacts_monitored = false;
+	// Dense, in no particular order. Each b2Contact's user data holds the index of its manifold.
+	LocalVector<ContactBufferManifold> contact_buffer;
+	Box2DContactPool contact_pool;
+	uint32_t step_epoch = 1;
+
+	// Pointers into contact_buffer only last until the next manifold is created or erased
+	_FORCE_INLINE_ ContactBufferManifold *get_buffer_manifold(const b2Contact *contact);
+	ContactBufferManifold *create_buffer_manifold(b2Contact *contact);
+	void erase_buffer_manifold(b2Contact *contact);
+
+	// Monitors with pair summaries since the last step, by body ID. Their summaries are cleared before the next step.
+	LocalVector<ObjectID> summary_monitors;
+
+	void clear_pair_summaries();
+
+	// p_passed flags (1 = body A, 2 = body B) the thresholded monitors whose solve passed report_filtered_contact()
+	inline ContactBufferManifold *try_buffer_contact(b2Contact *contact, int i, ContactBufferManifold *buffer_manifold, int p_passed = 0);
+	inline void init_contact_point(b2Contact *contact, Box2DContactPoint *c_ptr, const b2WorldManifold &p_manifold, int i) const;
+	void report_filtered_contact(b2Contact *contact, const b2ContactImpulse *impulse, Box2DPhysicsBody *body_a, Box2DPhysicsBody *body_b);
+	void accumulate_pair_summary(Box2DPhysicsBody *p_body, Box2DPhysicsBody *p_other, const b2WorldManifold &p_manifold, const b2ContactImpulse *impulse, bool p_flip);
+
+	// Bodies with impact tracking hit during the running step, and those whose reports were last delivered, by body ID
+	LocalVector<ObjectID> impacted_bodies;
+	LocalVector<ObjectID> reported_impact_bodies;
+
+	void accumulate_impacts(b2Contact *contact, const b2ContactImpulse *impulse, Box2DPhysicsBody *body_a, Box2DPhysicsBody *body_b);
+	inline void add_impact(Box2DPhysicsBody *p_body, const Box2DPhysicsBody *p_other, float p_impulse, float p_peak_impulse, float p_peak_speed, float p_energy_lost);
+	void deliver_impacts();
+	inline void add_monitor_contact(Box2DPhysicsBody *p_body, const Box2DContactHandle &p_handle, int32_t &r_monitor_index);
+	void remove_monitor_contact(Box2DPhysicsBody *p_body, int32_t p_monitor_index);
+	void release_contact(const Box2DContactHandle &p_handle);
+	void detach_contact_monitor(Box2DPhysicsBody *p_body);
+	Box2DContactPoint resolve_contact(const Box2DContactHandle &p_handle, const Box2DPhysicsBody *p_body) const;
+
+	inline void apply_surface_material(b2Contact *contact) const;
+	inline bool passes_one_way(b2Contact *contact, const b2WorldManifold &p_manifold, const b2Fixture *p_platform, const b2Fixture *p_other, bool p_platform_is_a) const;
+	// Disables the contact from PreSolve. It won't be solved this step, so its buffered points are released instead of going stale.
+	void skip_contact_solve(b2Contact *contact);
 
 	virtual void BeginContact(b2Contact *contact) override;
 	virtual void EndContact(b2Contact *contact) override;
@@ -165,9 +672,6 @@ private:
 	/// Note: this is only called for contacts that are touching, solid, and awake.
 	virtual void PostSolve(b2Contact *contact, const b2ContactImpulse *impulse) override;
 
-	QueryCallback aabbCallback;
-	IntersectPointCallback pointCallback;
-
 	void create_b2World();
 	void destroy_b2World();
 
@@ -177,6 +681,7 @@ protected:
 
 public:
 	void step(real_t p_step);
+	void advance(real_t p_delta);
 
 	void set_gravity(const Vector2 &gravity);
 	Vector2 get_gravity() const;
@@ -184,11 +689,66 @@ public:
 	void set_auto_step(bool p_auto_step);
 	bool get_auto_step() const;
 
+	void set_fixed_step_rate(real_t p_rate);
+	real_t get_fixed_step_rate() const;
+
+	void set_max_steps_per_frame(int p_steps);
+	int get_max_steps_per_frame() const;
+
+	void set_interpolate(bool p_interpolate);
+	bool is_interpolate_enabled() const;
+
+	void set_velocity_iterations(int p_iterations);
+	int get_velocity_iterations() const;
+
+	void set_position_iterations(int p_iterations);
+	int get_position_iterations() const;
+
+	void set_substeps(int p_substeps);
+	int get_substeps() const;
+
+	void set_adaptive_iterations(bool p_adaptive);
+	bool is_adaptive_iterations_enabled() const;
+
+	void set_async_step(bool p_async);
+	bool is_async_step_enabled() const;
+
+	void set_parallel_step(bool p_parallel);
+	bool is_parallel_step_enabled() const;
+
+	void set_parallel_narrow_phase(bool p_parallel);
+	bool is_parallel_narrow_phase_enabled() const;
+
+	static void finish_group_pool();
+
+	void set_collision_rules(const Ref<Box2DCollisionRules> &p_rules);
+	Ref<Box2DCollisionRules> get_collision_rules() const;
+
+	void set_contact_events(bool p_enabled);
+	bool is_contact_events_enabled() const;
+
+	Dictionary get_contact_events() const;
+
+	// Main thread only, since large batches run on the shared worker pool
+	Dictionary raycast_batch(const PackedVector2Array &p_from, const PackedVector2Array &p_to, uint32_t p_collision_mask = 0xFFFF, RaycastMode p_mode = RAYCAST_CLOSEST);
+
 	//bool isLocked() const;
 
-	Array intersect_point(const Vector2 &p_point, int p_max_results = 32); //, const Vector<Ref<Box2DPhysicsBody> > &p_exclude = Vector<Ref<Box2DPhysicsBody> >() /*, uint32_t p_layers = 0*/);
-	//Array intersect_shape();
-	//Array query_aabb(const Rect2 &p_bounds); // TODO add more parameters like Physics2DDirectSpaceState::_intersect_point
+	// Native point and AABB queries. The outputs are cleared and filled with fixture and body instance IDs, and keep
+	// their capacity, so reusing them between calls doesn't allocate. Return the number of hits.
+	int intersect_point_ids(const Vector2 &p_point, LocalVector<uint64_t> &r_fixtures, LocalVector<uint64_t> &r_bodies, int p_max_results = 32, uint32_t p_collision_mask = 0xFFFF, const VSet<uint64_t> &p_exclude = VSet<uint64_t>());
+	int query_aabb_ids(const Rect2 &p_bounds, LocalVector<uint64_t> &r_fixtures, LocalVector<uint64_t> &r_bodies, int p_max_results = 32, uint32_t p_collision_mask = 0xFFFF, const VSet<uint64_t> &p_exclude = VSet<uint64_t>());
+
+	// Script versions of the above. Return packed arrays of fixture and body IDs.
+	Dictionary intersect_point(const Vector2 &p_point, int p_max_results = 32, uint32_t p_collision_mask = 0xFFFF, const Array &p_exclude = Array());
+	Dictionary query_aabb(const Rect2 &p_bounds, int p_max_results = 32, uint32_t p_collision_mask = 0xFFFF, const Array &p_exclude = Array());
+	// Returns the IDs of every fixture (and its body) that overlaps the query shape, as packed arrays
+	Dictionary intersect_shape(const Ref<Box2DShapeQueryParameters> &p_params, int p_max_results = 32);
+	// Sweeps the query shape along p_motion and returns the earliest hit, or an empty Dictionary
+	Dictionary cast_shape(const Ref<Box2DShapeQueryParameters> &p_params, const Vector2 &p_motion);
+	// Casts the query shape from each origin along its motion, keeping the parameters' rotation. Returns packed arrays
+	// with one entry per cast that hit. Main thread only, like raycast_batch().
+	Dictionary cast_shape_batch(const Ref<Box2DShapeQueryParameters> &p_params, const PackedVector2Array &p_origins, const PackedVector2Array &p_motions);
 
 	//void shiftOrigin(const Vector2 &newOrigin);
 
@@ -198,4 +758,7 @@ public:
 	~Box2DWorld();
 };
 
+VARIANT_ENUM_CAST(Box2DWorld::ContactEventType);
+VARIANT_ENUM_CAST(Box2DWorld::RaycastMode);
+
 #endif // BOX2D_WORLD_H
@@ -0,0 +1,84 @@
+#include "box2d_collision_rules.h"
+
+/**
+* @author Brian Semrau
+*/
+
+void Box2DCollisionRules::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_rule", "tag_a", "tag_b", "rule"), &Box2DCollisionRules::set_rule);
+	ClassDB::bind_method(D_METHOD("get_rule", "tag_a", "tag_b"), &Box2DCollisionRules::get_rule);
+	ClassDB::bind_method(D_METHOD("clear_rules"), &Box2DCollisionRules::clear_rules);
+
+	ClassDB::bind_method(D_METHOD("_set_rules", "rules"), &Box2DCollisionRules::_set_rules);
+	ClassDB::bind_method(D_METHOD("_get_rules"), &Box2DCollisionRules::_get_rules);
+
+	ADD_PROPERTY(PropertyInfo(Variant::PACKED_BYTE_ARRAY, "rules", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NOEDITOR | PROPERTY_USAGE_INTERNAL), "_set_rules", "_get_rules");
+
+	BIND_ENUM_CONSTANT(RULE_ALLOW);
+	BIND_ENUM_CONSTANT(RULE_DENY);
+	BIND_ENUM_CONSTANT(RULE_SENSOR_ONLY);
+}
+
+void Box2DCollisionRules::_set_rules(const PackedByteArray &p_rules) {
+	ERR_FAIL_COND_MSG(p_rules.size() != MAX_TAGS * MAX_TAGS, "Collision rules must have " + itos(MAX_TAGS * MAX_TAGS) + " entries.");
+	// The world only reads one side of each pair, so a hand-edited asymmetric table is made symmetric.
+	// The more restrictive rule wins: DENY over SENSOR_ONLY over ALLOW.
+	bool symmetric = true;
+	for (int a = 0; a < MAX_TAGS; ++a) {
+		for (int b = a; b < MAX_TAGS; ++b) {
+			const uint8_t ab = MIN(p_rules[a * MAX_TAGS + b], (uint8_t)RULE_SENSOR_ONLY);
+			const uint8_t ba = MIN(p_rules[b * MAX_TAGS + a], (uint8_t)RULE_SENSOR_ONLY);
+			symmetric = symmetric && ab == ba;
+			uint8_t rule = RULE_ALLOW;
+			if (ab == RULE_DENY || ba == RULE_DENY) {
+				rule = RULE_DENY;
+			} else if (ab == RULE_SENSOR_ONLY || ba == RULE_SENSOR_ONLY) {
+				rule = RULE_SENSOR_ONLY;
+			}
+			rules[a * MAX_TAGS + b] = rule;
+			rules[b * MAX_TAGS + a] = rule;
+		}
+	}
+	if (!symmetric) {
+		WARN_PRINT("Collision rules were not symmetric. Each pair now uses the more restrictive of its two rules.");
+	}
+	emit_changed();
+}
+
+PackedByteArray Box2DCollisionRules::_get_rules() const {
+	PackedByteArray ret;
+	ret.resize(MAX_TAGS * MAX_TAGS);
+	uint8_t *w = ret.ptrw();
+	for (int i = 0; i < MAX_TAGS * MAX_TAGS; ++i) {
+		w[i] = rules[i];
+	}
+	return ret;
+}
+
+void Box2DCollisionRules::set_rule(int p_tag_a, int p_tag_b, Rule p_rule) {
+	ERR_FAIL_INDEX(p_tag_a, MAX_TAGS);
+	ERR_FAIL_INDEX(p_tag_b, MAX_TAGS);
+	ERR_FAIL_INDEX(p_rule, RULE_SENSOR_ONLY + 1);
+	rules[p_tag_a * MAX_TAGS + p_tag_b] = p_rule;
+	rules[p_tag_b * MAX_TAGS + p_tag_a] = p_rule;
+	emit_changed();
+}
+
+Box2DCollisionRules::Rule Box2DCollisionRules::get_rule(int p_tag_a, int p_tag_b) const {
+	ERR_FAIL_INDEX_V(p_tag_a, MAX_TAGS, RULE_ALLOW);
+	ERR_FAIL_INDEX_V(p_tag_b, MAX_TAGS, RULE_ALLOW);
+	return (Rule)rules[p_tag_a * MAX_TAGS + p_tag_b];
+}
+
+void Box2DCollisionRules::clear_rules() {
+	for (int i = 0; i < MAX_TAGS * MAX_TAGS; ++i) {
+		rules[i] = RULE_ALLOW;
+	}
+	emit_changed();
+}
+
+Box2DCollisionRules::Box2DCollisionRules() {
+	for (int i = 0; i < MAX_TAGS * MAX_TAGS; ++i) {
+		rules[i] = RULE_ALLOW;
+	}
+}
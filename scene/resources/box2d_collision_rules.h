@@ -0,0 +1,51 @@
+#ifndef BOX2D_COLLISION_RULES_H
+#define BOX2D_COLLISION_RULES_H
+
+#include <core/io/resource.h>
+
+/**
+* @author Brian Semrau
+*
+* Table of what happens when fixtures with two collision tags meet. Bodies and fixtures each have a
+* collision_tag (0-31). Box2DWorld copies the table before each step and reads it while filtering,
+* so a rule costs one lookup per pair.
+*/
+
+class Box2DCollisionRules : public Resource {
+	GDCLASS(Box2DCollisionRules, Resource);
+
+public:
+	enum Rule {
+		RULE_ALLOW,
+		RULE_DENY, // The fixtures never touch
+		RULE_SENSOR_ONLY, // Contacts are reported, but the fixtures pass through each other
+	};
+
+	enum {
+		MAX_TAGS = 32,
+	};
+
+private:
+	// Symmetric. Indexed by tag_a * MAX_TAGS + tag_b.
+	uint8_t rules[MAX_TAGS * MAX_TAGS];
+
+	void _set_rules(const PackedByteArray &p_rules);
+	PackedByteArray _get_rules() const;
+
+protected:
+	static void _bind_methods();
+
+public:
+	void set_rule(int p_tag_a, int p_tag_b, Rule p_rule);
+	Rule get_rule(int p_tag_a, int p_tag_b) const;
+
+	void clear_rules();
+
+	_FORCE_INLINE_ const uint8_t *get_table() const { return rules; }
+
+	Box2DCollisionRules();
+};
+
+VARIANT_ENUM_CAST(Box2DCollisionRules::Rule);
+
+#endif // BOX2D_COLLISION_RULES_H
@@ -22,6 +22,7 @@ class Box2DShape : public Resource {
 	OBJ_SAVE_TYPE(Box2DShape);
 
 	friend class Box2DFixture;
+	friend class Box2DWorld;
 
 	virtual bool is_composite_shape() const;
 	virtual const Vector<const b2Shape *> get_shapes() const;
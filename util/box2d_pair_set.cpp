@@ -0,0 +1,99 @@
+#include "box2d_pair_set.h"
+
+/**
+* @author Brian Semrau
+*/
+
+void Box2DPairSet::rehash(uint32_t p_capacity) {
+	LocalVector<Entry> old;
+	old.resize(entries.size());
+	for (uint32_t i = 0; i < entries.size(); ++i) {
+		old[i] = entries[i];
+	}
+
+	entries.resize(p_capacity);
+	for (uint32_t i = 0; i < p_capacity; ++i) {
+		entries[i] = Entry();
+	}
+
+	// Tombstones are left behind
+	for (uint32_t i = 0; i < old.size(); ++i) {
+		if (old[i].directions & DIRECTION_MASK) {
+			entries[find_slot(old[i].low, old[i].high)] = old[i];
+		}
+	}
+	tombstones = 0;
+}
+
+void Box2DPairSet::add(uint64_t p_from, uint64_t p_to) {
+	// Keep the load factor, tombstones included, at or below 1/2 so probe chains stay short
+	if ((count + tombstones + 1) * 2 > entries.size()) {
+		// Mostly tombstones means the set churned rather than grew, so it's cleaned at the same size
+		const bool grow = (count + 1) * 4 > entries.size();
+		rehash(grow ? MAX(entries.size() * 2, 16u) : entries.size());
+	}
+
+	const bool forward = p_from < p_to;
+	const uint64_t low = forward ? p_from : p_to;
+	const uint64_t high = forward ? p_to : p_from;
+	const uint32_t direction = forward ? DIRECTION_FORWARD : DIRECTION_BACKWARD;
+
+	const uint32_t mask = entries.size() - 1;
+	uint32_t idx = hash(low, high) & mask;
+	int64_t reusable = -1;
+	while (entries[idx].directions != 0) {
+		if (entries[idx].low == low && entries[idx].high == high) {
+			break;
+		}
+		if (reusable < 0 && entries[idx].directions == TOMBSTONE) {
+			reusable = idx;
+		}
+		idx = (idx + 1) & mask;
+	}
+
+	Entry *e = &entries[idx];
+	if (e->directions & DIRECTION_MASK) {
+		e->directions |= direction;
+		return;
+	}
+
+	if (e->directions == TOMBSTONE) {
+		// This pair's own tombstone
+		--tombstones;
+	} else if (reusable >= 0) {
+		// The pair isn't in the table, so the first tombstone on its chain is free
+		e = &entries[reusable];
+		--tombstones;
+	}
+	e->low = low;
+	e->high = high;
+	e->directions = direction;
+	++count;
+}
+
+void Box2DPairSet::remove(uint64_t p_from, uint64_t p_to) {
+	if (count == 0) {
+		return;
+	}
+
+	const bool forward = p_from < p_to;
+	Entry &e = entries[forward ? find_slot(p_from, p_to) : find_slot(p_to, p_from)];
+	if (!(e.directions & DIRECTION_MASK)) {
+		return;
+	}
+
+	e.directions &= ~(forward ? DIRECTION_FORWARD : DIRECTION_BACKWARD);
+	if (e.directions == 0) {
+		e.directions = TOMBSTONE;
+		--count;
+		++tombstones;
+	}
+}
+
+void Box2DPairSet::clear() {
+	for (uint32_t i = 0; i < entries.size(); ++i) {
+		entries[i] = Entry();
+	}
+	count = 0;
+	tombstones = 0;
+}
@@ -0,0 +1,86 @@
+#ifndef BOX2D_PAIR_SET_H
+#define BOX2D_PAIR_SET_H
+
+#include <core/templates/local_vector.h>
+#include <core/typedefs.h>
+
+/**
+* @author Brian Semrau
+*
+* Open-addressing hash set of unordered ID pairs. Each pair remembers which of its two IDs was
+* inserted first, so one set can hold both symmetric and one-directional relations.
+* Removed pairs leave a tombstone so probe chains stay intact. Tombstones are reused by later inserts,
+* and dropped when the table is rehashed.
+*/
+
+class Box2DPairSet {
+	enum {
+		DIRECTION_FORWARD = 1, // low -> high was added
+		DIRECTION_BACKWARD = 2, // high -> low was added
+		DIRECTION_MASK = 3,
+		TOMBSTONE = 4, // Was in use. Lookups probe past it.
+	};
+
+	struct Entry {
+		uint64_t low = 0;
+		uint64_t high = 0;
+		// DIRECTION_* bits, or TOMBSTONE. 0 means the slot is empty.
+		uint32_t directions = 0;
+	};
+
+	LocalVector<Entry> entries;
+	uint32_t count = 0;
+	uint32_t tombstones = 0;
+
+	static _FORCE_INLINE_ uint32_t hash(uint64_t p_low, uint64_t p_high) {
+		uint64_t h = p_low * 0x9E3779B97F4A7C15ULL;
+		h ^= p_high + 0x7F4A7C159E3779B9ULL + (h << 6) + (h >> 2);
+		h ^= h >> 33;
+		h *= 0xFF51AFD7ED558CCDULL;
+		h ^= h >> 33;
+		return (uint32_t)h;
+	}
+
+	// The pair's slot, which may be a tombstone, or the empty slot ending its probe chain
+	_FORCE_INLINE_ uint32_t find_slot(uint64_t p_low, uint64_t p_high) const {
+		const uint32_t mask = entries.size() - 1;
+		uint32_t idx = hash(p_low, p_high) & mask;
+		while (entries[idx].directions != 0 && (entries[idx].low != p_low || entries[idx].high != p_high)) {
+			idx = (idx + 1) & mask;
+		}
+		return idx;
+	}
+
+	void rehash(uint32_t p_capacity);
+
+public:
+	// Adds the directed relation p_from -> p_to
+	void add(uint64_t p_from, uint64_t p_to);
+	// Removes the directed relation p_from -> p_to. The pair is removed once neither direction is left.
+	void remove(uint64_t p_from, uint64_t p_to);
+
+	// True if p_from -> p_to was added
+	_FORCE_INLINE_ bool has_directed(uint64_t p_from, uint64_t p_to) const {
+		if (count == 0) {
+			return false;
+		}
+		const bool forward = p_from < p_to;
+		const Entry &e = entries[forward ? find_slot(p_from, p_to) : find_slot(p_to, p_from)];
+		return e.directions & (forward ? DIRECTION_FORWARD : DIRECTION_BACKWARD);
+	}
+
+	// True if either direction was added
+	_FORCE_INLINE_ bool has_any(uint64_t p_a, uint64_t p_b) const {
+		if (count == 0) {
+			return false;
+		}
+		return entries[p_a < p_b ? find_slot(p_a, p_b) : find_slot(p_b, p_a)].directions & DIRECTION_MASK;
+	}
+
+	_FORCE_INLINE_ uint32_t size() const { return count; }
+
+	// Keeps the allocation
+	void clear();
+};
+
+#endif // BOX2D_PAIR_SET_H
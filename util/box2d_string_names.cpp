@@ -0,0 +1,19 @@
+#include "box2d_string_names.h"
+
+/**
+* @author Brian Semrau
+*/
+
+Box2DStringNames *Box2DStringNames::singleton = NULL;
+
+Box2DStringNames::Box2DStringNames() {
+	body_entered = StaticCString::create("body_entered");
+	body_exited = StaticCString::create("body_exited");
+	body_fixture_entered = StaticCString::create("body_fixture_entered");
+	body_fixture_exited = StaticCString::create("body_fixture_exited");
+	sleeping_state_changed = StaticCString::create("sleeping_state_changed");
+	enabled_state_changed = StaticCString::create("enabled_state_changed");
+	joint_broken = StaticCString::create("joint_broken");
+	impact = StaticCString::create("impact");
+	overlaps_changed = StaticCString::create("overlaps_changed");
+}
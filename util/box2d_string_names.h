@@ -0,0 +1,39 @@
+#ifndef BOX2D_STRING_NAMES_H
+#define BOX2D_STRING_NAMES_H
+
+#include <core/string/string_name.h>
+
+/**
+* @author Brian Semrau
+*
+* Signal names used by the module, built once so that emitting doesn't construct a StringName every time.
+*/
+
+class Box2DStringNames {
+	static Box2DStringNames *singleton;
+
+	Box2DStringNames();
+
+public:
+	_FORCE_INLINE_ static Box2DStringNames *get_singleton() { return singleton; }
+
+	static void create() { singleton = memnew(Box2DStringNames); }
+	static void free() {
+		memdelete(singleton);
+		singleton = NULL;
+	}
+
+	StringName body_entered;
+	StringName body_exited;
+	StringName body_fixture_entered;
+	StringName body_fixture_exited;
+	StringName sleeping_state_changed;
+	StringName enabled_state_changed;
+	StringName joint_broken;
+	StringName impact;
+	StringName overlaps_changed;
+};
+
+#define B2SN (Box2DStringNames::get_singleton())
+
+#endif // BOX2D_STRING_NAMES_H
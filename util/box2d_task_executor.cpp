@@ -0,0 +1,46 @@
+#include "box2d_task_executor.h"
+
+#include <core/os/os.h>
+
+/**
+* @author Brian Semrau
+*/
+
+ThreadWorkPool Box2DTaskExecutor::pool;
+bool Box2DTaskExecutor::pool_initialized = false;
+Mutex Box2DTaskExecutor::pool_mutex;
+
+void Box2DTaskExecutor::_run_job(uint32_t p_index, Job *p_job) {
+	p_job->callback(p_job->context, p_index);
+}
+
+int32 Box2DTaskExecutor::GetThreadCount() const {
+	return OS::get_singleton()->get_processor_count();
+}
+
+void Box2DTaskExecutor::Run(int32 count, b2TaskCallback callback, void *context) {
+	if (count > 1 && pool_mutex.try_lock() == OK) {
+		if (!pool_initialized) {
+			pool.init();
+			pool_initialized = true;
+		}
+
+		Job job = { callback, context };
+		pool.do_work(count, this, &Box2DTaskExecutor::_run_job, &job);
+		pool_mutex.unlock();
+		return;
+	}
+
+	// Another step holds the pool
+	for (int32 i = 0; i < count; ++i) {
+		callback(context, i);
+	}
+}
+
+void Box2DTaskExecutor::finish_pool() {
+	MutexLock lock(pool_mutex);
+	if (pool_initialized) {
+		pool.finish();
+		pool_initialized = false;
+	}
+}
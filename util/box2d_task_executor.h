@@ -0,0 +1,41 @@
+#ifndef BOX2D_TASK_EXECUTOR_H
+#define BOX2D_TASK_EXECUTOR_H
+
+#include <core/os/mutex.h>
+#include <core/templates/thread_work_pool.h>
+
+#include <b2_task_executor.h>
+
+/**
+* @author Brian Semrau
+*
+* Runs the patched b2World::Step's parallel work (see b2patch/) on a thread pool of its own.
+* Box2DWorld's group_pool can't be used, since worlds step on its threads and on their own async step threads.
+* Only one step uses the pool at a time. Any other step running meanwhile does its work inline,
+* which gives the same results.
+*/
+
+class Box2DTaskExecutor : public b2TaskExecutor {
+	struct Job {
+		b2TaskCallback callback;
+		void *context;
+	};
+
+	static ThreadWorkPool pool;
+	static bool pool_initialized;
+	static Mutex pool_mutex;
+
+	void _run_job(uint32_t p_index, Job *p_job);
+
+public:
+	// Also compute contact manifolds on the pool
+	bool narrow_phase = false;
+
+	virtual int32 GetThreadCount() const override;
+	virtual void Run(int32 count, b2TaskCallback callback, void *context) override;
+	virtual bool IsNarrowPhaseParallel() const override { return narrow_phase; }
+
+	static void finish_pool();
+};
+
+#endif // BOX2D_TASK_EXECUTOR_H
@@ -6,48 +6,18 @@
 * @author Brian Semrau
 */
 
-// Box2D to Godot
+float Box2DConversionContext::b2_to_gd_factor = 50.0f;
+float Box2DConversionContext::gd_to_b2_factor = 1.0f / 50.0f;
 
-void b2_to_gd(b2Vec2 const &inVal, Vector2 &outVal) {
-	const float factor = B2_TO_GD;
-	outVal[0] = inVal.x * factor;
-	outVal[1] = inVal.y * factor;
-}
-
-Vector2 b2_to_gd(b2Vec2 const &inVal) {
-	return Vector2(inVal.x, inVal.y) * B2_TO_GD;
-}
-
-Transform2D b2_to_gd(b2Transform const &inVal) {
-	Transform2D outVal;
-	outVal[0][0] = inVal.q.c;
-	outVal[0][1] = inVal.q.s;
-	outVal[1][0] = -inVal.q.s;
-	outVal[1][1] = inVal.q.c;
-	b2_to_gd(inVal.p, outVal[2]);
-	return outVal;
-}
-
-// Godot to Box2D
+bool Box2DConversionContext::refresh() {
+	const float factor = static_cast<float>(GLOBAL_GET("physics/2d/box2d_conversion_factor"));
+	ERR_FAIL_COND_V_MSG(factor <= 0.0f, false, "physics/2d/box2d_conversion_factor must be greater than 0.");
 
-void gd_to_b2(Vector2 const &inVal, b2Vec2 &outVal) {
-	const float factor = GD_TO_B2;
-	outVal.x = inVal[0] * factor;
-	outVal.y = inVal[1] * factor;
-}
-
-b2Vec2 gd_to_b2(Vector2 const &inVal) {
-	const float factor = GD_TO_B2;
-	return b2Vec2(inVal.x * factor, inVal.y * factor);
-}
-
-b2Transform gd_to_b2(Transform2D const& inVal) {
-	return b2Transform(gd_to_b2(inVal.get_origin()), b2Rot(inVal.get_rotation()));
-}
+	if (factor == b2_to_gd_factor) {
+		return false;
+	}
 
-b2AABB gd_to_b2(Rect2 const& inVal) {
-	b2AABB outVal;
-	outVal.lowerBound = gd_to_b2(inVal.get_position());
-	outVal.upperBound = gd_to_b2(inVal.get_position() + inVal.get_size());
-	return outVal;
+	b2_to_gd_factor = factor;
+	gd_to_b2_factor = 1.0f / factor;
+	return true;
 }
@@ -1,6 +1,7 @@
 #ifndef BOX2D_TYPES_CONVERTER_H
 #define BOX2D_TYPES_CONVERTER_H
 
+#include <core/math/rect2.h>
 #include <core/math/transform_2d.h>
 #include <core/math/vector2.h>
 #include <core/math/vector3.h>
@@ -15,16 +16,71 @@
 * Conversion functions for switching between Box2D/Godot data structures and units.
 */
 
-#define B2_TO_GD static_cast<float>(GLOBAL_GET("physics/2d/box2d_conversion_factor"))
-#define GD_TO_B2 (1.0f / static_cast<float>(GLOBAL_GET("physics/2d/box2d_conversion_factor")))
+// Cached pixels-per-meter factor from "physics/2d/box2d_conversion_factor".
+// Reading the project setting is a hash lookup plus a Variant conversion, which is far too slow
+// for something called on every body sync, contact point and query. Instead, the factor is resolved
+// once when the module is registered, and each Box2DWorld refreshes it when it enters the tree and
+// before every step, so a changed project setting is picked up on the next step.
+class Box2DConversionContext {
+	static float b2_to_gd_factor;
+	static float gd_to_b2_factor;
 
-extern void b2_to_gd(b2Vec2 const &inVal, Vector2 &outVal);
-extern Vector2 b2_to_gd(b2Vec2 const &inVal);
-extern Transform2D b2_to_gd(b2Transform const &inVal);
+public:
+	// Re-reads the project setting. Returns true if the factor changed.
+	static bool refresh();
 
-extern void gd_to_b2(Vector2 const &inVal, b2Vec2 &outVal);
-extern b2Vec2 gd_to_b2(Vector2 const &inVal);
-extern b2Transform gd_to_b2(Transform2D const &inVal);
-extern b2AABB gd_to_b2(Rect2 const &inVal);
+	_FORCE_INLINE_ static float get_b2_to_gd() { return b2_to_gd_factor; }
+	_FORCE_INLINE_ static float get_gd_to_b2() { return gd_to_b2_factor; }
+};
+
+#define B2_TO_GD (Box2DConversionContext::get_b2_to_gd())
+#define GD_TO_B2 (Box2DConversionContext::get_gd_to_b2())
+
+// Box2D to Godot
+
+_FORCE_INLINE_ void b2_to_gd(b2Vec2 const &inVal, Vector2 &outVal) {
+	const float factor = B2_TO_GD;
+	outVal.x = inVal.x * factor;
+	outVal.y = inVal.y * factor;
+}
+
+_FORCE_INLINE_ Vector2 b2_to_gd(b2Vec2 const &inVal) {
+	const float factor = B2_TO_GD;
+	return Vector2(inVal.x * factor, inVal.y * factor);
+}
+
+_FORCE_INLINE_ Transform2D b2_to_gd(b2Transform const &inVal) {
+	Transform2D outVal;
+	outVal[0][0] = inVal.q.c;
+	outVal[0][1] = inVal.q.s;
+	outVal[1][0] = -inVal.q.s;
+	outVal[1][1] = inVal.q.c;
+	b2_to_gd(inVal.p, outVal[2]);
+	return outVal;
+}
+
+// Godot to Box2D
+
+_FORCE_INLINE_ void gd_to_b2(Vector2 const &inVal, b2Vec2 &outVal) {
+	const float factor = GD_TO_B2;
+	outVal.x = inVal.x * factor;
+	outVal.y = inVal.y * factor;
+}
+
+_FORCE_INLINE_ b2Vec2 gd_to_b2(Vector2 const &inVal) {
+	const float factor = GD_TO_B2;
+	return b2Vec2(inVal.x * factor, inVal.y * factor);
+}
+
+_FORCE_INLINE_ b2Transform gd_to_b2(Transform2D const &inVal) {
+	return b2Transform(gd_to_b2(inVal.get_origin()), b2Rot(inVal.get_rotation()));
+}
+
+_FORCE_INLINE_ b2AABB gd_to_b2(Rect2 const &inVal) {
+	b2AABB outVal;
+	outVal.lowerBound = gd_to_b2(inVal.get_position());
+	outVal.upperBound = gd_to_b2(inVal.get_position() + inVal.get_size());
+	return outVal;
+}
 
 #endif // BOX2D_TYPES_CONVERTER_H